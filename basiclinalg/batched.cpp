@@ -0,0 +1,388 @@
+/*********************************************************************/
+/* File:   batched.cpp                                               */
+/* Date:   2024                                                      */
+/*********************************************************************/
+
+/*
+  Batched operations on many small matrices of equal shape.
+
+  Small matrices are interleaved, matrix first+l goes to SIMD lane l,
+  and the kernels are plain loops over SIMD<double>. Thus every
+  instruction works on SIMD<double>::Size() matrices, and there is no
+  loop overhead or remainder handling for the small dimensions.
+  Larger matrices call the single-matrix routines, one task per matrix.
+*/
+
+#include <bla.hpp>
+
+namespace ngbla
+{
+  // largest dimension handled by the interleaved kernels
+  constexpr size_t batched_simd_maxsize = 32;
+
+  namespace
+  {
+    constexpr size_t SW = SIMD<double>::Size();
+
+    void CheckShapes (FlatArray<FlatMatrix<double>> mats, size_t h, size_t w, const char * name)
+    {
+      for (auto mat : mats)
+        if (mat.Height() != h || mat.Width() != w)
+          throw Exception (string(name) + ": matrices must have equal shape, expected "
+                           + ToString(h) + " x " + ToString(w) + ", got "
+                           + ToString(mat.Height()) + " x " + ToString(mat.Width()));
+    }
+
+    // unused lanes are filled with copies of the last matrix
+    void Pack (FlatArray<FlatMatrix<double>> mats, size_t first, FlatMatrix<SIMD<double>> simdmat)
+    {
+      size_t cnt = min2(SW, mats.Size()-first);
+      for (size_t i = 0; i < simdmat.Height(); i++)
+        for (size_t j = 0; j < simdmat.Width(); j++)
+          simdmat(i,j) = SIMD<double> ([&] (int l) -> double
+                                       { return mats[first+min2(size_t(l), cnt-1)](i,j); });
+    }
+
+    void Unpack (FlatMatrix<SIMD<double>> simdmat, size_t l, FlatMatrix<double> mat)
+    {
+      for (size_t i = 0; i < mat.Height(); i++)
+        for (size_t j = 0; j < mat.Width(); j++)
+          mat(i,j) = simdmat(i,j)[l];
+    }
+
+    // calls func (first, cnt) for all groups of SW matrices
+    template <typename FUNC>
+    void ForGroups (size_t n, FUNC func)
+    {
+      size_t ngroups = (n+SW-1) / SW;
+      ParallelForRange (ngroups, [&] (auto r)
+                        {
+                          for (size_t g : r)
+                            func (g*SW, min2(SW, n-g*SW));
+                        });
+    }
+
+    template <typename FUNC>
+    void ForEach (size_t n, FUNC func)
+    {
+      ParallelForRange (n, [&] (auto r)
+                        {
+                          for (size_t i : r)
+                            func (i);
+                        });
+    }
+
+
+
+    void MultABKernel (FlatMatrix<SIMD<double>> a, FlatMatrix<SIMD<double>> b,
+                       FlatMatrix<SIMD<double>> c)
+    {
+      for (size_t i = 0; i < c.Height(); i++)
+        {
+          for (size_t j = 0; j < c.Width(); j++)
+            c(i,j) = SIMD<double>(0.0);
+          for (size_t k = 0; k < a.Width(); k++)
+            {
+              SIMD<double> aik = a(i,k);
+              for (size_t j = 0; j < c.Width(); j++)
+                c(i,j) += aik * b(k,j);
+            }
+        }
+    }
+
+    // lower triangular L overwrites a, a non-positive pivot gives
+    // a zero or NaN diagonal entry
+    template <typename T>
+    void CholeskyKernel (FlatMatrix<T> a)
+    {
+      using std::sqrt;
+      size_t n = a.Height();
+      for (size_t j = 0; j < n; j++)
+        {
+          T d = a(j,j);
+          for (size_t k = 0; k < j; k++)
+            d -= a(j,k) * a(j,k);
+          T ljj = sqrt(d);
+          a(j,j) = ljj;
+          T inv = T(1.0) / ljj;
+          for (size_t i = j+1; i < n; i++)
+            {
+              T sum = a(i,j);
+              for (size_t k = 0; k < j; k++)
+                sum -= a(i,k) * a(j,k);
+              a(i,j) = sum * inv;
+              a(j,i) = T(0.0);
+            }
+        }
+    }
+
+    // in-place Gauss-Jordan without pivoting, the pivots go to piv
+    void InverseKernel (FlatMatrix<SIMD<double>> a, FlatVector<SIMD<double>> piv)
+    {
+      size_t n = a.Height();
+      for (size_t j = 0; j < n; j++)
+        {
+          SIMD<double> p = a(j,j);
+          piv(j) = p;
+          SIMD<double> pinv = SIMD<double>(1.0) / p;
+          a(j,j) = SIMD<double>(1.0);
+          for (size_t k = 0; k < n; k++)
+            a(j,k) *= pinv;
+          for (size_t i = 0; i < n; i++)
+            if (i != j)
+              {
+                SIMD<double> f = a(i,j);
+                a(i,j) = SIMD<double>(0.0);
+                for (size_t k = 0; k < n; k++)
+                  a(i,k) -= f * a(j,k);
+              }
+        }
+    }
+
+    INLINE bool JacobiConverged (double off, double tot)
+    {
+      return off <= 1e-28 * tot;
+    }
+
+    INLINE bool JacobiConverged (SIMD<double> off, SIMD<double> tot)
+    {
+      for (size_t l = 0; l < SW; l++)
+        if (!JacobiConverged (off[l], tot[l])) return false;
+      return true;
+    }
+
+    // cyclic Jacobi method: a is diagonalized, the eigenvectors are the columns of v
+    template <typename T>
+    void JacobiKernel (FlatMatrix<T> a, FlatMatrix<T> v)
+    {
+      using std::sqrt;
+      using std::fabs;
+      size_t n = a.Height();
+      v = T(0.0);
+      for (size_t i = 0; i < n; i++)
+        v(i,i) = T(1.0);
+
+      for (int sweep = 0; sweep < 50; sweep++)
+        {
+          T off(0.0), tot(0.0);
+          for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+              {
+                tot += a(i,j) * a(i,j);
+                if (i != j) off += a(i,j) * a(i,j);
+              }
+          if (JacobiConverged (off, tot)) break;
+
+          for (size_t p = 0; p < n; p++)
+            for (size_t q = p+1; q < n; q++)
+              {
+                // t = tan(phi) eliminates a(p,q), the smaller angle of the two
+                T apq = a(p,q);
+                T tau = a(q,q) - a(p,p);
+                T denom = fabs(tau) + sqrt(tau*tau + T(4.0)*apq*apq);
+                T t = IfPos(-tau, T(-2.0), T(2.0)) * apq / IfPos(denom, denom, T(1.0));
+                T c = T(1.0) / sqrt(T(1.0) + t*t);
+                T s = t * c;
+
+                for (size_t k = 0; k < n; k++)
+                  {
+                    T akp = a(k,p), akq = a(k,q);
+                    a(k,p) = c*akp - s*akq;
+                    a(k,q) = s*akp + c*akq;
+                  }
+                for (size_t k = 0; k < n; k++)
+                  {
+                    T apk = a(p,k), aqk = a(q,k);
+                    a(p,k) = c*apk - s*aqk;
+                    a(q,k) = s*apk + c*aqk;
+                  }
+                a(p,q) = T(0.0);
+                a(q,p) = T(0.0);
+
+                for (size_t k = 0; k < n; k++)
+                  {
+                    T vkp = v(k,p), vkq = v(k,q);
+                    v(k,p) = c*vkp - s*vkq;
+                    v(k,q) = s*vkp + c*vkq;
+                  }
+              }
+        }
+    }
+
+    // sorted eigenvalues, eigenvectors as rows
+    void StoreEigenSystem (FlatVector<double> diag, FlatMatrix<double> v,
+                           FlatVector<double> lami, FlatMatrix<double> evecs)
+    {
+      size_t n = diag.Size();
+      ArrayMem<int,batched_simd_maxsize> order(n);
+      for (size_t i = 0; i < n; i++)
+        order[i] = i;
+      QuickSort (order, [&] (int i, int j) { return diag(i) < diag(j); });
+      for (size_t i = 0; i < n; i++)
+        {
+          lami(i) = diag(order[i]);
+          evecs.Row(i) = v.Col(order[i]);
+        }
+    }
+  }
+
+
+
+  void BatchedMultMatMat (FlatArray<FlatMatrix<double>> a, FlatArray<FlatMatrix<double>> b,
+                          FlatArray<FlatMatrix<double>> c)
+  {
+    static Timer t("BatchedMultMatMat");
+    RegionTimer reg(t);
+
+    size_t n = a.Size();
+    if (b.Size() != n || c.Size() != n)
+      throw Exception ("BatchedMultMatMat: batches of different size");
+    if (n == 0) return;
+
+    size_t ha = a[0].Height(), wa = a[0].Width(), wb = b[0].Width();
+    CheckShapes (a, ha, wa, "BatchedMultMatMat");
+    CheckShapes (b, wa, wb, "BatchedMultMatMat");
+    CheckShapes (c, ha, wb, "BatchedMultMatMat");
+
+    if (max(ha, max(wa, wb)) > batched_simd_maxsize)
+      {
+        ForEach (n, [&] (size_t i) { MultMatMat (a[i], b[i], c[i]); });
+        return;
+      }
+
+    ForGroups (n, [&] (size_t first, size_t cnt)
+               {
+                 Matrix<SIMD<double>> sa(ha, wa), sb(wa, wb), sc(ha, wb);
+                 Pack (a, first, sa);
+                 Pack (b, first, sb);
+                 MultABKernel (sa, sb, sc);
+                 for (size_t l = 0; l < cnt; l++)
+                   Unpack (sc, l, c[first+l]);
+               });
+  }
+
+
+  void BatchedCholesky (FlatArray<FlatMatrix<double>> a)
+  {
+    static Timer t("BatchedCholesky");
+    RegionTimer reg(t);
+
+    size_t n = a.Size();
+    if (n == 0) return;
+    size_t h = a[0].Height();
+    CheckShapes (a, h, h, "BatchedCholesky");
+
+    if (h > batched_simd_maxsize)
+      ForEach (n, [&] (size_t i) { CholeskyKernel<double> (a[i]); });
+    else
+      ForGroups (n, [&] (size_t first, size_t cnt)
+                 {
+                   Matrix<SIMD<double>> sa(h, h);
+                   Pack (a, first, sa);
+                   CholeskyKernel<SIMD<double>> (sa);
+                   for (size_t l = 0; l < cnt; l++)
+                     Unpack (sa, l, a[first+l]);
+                 });
+
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < h; j++)
+        if (!(a[i](j,j) > 0))
+          throw Exception ("BatchedCholesky: matrix " + ToString(i) + " is not positive definite");
+  }
+
+
+  void BatchedInverse (FlatArray<FlatMatrix<double>> a)
+  {
+    static Timer t("BatchedInverse");
+    RegionTimer reg(t);
+
+    size_t n = a.Size();
+    if (n == 0) return;
+    size_t h = a[0].Height();
+    CheckShapes (a, h, h, "BatchedInverse");
+
+    if (h > batched_simd_maxsize)
+      {
+        ForEach (n, [&] (size_t i) { CalcInverse (a[i]); });
+        return;
+      }
+
+    ForGroups (n, [&] (size_t first, size_t cnt)
+               {
+                 Matrix<SIMD<double>> sa(h, h);
+                 Vector<SIMD<double>> piv(h);
+                 Pack (a, first, sa);
+                 InverseKernel (sa, piv);
+                 for (size_t l = 0; l < cnt; l++)
+                   {
+                     // small pivots: the lane result is not reliable,
+                     // redo this matrix with pivoting
+                     FlatMatrix<double> ai = a[first+l];
+                     double amax = 0, pmin = std::numeric_limits<double>::max();
+                     for (size_t i = 0; i < h; i++)
+                       {
+                         pmin = min(pmin, fabs(piv(i)[l]));
+                         for (size_t j = 0; j < h; j++)
+                           amax = max(amax, fabs(ai(i,j)));
+                       }
+                     if (pmin > 1e-3 * amax)
+                       Unpack (sa, l, ai);
+                     else
+                       CalcInverse (ai);
+                   }
+               });
+  }
+
+
+  void BatchedSymEig (FlatArray<FlatMatrix<double>> a, FlatArray<FlatVector<double>> lami,
+                      FlatArray<FlatMatrix<double>> evecs)
+  {
+    static Timer t("BatchedSymEig");
+    RegionTimer reg(t);
+
+    size_t n = a.Size();
+    if (lami.Size() != n || evecs.Size() != n)
+      throw Exception ("BatchedSymEig: batches of different size");
+    if (n == 0) return;
+    size_t h = a[0].Height();
+    CheckShapes (a, h, h, "BatchedSymEig");
+    CheckShapes (evecs, h, h, "BatchedSymEig");
+    for (auto lam : lami)
+      if (lam.Size() != h)
+        throw Exception ("BatchedSymEig: eigenvalue vector of wrong size");
+
+    if (h > batched_simd_maxsize)
+      {
+        ForEach (n, [&] (size_t i)
+                 {
+#ifdef LAPACK
+                   LapackEigenValuesSymmetric (a[i], lami[i], evecs[i]);
+#else
+                   Matrix<> ha = a[i], v(h, h);
+                   JacobiKernel<double> (ha, v);
+                   Vector<> diag(h);
+                   for (size_t j = 0; j < h; j++)
+                     diag(j) = ha(j,j);
+                   StoreEigenSystem (diag, v, lami[i], evecs[i]);
+#endif
+                 });
+        return;
+      }
+
+    ForGroups (n, [&] (size_t first, size_t cnt)
+               {
+                 Matrix<SIMD<double>> sa(h, h), sv(h, h);
+                 Pack (a, first, sa);
+                 JacobiKernel<SIMD<double>> (sa, sv);
+                 Matrix<> v(h, h);
+                 Vector<> diag(h);
+                 for (size_t l = 0; l < cnt; l++)
+                   {
+                     Unpack (sv, l, v);
+                     for (size_t j = 0; j < h; j++)
+                       diag(j) = sa(j,j)[l];
+                     StoreEigenSystem (diag, v, lami[first+l], evecs[first+l]);
+                   }
+               });
+  }
+}
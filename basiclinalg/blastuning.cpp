@@ -0,0 +1,267 @@
+/*********************************************************************/
+/* File:   blastuning.cpp                                            */
+/* Date:   2024                                                      */
+/*********************************************************************/
+
+/*
+  Machine specific register- and cache-blocking for the dense kernels
+*/
+
+#include <bla.hpp>
+#include <fstream>
+#ifndef WIN32
+#include <sys/stat.h>
+#endif
+
+namespace ngbla
+{
+  BlasTuning blas_tuning;
+
+  static const std::pair<const char*, size_t BlasTuning::*> tuning_fields[] =
+    {
+      { "multab_ha", &BlasTuning::multab_ha },
+      { "multab_bbh", &BlasTuning::multab_bbh },
+      { "abt_ha", &BlasTuning::abt_ha },
+      { "abtsym_ha", &BlasTuning::abtsym_ha },
+      { "abt_bsa", &BlasTuning::abt_bsa },
+      { "abt_bsb", &BlasTuning::abt_bsb },
+      { "abt_bs", &BlasTuning::abt_bs },
+      { "atb_bs", &BlasTuning::atb_bs },
+    };
+
+
+  string BlasMachineId ()
+  {
+    string model = "unknown cpu";
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (getline(cpuinfo, line))
+      if (line.compare(0, 10, "model name") == 0 && line.find(':') != string::npos)
+        {
+          model = line.substr(line.find(':')+1);
+          model.erase(0, model.find_first_not_of(' '));
+          break;
+        }
+    return model + ", SIMD width " + ToString(SIMD<double>::Size());
+  }
+
+  string BlasTuningFile ()
+  {
+    if (const char * filename = getenv("NGS_BLAS_TUNING"))
+      return filename;
+    if (const char * home = getenv("HOME"))
+      return string(home) + "/.ngsolve/blas_tuning";
+    return "";
+  }
+
+  
+  void SetBlasTuning (const BlasTuning & tuning)
+  {
+    auto check = [] (bool ok, const string & what)
+      {
+        if (!ok) throw Exception ("SetBlasTuning: invalid value for " + what);
+      };
+    check (tuning.multab_ha == 4 || tuning.multab_ha == 6, "multab_ha");
+    check (tuning.multab_bbh == 64 || tuning.multab_bbh == 128 || tuning.multab_bbh == 192, "multab_bbh");
+    check (tuning.abt_ha == 3 || tuning.abt_ha == 6, "abt_ha");
+    check (tuning.abtsym_ha == 3 || tuning.abtsym_ha == 6, "abtsym_ha");
+    check (tuning.abt_bsa > 0, "abt_bsa");
+    check (tuning.abt_bsb > 0, "abt_bsb");
+    check (tuning.abt_bs > 0, "abt_bs");
+    check (tuning.atb_bs >= 1 && tuning.atb_bs <= 12, "atb_bs");
+    blas_tuning = tuning;
+  }
+
+  
+  bool LoadBlasTuning (const string & filename)
+  {
+    ifstream in(filename);
+    if (!in) return false;
+
+    string line;
+    getline (in, line);
+    if (line != "machine " + BlasMachineId())
+      return false;
+
+    BlasTuning tuning = blas_tuning;
+    string key;
+    size_t val;
+    while (in >> key >> val)
+      for (auto [name, field] : tuning_fields)
+        if (key == name)
+          tuning.*field = val;
+    SetBlasTuning (tuning);
+    return true;
+  }
+
+  
+  void SaveBlasTuning (const string & filename)
+  {
+#ifndef WIN32
+    auto pos = filename.rfind('/');
+    if (pos != string::npos && pos > 0)
+      mkdir (filename.substr(0, pos).c_str(), 0755);
+#endif
+    ofstream out(filename);
+    if (!out)
+      throw Exception ("SaveBlasTuning: cannot write '" + filename + "'");
+    out << "machine " << BlasMachineId() << endl;
+    for (auto [name, field] : tuning_fields)
+      out << name << " " << blas_tuning.*field << endl;
+  }
+
+
+  namespace
+  {
+    // seconds per call
+    template <typename FUNC>
+    double TimePerCall (FUNC func)
+    {
+      func();
+      for (size_t its = 1; ; its *= 2)
+        {
+          double start = WallTime();
+          for (size_t i = 0; i < its; i++)
+            func();
+          double time = WallTime()-start;
+          if (time > 0.02)
+            return time / its;
+        }
+    }
+
+    // tries all candidates for one parameter, keeps the fastest
+    template <typename FUNC>
+    void TuneParameter (const char * name, size_t BlasTuning::*field,
+                        std::initializer_list<size_t> candidates,
+                        FUNC bench, bool verbose)
+    {
+      size_t best = blas_tuning.*field;
+      double besttime = std::numeric_limits<double>::max();
+      for (auto val : candidates)
+        {
+          BlasTuning tuning = blas_tuning;
+          tuning.*field = val;
+          SetBlasTuning (tuning);
+          double time = bench();
+          if (verbose)
+            cout << "  " << name << " = " << val << ": " << 1e6*time << " us" << endl;
+          if (time < besttime)
+            {
+              best = val;
+              besttime = time;
+            }
+        }
+      BlasTuning tuning = blas_tuning;
+      tuning.*field = best;
+      SetBlasTuning (tuning);
+    }
+
+    void SetValues (SliceMatrix<> mat)
+    {
+      for (size_t i = 0; i < mat.Height(); i++)
+        for (size_t j = 0; j < mat.Width(); j++)
+          mat(i,j) = sin(2.0+3*i+5*j);
+    }
+  }
+
+
+  void TuneBlas (const string & filename, bool verbose)
+  {
+    static Timer t("TuneBlas");
+    RegionTimer reg(t);
+
+    if (verbose)
+      cout << "tune dense kernels for " << BlasMachineId() << endl;
+
+    // sizes of element matrices: small to medium, plus some larger ones
+    // c = a * b:  (ha, wa, wb)
+    size_t sizes_ab[][3] = { { 24, 100, 48 }, { 64, 200, 64 }, { 120, 120, 120 }, { 200, 400, 200 } };
+    // c += a * b^t: (ha, hb, wa)
+    size_t sizes_abt[][3] = { { 30, 30, 100 }, { 60, 60, 300 }, { 120, 120, 120 }, { 200, 200, 600 } };
+
+    auto bench_ab = [&] ()
+      {
+        double sum = 0;
+        for (auto [ha, wa, wb] : sizes_ab)
+          {
+            Matrix<> a(ha, wa), b(wa, wb), c(ha, wb);
+            SetValues (a); SetValues (b);
+            sum += TimePerCall ([&] () { MultMatMat (a, b, c); });
+          }
+        return sum;
+      };
+    auto bench_abt = [&] ()
+      {
+        double sum = 0;
+        for (auto [ha, hb, wa] : sizes_abt)
+          {
+            Matrix<> a(ha, wa), b(hb, wa), c(ha, hb);
+            SetValues (a); SetValues (b);
+            c = 0.0;
+            sum += TimePerCall ([&] () { AddABt (a, b, c); });
+          }
+        return sum;
+      };
+    auto bench_abtsym = [&] ()
+      {
+        double sum = 0;
+        for (auto [ha, hb, wa] : sizes_abt)
+          {
+            Matrix<> a(ha, wa), c(ha, ha);
+            SetValues (a);
+            c = 0.0;
+            sum += TimePerCall ([&] () { AddABtSym (a, a, c); });
+          }
+        return sum;
+      };
+    auto bench_atb = [&] ()
+      {
+        double sum = 0;
+        for (auto [ha, hb, wa] : sizes_abt)
+          {
+            Matrix<> a(wa, ha), b(wa, hb), c(ha, hb);
+            SetValues (a); SetValues (b);
+            sum += TimePerCall ([&] () { MultAtB (a, b, c); });
+          }
+        return sum;
+      };
+
+    if (verbose) cout << "MultMatMat" << endl;
+    TuneParameter ("multab_ha", &BlasTuning::multab_ha, { 4, 6 }, bench_ab, verbose);
+    TuneParameter ("multab_bbh", &BlasTuning::multab_bbh, { 64, 128, 192 }, bench_ab, verbose);
+
+    if (verbose) cout << "AddABt" << endl;
+    TuneParameter ("abt_ha", &BlasTuning::abt_ha, { 3, 6 }, bench_abt, verbose);
+    TuneParameter ("abt_bsa", &BlasTuning::abt_bsa, { 48, 96, 192 }, bench_abt, verbose);
+    TuneParameter ("abt_bsb", &BlasTuning::abt_bsb, { 16, 32, 64 }, bench_abt, verbose);
+    TuneParameter ("abt_bs", &BlasTuning::abt_bs, { 128, 256, 512 }, bench_abt, verbose);
+
+    if (verbose) cout << "AddABtSym" << endl;
+    TuneParameter ("abtsym_ha", &BlasTuning::abtsym_ha, { 3, 6 }, bench_abtsym, verbose);
+
+    if (verbose) cout << "MultAtB" << endl;
+    TuneParameter ("atb_bs", &BlasTuning::atb_bs, { 4, 6, 8, 10, 12 }, bench_atb, verbose);
+
+    if (filename != "")
+      {
+        SaveBlasTuning (filename);
+        if (verbose)
+          cout << "tuning saved to " << filename << endl;
+      }
+  }
+
+
+  // tuned parameters of this machine, if available
+  static bool blas_tuning_loaded = [] ()
+    {
+      try
+        {
+          return LoadBlasTuning (BlasTuningFile());
+        }
+      catch (const Exception & e)
+        {
+          cerr << "ignoring blas tuning file: " << e.What() << endl;
+          return false;
+        }
+    } ();
+}
@@ -1266,6 +1266,98 @@ namespace ngbla
   }
 
 
+  /*
+    Schur decomposition a = q t q^*, t is upper triangular (real case:
+    quasi-triangular with 2x2 blocks for complex conjugate pairs).
+    On exit a is overwritten by t.
+  */
+  inline void LapackSchur (ngbla::FlatMatrix<double,ColMajor> a,
+                           ngbla::FlatMatrix<double,ColMajor> q,
+                           ngbla::FlatVector<ngbla::Complex> lami)
+  {
+    char jobvs = 'V', sort = 'N';
+    integer n = a.Height(), sdim = 0, info = 0;
+    integer lwork = 4*n;
+    ArrayMem<double,100> wr(n), wi(n);
+    ArrayMem<double,1000> work(lwork);
+
+    dgees_(&jobvs, &sort, 0, &n, &a(0,0), &n, &sdim, &wr[0], &wi[0], &q(0,0), &n,
+           &work[0], &lwork, nullptr, &info);
+    if (info)
+      throw Exception ("LapackSchur failed, info = " + std::to_string(info));
+
+    for (int i = 0; i < n; i++)
+      lami(i) = ngbla::Complex(wr[i], wi[i]);
+  }
+
+  inline void LapackSchur (ngbla::FlatMatrix<ngbla::Complex,ColMajor> a,
+                           ngbla::FlatMatrix<ngbla::Complex,ColMajor> q,
+                           ngbla::FlatVector<ngbla::Complex> lami)
+  {
+    char jobvs = 'V', sort = 'N';
+    integer n = a.Height(), sdim = 0, info = 0;
+    integer lwork = 4*n;
+    ArrayMem<ngbla::Complex,1000> work(lwork);
+    ArrayMem<double,100> rwork(n);
+
+    zgees_(&jobvs, &sort, 0, &n, &a(0,0), &n, &sdim, &lami(0), &q(0,0), &n,
+           &work[0], &lwork, &rwork[0], nullptr, &info);
+    if (info)
+      throw Exception ("LapackSchur failed, info = " + std::to_string(info));
+  }
+
+  /*
+    Reorders the Schur form t such that the selected eigenvalues form
+    the leading block, q is updated. Returns the size of the block, in
+    the real case both eigenvalues of a complex conjugate pair are taken.
+    Throws if the reordering fails (eigenvalues too close to swap).
+  */
+  inline int LapackReorderSchur (ngbla::FlatMatrix<double,ColMajor> t,
+                                 ngbla::FlatMatrix<double,ColMajor> q,
+                                 ngbla::FlatArray<int> select,
+                                 ngbla::FlatVector<ngbla::Complex> lami)
+  {
+    char job = 'N', compq = 'V';
+    integer n = t.Height(), m = 0, info = 0;
+    integer lwork = max(n, 1), liwork = 1, iwork = 0;
+    double s, sep;
+    ArrayMem<logical,100> sel(n);
+    ArrayMem<double,100> wr(n), wi(n), work(lwork);
+    for (int i = 0; i < n; i++)
+      sel[i] = select[i];
+
+    dtrsen_(&job, &compq, &sel[0], &n, &t(0,0), &n, &q(0,0), &n, &wr[0], &wi[0], &m,
+            &s, &sep, &work[0], &lwork, &iwork, &liwork, &info);
+    if (info)
+      throw Exception ("LapackReorderSchur failed, info = " + std::to_string(info));
+
+    for (int i = 0; i < n; i++)
+      lami(i) = ngbla::Complex(wr[i], wi[i]);
+    return m;
+  }
+
+  inline int LapackReorderSchur (ngbla::FlatMatrix<ngbla::Complex,ColMajor> t,
+                                 ngbla::FlatMatrix<ngbla::Complex,ColMajor> q,
+                                 ngbla::FlatArray<int> select,
+                                 ngbla::FlatVector<ngbla::Complex> lami)
+  {
+    char job = 'N', compq = 'V';
+    integer n = t.Height(), m = 0, info = 0;
+    integer lwork = max(n, 1);
+    double s, sep;
+    ArrayMem<logical,100> sel(n);
+    ArrayMem<ngbla::Complex,100> work(lwork);
+    for (int i = 0; i < n; i++)
+      sel[i] = select[i];
+
+    ztrsen_(&job, &compq, &sel[0], &n, &t(0,0), &n, &q(0,0), &n, &lami(0), &m,
+            &s, &sep, &work[0], &lwork, &info);
+    if (info)
+      throw Exception ("LapackReorderSchur failed, info = " + std::to_string(info));
+    return m;
+  }
+
+
 #else
 
   typedef int integer;
@@ -1440,6 +1532,23 @@ namespace ngbla
     std::cerr << "sorry, EVP not available without LAPACK" << std::endl;
   }
 
+  template <typename T>
+  inline void LapackSchur (ngbla::FlatMatrix<T,ColMajor> a,
+                           ngbla::FlatMatrix<T,ColMajor> q,
+                           ngbla::FlatVector<ngbla::Complex> lami)
+  {
+    throw Exception ("Schur decomposition not available without LAPACK");
+  }
+
+  template <typename T>
+  inline int LapackReorderSchur (ngbla::FlatMatrix<T,ColMajor> t,
+                                 ngbla::FlatMatrix<T,ColMajor> q,
+                                 ngbla::FlatArray<int> select,
+                                 ngbla::FlatVector<ngbla::Complex> lami)
+  {
+    throw Exception ("Schur decomposition not available without LAPACK");
+  }
+
 
 #endif
 
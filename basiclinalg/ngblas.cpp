@@ -131,6 +131,38 @@ namespace ngbla
     y += s * a.AddSize(y.Size(),x.Size()) * x;
   }
 
+
+  // the values are converted when loaded, four independent sums per row
+  INLINE double RowTimesVec (const float * pa, FlatVector<> x)
+  {
+    size_t n = x.Size();
+    double * px = x.Data();
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t j = 0;
+    for ( ; j+4 <= n; j += 4)
+      {
+        s0 += double(pa[j]) * px[j];
+        s1 += double(pa[j+1]) * px[j+1];
+        s2 += double(pa[j+2]) * px[j+2];
+        s3 += double(pa[j+3]) * px[j+3];
+      }
+    for ( ; j < n; j++)
+      s0 += double(pa[j]) * px[j];
+    return (s0+s1) + (s2+s3);
+  }
+
+  void MultMatVec (BareSliceMatrix<float> a, FlatVector<> x, FlatVector<> y)
+  {
+    for (size_t i = 0; i < y.Size(); i++)
+      y(i) = RowTimesVec (&a(i,0), x);
+  }
+
+  void MultAddMatVec (double s, BareSliceMatrix<float> a, FlatVector<> x, FlatVector<> y)
+  {
+    for (size_t i = 0; i < y.Size(); i++)
+      y(i) += s * RowTimesVec (&a(i,0), x);
+  }
+
   pmult_matvec dispatch_matvec[];
   /*=
     {
@@ -655,7 +687,7 @@ namespace ngbla
 
 
 
-  template <size_t BBH, OPERATION OP>
+  template <size_t BBH, size_t HA, OPERATION OP>
   void REGCALL MultMatMat_intern2_SlimB (size_t ha, size_t wa, size_t wb,
                                          BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
   {
@@ -667,11 +699,6 @@ namespace ngbla
     
     constexpr size_t SW = SIMD<double>::Size();
     alignas(64) SIMD<double> bb[BBH];
-#ifdef __AVX512F__
-    constexpr size_t HA = 6;
-#else
-    constexpr size_t HA = 4;
-#endif
 
     double * pc = &c(0,0);
     for (size_t j = 0; j+SW <= wb; j+=SW, pb += SW, pc += SW)
@@ -707,13 +734,13 @@ namespace ngbla
   } 
 
 
-  template <size_t BBH, OPERATION OP>
+  template <size_t BBH, size_t HA, OPERATION OP>
   void  REGCALL MultMatMat_intern2 (size_t ha, size_t wa, size_t wb,
                                      BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
   {
     if (wb < 3*SIMD<double>::Size())
       {
-        MultMatMat_intern2_SlimB<BBH,OP> (ha, wa, wb, a, b, c);
+        MultMatMat_intern2_SlimB<BBH,HA,OP> (ha, wa, wb, a, b, c);
         return;
       }
 
@@ -722,12 +749,6 @@ namespace ngbla
     double * pb = &b(0);
     size_t distb = b.Dist();
     
-#ifdef __AVX512F__
-    constexpr size_t HA = 6;
-#else
-    constexpr size_t HA = 4;
-#endif
-    
     // blockwise B, fits into L2 cache
     // constexpr size_t BBH = 128;
     constexpr size_t BBW = 96;
@@ -828,58 +849,58 @@ namespace ngbla
 
 
 
-  
-  void MultMatMat_intern (size_t ha, size_t wa, size_t wb,
-                          BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
+
+  typedef void REGCALL (*pmultAB_block)(size_t, size_t, size_t,
+                                        BareSliceMatrix<>, BareSliceMatrix<>, BareSliceMatrix<>);
+
+  // kernel for wa <= bbh, with the tuned register and cache blocking
+  template <OPERATION OP>
+  pmultAB_block GetMultABBlock (size_t & bbh)
   {
-    constexpr size_t BBH = 128;
-    if (wa <= BBH)
+    bool ha6 = blas_tuning.multab_ha == 6;
+    switch (blas_tuning.multab_bbh)
       {
-        if (wb < 3*SIMD<double>::Size())
-          MultMatMat_intern2_SlimB<BBH,SET> (ha, wa, wb, a, b, c);
-        else
-          MultMatMat_intern2<BBH,SET> (ha, wa, wb, a, b, c);
+      case 64:
+        bbh = 64;
+        return ha6 ? &MultMatMat_intern2<64,6,OP> : &MultMatMat_intern2<64,4,OP>;
+      case 192:
+        bbh = 192;
+        return ha6 ? &MultMatMat_intern2<192,6,OP> : &MultMatMat_intern2<192,4,OP>;
+      default:
+        bbh = 128;
+        return ha6 ? &MultMatMat_intern2<128,6,OP> : &MultMatMat_intern2<128,4,OP>;
       }
-    else
-      {
-        MultMatMat_intern2<BBH,SET> (ha, BBH, wb, a, b, c);    
+  }
 
-        for (size_t i = BBH; i < wa; i += BBH)
-          {
-            a.IncPtr(BBH);
-            b.IncPtr(BBH*b.Dist());
-            size_t hbi = min2(BBH, wa-i);        
-            MultMatMat_intern2<BBH,ADD> (ha, hbi, wb, a, b, c);
-          }
+  // first block with OPFIRST, then accumulate with OP
+  template <OPERATION OPFIRST, OPERATION OP>
+  INLINE void MultMatMat_Blocked (size_t ha, size_t wa, size_t wb,
+                                  BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
+  {
+    size_t bbh;
+    auto first = GetMultABBlock<OPFIRST> (bbh);
+    auto rest = GetMultABBlock<OP> (bbh);
+    (*first) (ha, min2(bbh, wa), wb, a, b, c);
+    for (size_t i = bbh; i < wa; i += bbh)
+      {
+        a.IncPtr(bbh);
+        b.IncPtr(bbh*b.Dist());
+        (*rest) (ha, min2(bbh, wa-i), wb, a, b, c);
       }
   }
+  
+  void MultMatMat_intern (size_t ha, size_t wa, size_t wb,
+                          BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
+  {
+    MultMatMat_Blocked<SET,ADD> (ha, wa, wb, a, b, c);
+  }
 
   void MinusMultAB_intern (size_t ha, size_t wa, size_t wb,
                            BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
   {
-    constexpr size_t BBH = 128;
-    if (wa <= BBH)
-      {
-        if (wb < 3*SIMD<double>::Size())
-          MultMatMat_intern2_SlimB<BBH,SETNEG> (ha, wa, wb, a, b, c);
-        else
-          MultMatMat_intern2<BBH,SETNEG> (ha, wa, wb, a, b, c);
-      }
-    else
-      {
-        MultMatMat_intern2<BBH,SETNEG> (ha, BBH, wb, a, b, c);    
-
-        for (size_t i = BBH; i < wa; i += BBH)
-          {
-            a.IncPtr(BBH);
-            b.IncPtr(BBH*b.Dist());
-            size_t hbi = min2(BBH, wa-i);        
-            MultMatMat_intern2<BBH,SUB> (ha, hbi, wb, a, b, c);
-          }
-      }
+    MultMatMat_Blocked<SETNEG,SUB> (ha, wa, wb, a, b, c);
   }
 
-  
   /*
   void MinusMultAB_intern (size_t ha, size_t wa, size_t wb,
                            BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
@@ -917,29 +938,13 @@ namespace ngbla
         ;
       }
     
-    constexpr size_t BBH = 128;
-    if (wa <= BBH && wb < 3*SIMD<double>::Size())
-      MultMatMat_intern2_SlimB<BBH,ADD> (ha, wa, wb, a, b, c);
-    else
-      for (size_t i = 0; i < wa; i += BBH, a.IncPtr(BBH), b.IncPtr(BBH*b.Dist()))
-        {
-          size_t hbi = min2(BBH, wa-i);        
-          MultMatMat_intern2<BBH,ADD> (ha, hbi, wb, a, b, c);
-        }
+    MultMatMat_Blocked<ADD,ADD> (ha, wa, wb, a, b, c);
   }
 
   void SubAB_intern (size_t ha, size_t wa, size_t wb,
                      BareSliceMatrix<> a, BareSliceMatrix<> b, BareSliceMatrix<> c)
   {
-    constexpr size_t BBH = 128;
-    if (wa <= BBH && wb < 3*SIMD<double>::Size())
-      MultMatMat_intern2_SlimB<BBH,SUB> (ha, wa, wb, a, b, c);
-    else
-      for (size_t i = 0; i < wa; i += BBH, a.IncPtr(BBH), b.IncPtr(BBH*b.Dist()))
-        {
-          size_t hbi = min2(BBH, wa-i);        
-          MultMatMat_intern2<BBH,SUB> (ha, hbi, wb, a, b, c);
-        }
+    MultMatMat_Blocked<SUB,SUB> (ha, wa, wb, a, b, c);
   }
 
 
@@ -1165,7 +1170,7 @@ namespace ngbla
   {
     // c.AddSize(a.Width(), b.Width()) = 1.0 * Trans(a) * b;  // avoid recursion
     
-    constexpr size_t bs = 8;
+    size_t bs = blas_tuning.atb_bs;
     size_t i = 0;
     size_t ha = a.Height();    
     //size_t wa = a.Width();
@@ -1173,7 +1178,7 @@ namespace ngbla
     BareSliceMatrix<> bare_a(a);
     BareSliceMatrix<> bare_b(b);
     for ( ; i+bs <= a.Width(); i += bs, bare_a.IncPtr(bs), c.IncPtr(bs*c.Dist()))
-      MultAtBSmallWA<bs> (ha, wb, bare_a, bare_b, c);
+      dispatch_atb[bs] (ha, wb, bare_a, bare_b, c);
     dispatch_atb[a.Width()-i] (ha, wb, bare_a, bare_b, c);
   }
 
@@ -1201,17 +1206,12 @@ namespace ngbla
     };
 
   
-  template <typename TAB, typename FUNC>
+  template <size_t HA, typename TAB, typename FUNC>
   INLINE void TAddABt4 (size_t wa, size_t hc, size_t wc,
                         TAB * pa, size_t da, TAB * pb, size_t db, double * pc, size_t dc,
                         FUNC func)
   {
-#ifdef __AVX512F__
-    constexpr size_t HA = 6;
-#else
-    constexpr size_t HA = 3;
-#endif
-    
+
     TAB * pb0 = pb;
     size_t i = 0;
     for ( ; i+HA <= hc; i += HA, pa += HA*da, pc += HA*dc)
@@ -1272,16 +1272,20 @@ namespace ngbla
                  TAB * pa, size_t da, TAB * pb, size_t db, double * pc, size_t dc,
                  FUNC func)
   {
-    constexpr size_t bsa = 96; // height a
-    constexpr size_t bsb = 32; // height b    
+    size_t bsa = blas_tuning.abt_bsa; // height a
+    size_t bsb = blas_tuning.abt_bsb; // height b    
+    bool ha6 = blas_tuning.abt_ha == 6;
     for (size_t i = 0; i < ha; i += bsa, pa += bsa*da, pc += bsa*dc)
       {
         size_t hha = min2(bsa, ha-i);
         TAB * hpb = pb;
         for (size_t j = 0; j < hb; j += bsb, hpb += bsb*db)
-          TAddABt4 (wa, hha, min2(bsb, hb-j),
-                    pa, da, hpb, db, pc+j, dc, func);
-        
+          if (ha6)
+            TAddABt4<6> (wa, hha, min2(bsb, hb-j),
+                         pa, da, hpb, db, pc+j, dc, func);
+          else
+            TAddABt4<3> (wa, hha, min2(bsb, hb-j),
+                         pa, da, hpb, db, pc+j, dc, func);
       }
   }
 
@@ -1290,7 +1294,7 @@ namespace ngbla
   void TAddABt1 (SliceMatrix<double> a, SliceMatrix<double> b, BareSliceMatrix<double> c,
                 FUNC func)
   {
-    constexpr size_t bs = 256; // inner-product loop
+    size_t bs = blas_tuning.abt_bs; // inner-product loop
     size_t wa = a.Width();
     double *pa = a.Data();
     double *pb = b.Data();
@@ -1304,7 +1308,7 @@ namespace ngbla
   {
     // c = a * Trans(b);
 
-    constexpr size_t bs = 256;
+    size_t bs = blas_tuning.abt_bs;
     size_t wa = a.Width();
 
     TAddABt2 (min2(bs, wa), a.Height(), b.Height(),
@@ -1319,7 +1323,7 @@ namespace ngbla
   {
     // c = -a * Trans(b);
     
-    constexpr size_t bs = 256;
+    size_t bs = blas_tuning.abt_bs;
     size_t wa = a.Width();
 
     TAddABt2 (min2(bs, wa), a.Height(), b.Height(),
@@ -1381,16 +1385,11 @@ namespace ngbla
 
   /* *********************** AddABt-Sym ************************ */
 
-  template <typename TAB, typename FUNC>
+  template <size_t HA, typename TAB, typename FUNC>
   INLINE void TAddABt4Sym (size_t wa, size_t hc, size_t wc,
                            TAB * pa, size_t da, TAB * pb, size_t db, double * pc, size_t dc,
                            FUNC func)
   {
-#ifdef __AVX512F__
-    constexpr size_t HA = 6;
-#else
-    constexpr size_t HA = 3;
-#endif
     
     TAB * pb0 = pb;
     size_t i = 0;
@@ -1442,9 +1441,14 @@ namespace ngbla
                   SliceMatrix<double> b,
                   BareSliceMatrix<double> c)
   {
-    TAddABt4Sym(a.Width(), a.Height(), b.Height(),
-                a.Data(), a.Dist(), b.Data(), b.Dist(), c.Data(), c.Dist(),
-                [] (auto c, auto ab) { return c+ab; });
+    if (blas_tuning.abtsym_ha == 6)
+      TAddABt4Sym<6> (a.Width(), a.Height(), b.Height(),
+                      a.Data(), a.Dist(), b.Data(), b.Dist(), c.Data(), c.Dist(),
+                      [] (auto c, auto ab) { return c+ab; });
+    else
+      TAddABt4Sym<3> (a.Width(), a.Height(), b.Height(),
+                      a.Data(), a.Dist(), b.Data(), b.Dist(), c.Data(), c.Dist(),
+                      [] (auto c, auto ab) { return c+ab; });
   }
 
 
@@ -1452,9 +1456,14 @@ namespace ngbla
                   SliceMatrix<SIMD<double>> b,
                   BareSliceMatrix<double> c)
   {
-    TAddABt4Sym(a.Width(), a.Height(), b.Height(),
-                a.Data(), a.Width(), b.Data(), b.Width(), c.Data(), c.Dist(),
-                [] (auto c, auto ab) { return c+ab; });
+    if (blas_tuning.abtsym_ha == 6)
+      TAddABt4Sym<6> (a.Width(), a.Height(), b.Height(),
+                      a.Data(), a.Width(), b.Data(), b.Width(), c.Data(), c.Dist(),
+                      [] (auto c, auto ab) { return c+ab; });
+    else
+      TAddABt4Sym<3> (a.Width(), a.Height(), b.Height(),
+                      a.Data(), a.Width(), b.Data(), b.Width(), c.Data(), c.Dist(),
+                      [] (auto c, auto ab) { return c+ab; });
     /*
     AddABtSym (SliceMatrix<double> (AFlatMatrix<double>(a)),
                SliceMatrix<double> (AFlatMatrix<double>(b)), c);
@@ -1471,18 +1480,42 @@ namespace ngbla
 
   
 
+  /*
+    SIMD<Complex> stores the real and imaginary parts as two SIMD<double>,
+    so a is a real matrix [ar_0, ai_0, ar_1, ai_1, ...] of twice the width.
+    With b rearranged to [br, -bi] and [bi, br], the real and imaginary
+    parts of c are products of real matrices, computed by the
+    register-blocked real kernel instead of per-entry complex sums.
+  */
   void AddABt (FlatMatrix<SIMD<Complex>> a,
                FlatMatrix<SIMD<Complex>> b,
                SliceMatrix<Complex> c)
   {
-    for (size_t i = 0; i < c.Height(); i++)
-      for (size_t j = 0; j < c.Width(); j++)
+    size_t ha = a.Height(), hb = b.Height(), w = a.Width();
+    if (ha == 0 || hb == 0) return;
+    
+    SliceMatrix<SIMD<double>> ar(ha, 2*w, 2*w, reinterpret_cast<SIMD<double>*> (a.Data()));
+    // called per element: temporaries on the stack, heap only for large elements
+    ArrayMem<SIMD<double>, 512> bmem(2*hb*2*w);
+    ArrayMem<double, 2048> cmem(2*ha*hb);
+    FlatMatrix<SIMD<double>> bre(hb, 2*w, bmem.Data()), bim(hb, 2*w, bmem.Data()+hb*2*w);
+    for (size_t j = 0; j < hb; j++)
+      for (size_t k = 0; k < w; k++)
         {
-          SIMD<Complex> sum(0.0);
-          for (size_t k = 0; k < a.Width(); k++)
-            sum += a(i,k) * b(j,k);
-          c(i,j) += HSum(sum);
+          bre(j,2*k) = b(j,k).real();
+          bre(j,2*k+1) = -b(j,k).imag();
+          bim(j,2*k) = b(j,k).imag();
+          bim(j,2*k+1) = b(j,k).real();
         }
+
+    FlatMatrix<> cre(ha, hb, cmem.Data()), cim(ha, hb, cmem.Data()+ha*hb);
+    cre = 0.0;
+    cim = 0.0;
+    AddABt (ar, bre, cre);
+    AddABt (ar, bim, cim);
+    for (size_t i = 0; i < ha; i++)
+      for (size_t j = 0; j < hb; j++)
+        c(i,j) += Complex(cre(i,j), cim(i,j));
   }
   
   void AddABtSym (FlatMatrix<SIMD<Complex>> a,
@@ -12,6 +12,48 @@
 namespace ngbla
 {
 
+  /*
+    Register- and cache-blocking of the dense kernels. The defaults fit
+    common x86 machines, TuneBlas measures the best choice on the current
+    machine and stores it in a file, which is loaded at startup. The file
+    is given by the environment variable NGS_BLAS_TUNING, default is
+    ~/.ngsolve/blas_tuning.
+  */
+  struct BlasTuning
+  {
+#ifdef __AVX512F__
+    size_t multab_ha = 6;    // MultMatMat, rows of A per kernel: 4 or 6
+#else
+    size_t multab_ha = 4;
+#endif
+    size_t multab_bbh = 128; // MultMatMat, rows of the B-block: 64, 128 or 192
+#ifdef __AVX512F__
+    size_t abt_ha = 6;       // AddABt, rows of A per kernel: 3 or 6
+    size_t abtsym_ha = 6;    // AddABtSym, rows of A per kernel: 3 or 6
+#else
+    size_t abt_ha = 3;
+    size_t abtsym_ha = 3;
+#endif
+    size_t abt_bsa = 96;     // AddABt, rows of the A-block
+    size_t abt_bsb = 32;     // AddABt, rows of the B-block
+    size_t abt_bs = 256;     // AddABt, length of inner product blocks
+    size_t atb_bs = 8;       // MultAtB, columns of A per kernel: 1 .. 12
+  };
+
+  extern NGS_DLL_HEADER BlasTuning blas_tuning;
+
+  /// cpu model and simd width, the tuning file is valid for this id only
+  NGS_DLL_HEADER string BlasMachineId ();
+  NGS_DLL_HEADER string BlasTuningFile ();
+  /// throws for invalid parameters
+  NGS_DLL_HEADER void SetBlasTuning (const BlasTuning & tuning);
+  /// returns false if the file is missing or written for another machine
+  NGS_DLL_HEADER bool LoadBlasTuning (const string & filename);
+  NGS_DLL_HEADER void SaveBlasTuning (const string & filename);
+  /// measure all candidates, set and save the fastest ones
+  NGS_DLL_HEADER void TuneBlas (const string & filename, bool verbose = true);
+
+  
   extern NGS_DLL_HEADER void MultMatVec_intern (BareSliceMatrix<> a, FlatVector<> x, FlatVector<> y);
   typedef void (*pmult_matvec)(BareSliceMatrix<>, FlatVector<>, FlatVector<>);
   extern NGS_DLL_HEADER pmult_matvec dispatch_matvec[26];
@@ -44,6 +86,10 @@ namespace ngbla
       MultAddMatVec_intern (s, a, x, y);
   }
 
+  // single precision matrix, double precision vectors and arithmetic
+  extern NGS_DLL_HEADER void MultMatVec (BareSliceMatrix<float> a, FlatVector<> x, FlatVector<> y);
+  extern NGS_DLL_HEADER void MultAddMatVec (double s, BareSliceMatrix<float> a, FlatVector<> x, FlatVector<> y);
+
 
 
   
@@ -293,6 +339,32 @@ namespace ngbla
 
 
 
+  // Batched operations on many matrices of equal shape.
+  // Up to size 32, SIMD<double>::Size() matrices are processed together,
+  // one matrix per SIMD lane. Larger matrices are processed one per task.
+
+  // c[i] = a[i] * b[i]
+  extern NGS_DLL_HEADER
+  void BatchedMultMatMat (FlatArray<FlatMatrix<double>> a, FlatArray<FlatMatrix<double>> b,
+                          FlatArray<FlatMatrix<double>> c);
+
+  // a[i] = L L^T, L overwrites a[i], the upper triangle is set to 0.
+  // throws if a matrix is not positive definite
+  extern NGS_DLL_HEADER
+  void BatchedCholesky (FlatArray<FlatMatrix<double>> a);
+
+  // a[i] = a[i]^{-1}
+  extern NGS_DLL_HEADER
+  void BatchedInverse (FlatArray<FlatMatrix<double>> a);
+
+  // eigenvalues of symmetric a[i] in ascending order, eigenvectors are
+  // the rows of evecs[i] (as LapackEigenValuesSymmetric). a is not changed
+  extern NGS_DLL_HEADER
+  void BatchedSymEig (FlatArray<FlatMatrix<double>> a, FlatArray<FlatVector<double>> lami,
+                      FlatArray<FlatMatrix<double>> evecs);
+
+
+
 
 
   
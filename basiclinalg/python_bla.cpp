@@ -807,6 +807,61 @@ complex : bool
 
                                 
                               }, py::arg("n"), py::arg("m"), py::arg("k"));
+
+    m.def("TuneBlas", [] (string filename, bool verbose)
+          {
+            if (filename == "") filename = BlasTuningFile();
+            TuneBlas (filename, verbose);
+          }, py::arg("filename")="", py::arg("verbose")=true,
+          docu_string(R"raw_string(
+Benchmark the blocking parameters of the dense kernels (MultMatMat,
+AddABt, AddABtSym, MultAtB) on this machine, activate the fastest,
+and store them. The stored tuning is loaded at startup if it was
+created on the same cpu.
+
+Parameters:
+
+filename : str
+  tuning file, default is $NGS_BLAS_TUNING or ~/.ngsolve/blas_tuning
+
+verbose : bool
+  print timings of all candidates
+)raw_string"));
+
+    m.def("GetBlasTuning", [] ()
+          {
+            py::dict d;
+            d["multab_ha"] = blas_tuning.multab_ha;
+            d["multab_bbh"] = blas_tuning.multab_bbh;
+            d["abt_ha"] = blas_tuning.abt_ha;
+            d["abtsym_ha"] = blas_tuning.abtsym_ha;
+            d["abt_bsa"] = blas_tuning.abt_bsa;
+            d["abt_bsb"] = blas_tuning.abt_bsb;
+            d["abt_bs"] = blas_tuning.abt_bs;
+            d["atb_bs"] = blas_tuning.atb_bs;
+            d["machine"] = BlasMachineId();
+            return d;
+          }, "active blocking parameters of the dense kernels");
+
+    m.def("SetBlasTuning", [] (py::kwargs kwargs)
+          {
+            BlasTuning tuning = blas_tuning;
+            for (auto item : kwargs)
+              {
+                string key = item.first.cast<string>();
+                size_t val = item.second.cast<size_t>();
+                if (key == "multab_ha") tuning.multab_ha = val;
+                else if (key == "multab_bbh") tuning.multab_bbh = val;
+                else if (key == "abt_ha") tuning.abt_ha = val;
+                else if (key == "abtsym_ha") tuning.abtsym_ha = val;
+                else if (key == "abt_bsa") tuning.abt_bsa = val;
+                else if (key == "abt_bsb") tuning.abt_bsb = val;
+                else if (key == "abt_bs") tuning.abt_bs = val;
+                else if (key == "atb_bs") tuning.atb_bs = val;
+                else throw Exception ("SetBlasTuning: unknown parameter " + key);
+              }
+            SetBlasTuning (tuning);
+          }, "set blocking parameters of the dense kernels, e.g. SetBlasTuning(multab_ha=4)");
              }
 
 #endif // NGS_PYTHON
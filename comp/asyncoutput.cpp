@@ -0,0 +1,156 @@
+/*********************************************************************/
+/* File:   asyncoutput.cpp                                           */
+/* Date:   2024                                                      */
+/*********************************************************************/
+
+#include <comp.hpp>
+#include "asyncoutput.hpp"
+
+namespace ngcomp
+{
+
+  static size_t VectorBytes (const GridFunction & gf)
+  {
+    size_t bytes = 0;
+    for (int i = 0; i < gf.GetMultiDim(); i++)
+      bytes += gf.GetVector(i).Size() * gf.GetVector(i).EntrySize() * sizeof(double);
+    return bytes;
+  }
+
+  static shared_ptr<GridFunction> CopyGridFunction (const GridFunction & gf)
+  {
+    auto copy = CreateGridFunction (gf.GetFESpace(), gf.GetName(), gf.GetFlags());
+    copy->Update();
+    for (int i = 0; i < gf.GetMultiDim(); i++)
+      copy->GetVector(i) = gf.GetVector(i);
+    return copy;
+  }
+
+  
+  AsyncOutput :: AsyncOutput (size_t amax_memory)
+    : max_memory(amax_memory), lh(100*1000*1000, "asyncoutput")
+  {
+    worker = std::thread([this] () { Loop(); });
+  }
+
+  AsyncOutput :: ~AsyncOutput ()
+  {
+    {
+      unique_lock<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+  }
+
+  void AsyncOutput :: Do (shared_ptr<BaseVTKOutput> vtk, VorB vb)
+  {
+    static Timer t("AsyncOutput::Do");
+    RegionTimer reg(t);
+    {
+      unique_lock<std::mutex> lock(mutex);
+      RethrowError();
+    }
+    size_t bytes;
+    auto write = vtk->Prepare (lh, vb, bytes);
+    Submit (std::move(write), bytes);
+  }
+
+  void AsyncOutput :: Save (shared_ptr<GridFunction> gf, const string & filename)
+  {
+    static Timer t("AsyncOutput::Save");
+    RegionTimer reg(t);
+    if (gf->GetFESpace()->IsParallel())
+      throw Exception ("AsyncOutput::Save: distributed GridFunctions are not supported, "
+                       "use Save(..., collective=True)");
+    size_t bytes = VectorBytes (*gf);
+    {
+      // wait for room before taking the snapshot
+      unique_lock<std::mutex> lock(mutex);
+      WaitForRoom (lock, bytes);
+    }
+    auto snapshot = CopyGridFunction (*gf);
+    Submit ([snapshot, filename] ()
+            {
+              ofstream out(filename, ios::binary);
+              snapshot->Save (out);
+              if (!out)
+                throw Exception ("AsyncOutput: writing '" + filename + "' failed");
+            }, bytes);
+  }
+
+  void AsyncOutput :: Wait ()
+  {
+    unique_lock<std::mutex> lock(mutex);
+    WaitIdle (lock);
+    RethrowError();
+  }
+
+  void AsyncOutput :: WaitIdle (unique_lock<std::mutex> & lock)
+  {
+    cv.wait (lock, [&] { return jobs.empty() && !running; });
+  }
+
+  void AsyncOutput :: WaitForRoom (unique_lock<std::mutex> & lock, size_t bytes)
+  {
+    // pending_bytes includes the running job, an idle writer always accepts
+    cv.wait (lock, [&] { return error || (jobs.empty() && !running)
+                                || pending_bytes+bytes <= max_memory; });
+  }
+
+  void AsyncOutput :: RethrowError ()
+  {
+    if (error)
+      {
+        auto e = error;
+        error = nullptr;
+        std::rethrow_exception (e);
+      }
+  }
+
+  void AsyncOutput :: Submit (function<void()> func, size_t bytes)
+  {
+    {
+      unique_lock<std::mutex> lock(mutex);
+      WaitForRoom (lock, bytes);
+      RethrowError();
+      jobs.push_back (Job { std::move(func), bytes });
+      pending_bytes += bytes;
+    }
+    cv.notify_all();
+  }
+
+  void AsyncOutput :: Loop ()
+  {
+    while (true)
+      {
+        Job job;
+        {
+          unique_lock<std::mutex> lock(mutex);
+          cv.wait (lock, [&] { return stop || !jobs.empty(); });
+          if (jobs.empty()) return;    // stop requested, all done
+          job = std::move(jobs.front());
+          jobs.pop_front();
+          running = true;
+        }
+
+        std::exception_ptr e;
+        try
+          {
+            job.func ();
+          }
+        catch (...)
+          {
+            e = std::current_exception();
+          }
+
+        {
+          unique_lock<std::mutex> lock(mutex);
+          pending_bytes -= job.bytes;
+          running = false;
+          if (e && !error) error = e;
+        }
+        cv.notify_all();
+      }
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef FILE_ASYNCOUTPUT
+#define FILE_ASYNCOUTPUT
+
+/*********************************************************************/
+/* File:   asyncoutput.hpp                                           */
+/* Date:   2024                                                      */
+/*********************************************************************/
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace ngcomp
+{
+
+  /*
+    Writes time-series output on a dedicated thread. The caller
+    evaluates the VTK output (with the TaskManager) or copies the
+    solution vector, the output thread only does the compression and
+    file writing. It runs no TaskManager-aware code, no timers and
+    no ParallelFor, since it has no TaskManager thread id of its own.
+
+    Submitting blocks as long as the queued and the running outputs
+    together exceed max_memory bytes (back-pressure), the output being
+    submitted comes on top.
+  */
+  class NGS_DLL_HEADER AsyncOutput
+  {
+    struct Job
+    {
+      function<void()> func;
+      size_t bytes;
+    };
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> jobs;
+    size_t pending_bytes = 0;  // queued and running jobs
+    size_t max_memory;
+    bool running = false;      // the worker is executing a job
+    bool stop = false;
+    std::exception_ptr error;
+
+    LocalHeap lh;              // for the evaluation in Do, caller thread only
+    
+  public:
+    AsyncOutput (size_t amax_memory = 1000*1000*1000);
+    ~AsyncOutput ();
+
+    /// evaluate vtk now, then write it in the background
+    void Do (shared_ptr<BaseVTKOutput> vtk, VorB vb = VOL);
+
+    /// snapshot gf, then save it in the background
+    void Save (shared_ptr<GridFunction> gf, const string & filename);
+    
+    /// wait for all queued output, rethrows exceptions from the output thread
+    void Wait ();
+
+  private:
+    void Submit (function<void()> func, size_t bytes);
+    void Loop ();
+    void WaitIdle (unique_lock<std::mutex> & lock);
+    void WaitForRoom (unique_lock<std::mutex> & lock, size_t bytes);
+    void RethrowError ();
+  };
+}
+
+#endif
@@ -97,6 +97,8 @@ namespace ngcomp
                      !flags.GetDefineFlag ("nokeep_internal"));
     SetStoreInner (flags.GetDefineFlag ("store_inner"));
     precompute = flags.GetDefineFlag ("precompute");
+    precompute_single = flags.GetDefineFlag ("precompute_single");
+    precompute_memory = flags.GetNumFlag ("precompute_memory", 0);
     checksum = flags.GetDefineFlag ("checksum");
     spd = flags.GetDefineFlag ("spd");
     geom_free = flags.GetDefineFlag("geom_free");    
@@ -156,6 +158,8 @@ namespace ngcomp
     geom_free = flags.GetDefineFlag("geom_free");
     
     precompute = flags.GetDefineFlag ("precompute");
+    precompute_single = flags.GetDefineFlag ("precompute_single");
+    precompute_memory = flags.GetNumFlag ("precompute_memory", 0);
     checksum = flags.GetDefineFlag ("checksum");
     SetCheckUnused (!flags.GetDefineFlagX("check_unused").IsFalse());    
   }
@@ -202,6 +206,8 @@ namespace ngcomp
       throw Exception (string ("Adding non-symmetric integrator to symmetric bilinear-form\n")+
                        string ("bfi is ")+bfi->Name());
 
+    // indexed by the volume integrators
+    ClearPrecomputedData();
     parts.Append (bfi);
 
     if ((bfi->geom_free && nonassemble) || geom_free)
@@ -273,7 +279,18 @@ namespace ngcomp
   */
 
   BilinearForm :: ~BilinearForm ()
-  { ; }
+  {
+    ClearPrecomputedData();
+  }
+
+  void BilinearForm :: ClearPrecomputedData ()
+  {
+    size_t nparts = VB_parts[VOL].Size();
+    for (size_t i = 0; i < precomputed_data.Size(); i++)
+      if (precomputed_data[i])
+        VB_parts[VOL][i % nparts] -> DeletePrecomputedData (precomputed_data[i]);
+    precomputed_data.SetSize0();
+  }
 
   void BilinearForm :: SetPrint (bool ap)
   { 
@@ -582,47 +599,51 @@ namespace ngcomp
         mats.SetSize(ma->GetNLevels());
         mats.Last() = make_shared<BilinearFormApplication> (dynamic_pointer_cast<BilinearForm>(this->shared_from_this()), lh); 
       
-        if (precompute)
+        if (precompute && !MixedSpaces())
           {
-            Array<DofId> dnums;
-            precomputed_data.SetSize( max2(max2(ma->GetNE(VOL), ma->GetNE(BND)),ma->GetNE(BBND))*NumIntegrators() );
+            static Timer t("BilinearForm::Assemble - precompute");
+            RegionTimer reg(t);
+            
+            ClearPrecomputedData();
+            auto & parts_vol = VB_parts[VOL];
+            size_t nparts = parts_vol.Size();
+            precomputed_data.SetSize (ma->GetNE(VOL) * nparts);
             precomputed_data = nullptr;
 
-            LocalHeap lh (20000000, "biform - assemble");
+            size_t budget = precompute_memory > 0 ?
+              size_t(precompute_memory * 1e6) : numeric_limits<size_t>::max();
+            atomic<size_t> memory(0);
             
-            // int hasbound = 0;
-            // int hasinner = 0;
-            for (VorB vb : {VOL, BND, BBND})
-	      {
-		int ne = ma->GetNE(vb);
-		if(VB_parts[vb].Size())
-		  {
-		    for (int i=0; i < ne; i++)
-		      {
-                        ElementId ei(vb, i);
-			// auto & fel = fespace->GetFE(ei,lh);
-			// auto & eltrans = ma->GetTrafo(ei,lh);
-			fespace->GetDofNrs(ei,dnums);
-                        /*
-			for(int j=0; j<NumIntegrators(); j++)
-			  {
-			    const BilinearFormIntegrator & bfi = *parts[j];
-                        */
-                        /*
-                        for (auto & bfi : VB_parts[vb])
-                          {
-			    // if(bfi.VB()!=vb) continue;
-			    if(!bfi->DefinedOn (ma->GetElIndex(i))) continue;
-                            
-			    precomputed_data[i*NumIntegrators()+j] =
-			      bfi->PrecomputeData(fel,eltrans,lh);
-			  }
-                        */
-                        throw Exception ("precomputed currently not supported");
-		      }
-		  }
-	      }
-	  }
+            IterateElements 
+              (*fespace, VOL, lh, 
+               [&] (FESpace::Element el, LocalHeap & lh)
+               {
+                 if (memory > budget) return;
+                 for (size_t j = 0; j < nparts; j++)
+                   {
+                     auto & bfi = parts_vol[j];
+                     if (!bfi->DefinedOn (el.GetIndex())) continue;
+                     if (!bfi->DefinedOnElement (el.Nr())) continue;
+                     
+                     auto & trafo = el.GetTrafo().AddDeformation(bfi->GetDeformation().get(), lh);
+                     void * data = bfi->PrecomputeData (el.GetFE(), trafo, precompute_single, lh);
+                     if (!data) continue;
+                     
+                     size_t size = bfi->PrecomputedDataSize (data);
+                     if (memory.fetch_add(size) + size > budget)
+                       {
+                         bfi->DeletePrecomputedData (data);
+                         memory = budget+1;
+                         return;
+                       }
+                     precomputed_data[el.Nr()*nparts+j] = data;
+                   }
+               });
+            
+            if (memory > budget)
+              cout << IM(3) << "precompute memory limit reached, "
+                   << "remaining elements are computed on the fly" << endl;
+          }
             
         
         if (timing)
@@ -4075,16 +4096,19 @@ namespace ngcomp
                    x.GetIndirect (dnums, elvecx);
                    this->fespace->TransformVec (el, elvecx, TRANSFORM_SOL);
 
-                   for (auto & bfi : VB_parts[vb])
+                   for (size_t j = 0; j < VB_parts[vb].Size(); j++)
                      {
+                       auto & bfi = VB_parts[vb][j];
                        if (!bfi->DefinedOn (el.GetIndex())) continue;
                        if (!bfi->DefinedOnElement (el.Nr())) continue;
 
                        auto & mapped_trafo = trafo.AddDeformation(bfi->GetDeformation().get(), lh);
+                       void * precomputed = (vb == VOL && precomputed_data.Size()) ?
+                         precomputed_data[el.Nr()*VB_parts[VOL].Size()+j] : nullptr;
 
                        {
                          // ThreadRegionTimer reg (timer_applyelmat, TaskManager::GetThreadId());
-                         bfi->ApplyElementMatrix (fel, mapped_trafo, elvecx, elvecy, 0, lh);
+                         bfi->ApplyElementMatrix (fel, mapped_trafo, elvecx, elvecy, precomputed, lh);
                        }
                        
                        this->fespace->TransformVec (el, elvecy, TRANSFORM_RHS);
@@ -4102,9 +4126,11 @@ namespace ngcomp
           if ( (facetwise_skeleton_parts[VOL].Size() > 0) ||
                (facetwise_skeleton_parts[BND].Size() > 0) )
             
-            for (auto colfacets : fespace->FacetColoring())
+            for (auto col : Range(fespace->FacetSkeleton()))
               {
-                SharedLoop2 sl(colfacets.Size());
+                auto colfacets = fespace->FacetSkeleton()[col];
+                auto batches = fespace->FacetSkeletonBatches()[col];
+                SharedLoop2 sl(batches.Size());
 
                 ParallelJob
                   ( [&] (const TaskInfo & ti) 
@@ -4112,121 +4138,130 @@ namespace ngcomp
                       LocalHeap lh = clh.Split(ti.thread_nr, ti.nthreads);
                       RegionTimer reg(timerDGpar);
 
-                      Array<int> elnums(2, lh), elnums_per(2, lh), fnums1(6, lh), fnums2(6, lh),
-                        vnums1(8, lh), vnums2(8, lh);
+                      Array<int> vnums1(8, lh), vnums2(8, lh);
 
-                  for (int i : sl)                
+                  for (int b : sl)                
                      {
-                       // timerDG1.Start();
                        HeapReset hr(lh);
-                       int facet = colfacets[i];
-                       int facet2 = colfacets[i];
-                       ma->GetFacetElements (facet, elnums);
-                       if (elnums.Size() == 0) continue; // coarse facets
-                       int el1 = elnums[0];
-                       ElementId ei1(VOL, el1);
-                       fnums1 = ma->GetElFacets(ei1);
-                       int facnr1 = fnums1.Pos(facet);
+                       // facets of equal class, see SkeletonFacet
+                       auto batch = colfacets.Range(batches[b]);
                        
-                       // timerDG1.Stop();
-                       if(elnums.Size() < 2)
+                       if (batch[0].IsBoundary())
                          {
-                           if (ma->GetCommunicator().Size() > 1)
-                             if (ma->GetDistantProcs (NodeId(NT_FACET, facet)).Size() > 0)
-                               continue;
-
-                           facet2 = ma->GetPeriodicFacet(facet);
-                           if(facet2 > facet)
-                             {
-                               ma->GetFacetElements (facet2, elnums_per);
-                               if (elnums_per.Size() > 1)
-                                 throw Exception("DG-Apply failed due to invalid periodicity.");
-                               elnums.Append(elnums_per[0]);
-                             }
-                           else if(facet2 < facet)
+                           if (facetwise_skeleton_parts[BND].Size() == 0)
                              continue;
-                         }
-                       
-                       if (elnums.Size()<2)
-                         {
-                           // RegionTimer reg(timerDGfacet);
                            
-                           ma->GetFacetSurfaceElements (facet, elnums);
-                           int sel = elnums[0];
-                           ElementId sei(BND, sel);
+                           for (const SkeletonFacet & sf : batch)
+                             {
+                               HeapReset hr(lh);
+                               ElementId ei1(VOL, sf.el1);
+                               ElementId sei(BND, sf.sel);
                            
-                           const FiniteElement & fel = fespace->GetFE (ei1, lh);
-                           Array<int> dnums(fel.GetNDof(), lh);
-                           vnums1 = ma->GetElVertices (ei1);
-                           vnums2 = ma->GetElVertices (sei);
+                               const FiniteElement & fel = fespace->GetFE (ei1, lh);
+                               Array<int> dnums(fel.GetNDof(), lh);
+                               vnums1 = ma->GetElVertices (ei1);
+                               vnums2 = ma->GetElVertices (sei);
                            
-                           ElementTransformation & eltrans = ma->GetTrafo (ei1, lh);
-                           ElementTransformation & seltrans = ma->GetTrafo (sei, lh);
+                               ElementTransformation & eltrans = ma->GetTrafo (ei1, lh);
+                               ElementTransformation & seltrans = ma->GetTrafo (sei, lh);
                            
-                           fespace->GetDofNrs (ei1, dnums);
+                               fespace->GetDofNrs (ei1, dnums);
                            
-                           for (auto & bfi : facetwise_skeleton_parts[BND])
-                             {
-                               if (!bfi->DefinedOn (seltrans.GetElementIndex())) continue;
-                               if (!bfi->DefinedOnElement (facet)) continue;
+                               for (auto & bfi : facetwise_skeleton_parts[BND])
+                                 {
+                                   if (!bfi->DefinedOn (seltrans.GetElementIndex())) continue;
+                                   if (!bfi->DefinedOnElement (sf.facet)) continue;
                                          
-                               FlatVector<SCAL> elx(dnums.Size()*this->fespace->GetDimension(), lh),
-                                 ely(dnums.Size()*this->fespace->GetDimension(), lh);
-                               x.GetIndirect(dnums, elx);
+                                   FlatVector<SCAL> elx(dnums.Size()*this->fespace->GetDimension(), lh),
+                                     ely(dnums.Size()*this->fespace->GetDimension(), lh);
+                                   x.GetIndirect(dnums, elx);
                                
-                               bfi->ApplyFacetMatrix (fel,facnr1,eltrans,vnums1, seltrans, vnums2, elx, ely, lh);
-                               y.AddIndirect(dnums, ely, fespace->HasAtomicDofs());
-                             } //end for (numintegrators)
-                           
+                                   bfi->ApplyFacetMatrix (fel,sf.facnr1,eltrans,vnums1, seltrans, vnums2, elx, ely, lh);
+                                   y.AddIndirect(dnums, ely, fespace->HasAtomicDofs());
+                                 } //end for (numintegrators)
+                             }
                            continue;
-                         } // end if boundary facet
+                         } // end if boundary facets
                        
                        if (facetwise_skeleton_parts[VOL].Size() == 0)
                          continue;
-                       
-                       // timerDG2.Start();
-                       // timerDG2a.Start();
-                       // int el2 = elnums[1];
-                       // ElementId ei2(VOL, el2);
-                       ElementId ei2(VOL, elnums[1]);
-                       
-                       // fnums2 = ma->GetElFacets(ei2);
-                       // int facnr2 = fnums2.Pos(facet2);
-                       int facnr2 = ma->GetElFacets(ei2).Pos(facet2);
 
-                       ElementTransformation & eltrans1 = ma->GetTrafo (ei1, lh);
-                       ElementTransformation & eltrans2 = ma->GetTrafo (ei2, lh);
-                       
-                       const FiniteElement & fel1 = fespace->GetFE (ei1, lh);
-                       const FiniteElement & fel2 = fespace->GetFE (ei2, lh);
-                       // timerDG2a.Stop();
-                       // timerDG2b.Start();                                 
-                       Array<int> dnums1(fel1.GetNDof(), lh);
-                       Array<int> dnums2(fel2.GetNDof(), lh);
-                       fespace->GetDofNrs (ei1, dnums1);
-                       fespace->GetDofNrs (ei2, dnums2);
-                       vnums1 = ma->GetElVertices (ei1);
-                       vnums2 = ma->GetElVertices (ei2);
+                       size_t nf = batch.Size();
+                       int facnr1 = batch[0].facnr1, facnr2 = batch[0].facnr2;
+                       FlatArray<const FiniteElement*> fels1(nf, lh), fels2(nf, lh);
+                       FlatArray<const ElementTransformation*> trafos1(nf, lh), trafos2(nf, lh);
+                       FlatArray<FlatArray<int>> dnums(nf, lh), elvnums1(nf, lh), elvnums2(nf, lh);
+                       FlatArray<FlatVector<SCAL>> elx(nf, lh), ely(nf, lh);
                        
-                       Array<int> dnums(fel1.GetNDof()+fel2.GetNDof(), lh);
-                       dnums.Range(0, dnums1.Size()) = dnums1;
-                       dnums.Range(dnums1.Size(), dnums.Size()) = dnums2;
-                       FlatVector<SCAL> elx(dnums.Size()*fespace->GetDimension(), lh),
-                         ely(dnums.Size()*fespace->GetDimension(), lh);
-                       
-                       x.GetIndirect(dnums, elx);
+                       for (size_t k = 0; k < nf; k++)
+                         {
+                           const SkeletonFacet & sf = batch[k];
+                           ElementId ei1(VOL, sf.el1);
+                           ElementId ei2(VOL, sf.el2);
+                           
+                           trafos1[k] = &ma->GetTrafo (ei1, lh);
+                           trafos2[k] = &ma->GetTrafo (ei2, lh);
+                           fels1[k] = &fespace->GetFE (ei1, lh);
+                           fels2[k] = &fespace->GetFE (ei2, lh);
+                           
+                           Array<int> dnums1(fels1[k]->GetNDof(), lh);
+                           Array<int> dnums2(fels2[k]->GetNDof(), lh);
+                           fespace->GetDofNrs (ei1, dnums1);
+                           fespace->GetDofNrs (ei2, dnums2);
+                           dnums[k].Assign (FlatArray<int> (dnums1.Size()+dnums2.Size(), lh));
+                           dnums[k].Range(0, dnums1.Size()) = dnums1;
+                           dnums[k].Range(dnums1.Size(), dnums[k].Size()) = dnums2;
+                           
+                           Array<int> v1(8, lh), v2(8, lh);
+                           v1 = ma->GetElVertices (ei1);
+                           v2 = ma->GetElVertices (ei2);
+                           elvnums1[k].Assign (v1);
+                           elvnums2[k].Assign (v2);
+                           
+                           elx[k].AssignMemory (dnums[k].Size()*fespace->GetDimension(), lh);
+                           ely[k].AssignMemory (dnums[k].Size()*fespace->GetDimension(), lh);
+                           x.GetIndirect(dnums[k], elx[k]);
+                         }
 
                        RegionTimer reg2(timerDGapply);                     
                        for (auto & bfi : facetwise_skeleton_parts[VOL])                                   
                          {
-                           if (!bfi->DefinedOn (ma->GetElIndex (ei1))) continue; 
-                           if (!bfi->DefinedOn (ma->GetElIndex (ei2))) continue; 
-                           if (!bfi->DefinedOnElement (facet) ) continue;
+                           HeapReset hr(lh);
+                           FlatArray<int> used(nf, lh);
+                           size_t nused = 0;
+                           for (size_t k = 0; k < nf; k++)
+                             if (bfi->DefinedOn (trafos1[k]->GetElementIndex()) &&
+                                 bfi->DefinedOn (trafos2[k]->GetElementIndex()) &&
+                                 bfi->DefinedOnElement (batch[k].facet))
+                               used[nused++] = k;
+                           if (nused == 0) continue;
                            
-                           bfi->ApplyFacetMatrix (fel1, facnr1, eltrans1, vnums1,
-                                                  fel2, facnr2, eltrans2, vnums2, elx, ely, lh);
-
-                           y.AddIndirect(dnums, ely);
+                           if constexpr (is_same<SCAL,double>::value)
+                             {
+                               FlatArray<FacetBilinearFormIntegrator::FacetPair> pairs(nused, lh);
+                               for (size_t i = 0; i < nused; i++)
+                                 {
+                                   auto k = used[i];
+                                   auto & pair = pairs[i];
+                                   pair.fel1 = fels1[k];
+                                   pair.fel2 = fels2[k];
+                                   pair.trafo1 = trafos1[k];
+                                   pair.trafo2 = trafos2[k];
+                                   pair.vnums1.Assign (elvnums1[k]);
+                                   pair.vnums2.Assign (elvnums2[k]);
+                                   pair.elx.AssignMemory (elx[k].Size(), elx[k].Data());
+                                   pair.ely.AssignMemory (ely[k].Size(), ely[k].Data());
+                                 }
+                               bfi->ApplyFacetMatrixBatch (facnr1, facnr2, pairs, lh);
+                             }
+                           else
+                             for (auto k : used.Range(0, nused))
+                               bfi->ApplyFacetMatrix (*fels1[k], facnr1, *trafos1[k], elvnums1[k],
+                                                      *fels2[k], facnr2, *trafos2[k], elvnums2[k],
+                                                      elx[k], ely[k], lh);
+                           
+                           for (auto k : used.Range(0, nused))
+                             y.AddIndirect(dnums[k], ely[k]);
                          }
                      }
                  });
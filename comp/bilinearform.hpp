@@ -110,7 +110,11 @@ namespace ngcomp
     
     /// precomputes some data for each element
     bool precompute;
-    /// precomputed element-wise data
+    /// store precomputed data in single precision
+    bool precompute_single;
+    /// memory limit for precomputed data in MB, 0 for no limit
+    double precompute_memory;
+    /// precomputed element-wise data, (volume element, volume integrator)
     Array<void*> precomputed_data;
     /// output of norm of matrix entries
     bool checksum;
@@ -336,6 +340,9 @@ namespace ngcomp
     ///
     virtual bool SymmetricStorage() const { return false; }
 
+    /// free the element-wise data of the integrators
+    void ClearPrecomputedData ();
+
     /// don't assemble the matrix
     void SetNonAssemble (bool na = true) { nonassemble = na; }
     bool NonAssemble() const { return nonassemble; }
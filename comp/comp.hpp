@@ -82,5 +82,6 @@ namespace ngcomp
 
 // #include "bddc.hpp"
 #include "vtkoutput.hpp"
+#include "asyncoutput.hpp"
 
 #endif
@@ -760,6 +760,8 @@ lot of new non-zero entries in the matrix!\n" << endl;
     
     // invalidate facet_coloring
     facet_coloring = Table<int>();
+    facet_skeleton = Table<SkeletonFacet>();
+    facet_skeleton_batches = Table<IntRange>();
        
     level_updated = ma->GetNLevels();
     if (timing) Timing();
@@ -858,6 +860,171 @@ lot of new non-zero entries in the matrix!\n" << endl;
 
     return facet_coloring;
   }
+
+
+  const Table<SkeletonFacet> & FESpace :: FacetSkeleton() const
+  {
+    if (facet_skeleton.Size()) return facet_skeleton;
+
+    static Timer t("FESpace::FacetSkeleton"); RegionTimer reg(t);
+    auto & coloring = FacetColoring();
+
+    // pairwise order of the facet vertices within the element, it
+    // determines the Facet2ElementTrafo of the facet
+    auto orientation = [] (ELEMENT_TYPE et, int facnr, auto vnums) -> int8_t
+      {
+        const int * fv = nullptr;
+        int nfv = 0;
+        switch (ElementTopology::GetSpaceDim(et))
+          {
+          case 2: fv = ElementTopology::GetEdges(et)[facnr]; nfv = 2; break;
+          case 3:
+            fv = ElementTopology::GetFaces(et)[facnr];
+            nfv = (ElementTopology::GetFacetType(et, facnr) == ET_TRIG) ? 3 : 4;
+            break;
+          default: break;
+          }
+        int8_t orient = 0, bit = 1;
+        for (int i = 0; i < nfv; i++)
+          for (int j = i+1; j < nfv; j++, bit *= 2)
+            if (vnums[fv[i]] > vnums[fv[j]])
+              orient += bit;
+        return orient;
+      };
+
+    Array<Array<SkeletonFacet>> colfacets(coloring.Size());
+    for (auto col : Range(coloring))
+      {
+        auto facets = coloring[col];
+        Array<SkeletonFacet> & skel = colfacets[col];
+        skel.SetSize(facets.Size());
+        
+        ParallelForRange
+          (facets.Size(), [&] (IntRange r)
+           {
+             Array<int> elnums, elnums_per;
+             for (auto i : r)
+               {
+                 SkeletonFacet & sf = skel[i];
+                 int facet = facets[i];
+                 sf.facet = sf.facet2 = facet;
+                 sf.el1 = sf.el2 = sf.sel = -1;
+                 
+                 ma->GetFacetElements (facet, elnums);
+                 if (elnums.Size() == 0) continue;  // coarse facets
+                 
+                 if (elnums.Size() < 2)
+                   {
+                     if (ma->GetCommunicator().Size() > 1)
+                       if (ma->GetDistantProcs (NodeId(NT_FACET, facet)).Size() > 0)
+                         continue;
+                     
+                     int facet2 = ma->GetPeriodicFacet(facet);
+                     if (facet2 < facet) continue;   // handled by periodic partner
+                     if (facet2 > facet)
+                       {
+                         ma->GetFacetElements (facet2, elnums_per);
+                         if (elnums_per.Size() > 1)
+                           throw Exception("FacetSkeleton failed due to invalid periodicity.");
+                         if (elnums_per.Size())
+                           {
+                             elnums.Append(elnums_per[0]);
+                             sf.facet2 = facet2;
+                           }
+                       }
+                   }
+                 
+                 ElementId ei1(VOL, elnums[0]);
+                 sf.el1 = elnums[0];
+                 sf.et1 = ma->GetElType(ei1);
+                 sf.facnr1 = ma->GetElFacets(ei1).Pos(facet);
+                 sf.orient1 = orientation(sf.et1, sf.facnr1, ma->GetElVertices(ei1));
+                 
+                 if (elnums.Size() < 2)
+                   {
+                     ma->GetFacetSurfaceElements (facet, elnums);
+                     if (elnums.Size() == 0)
+                       {
+                         sf.el1 = -1;
+                         continue;
+                       }
+                     sf.sel = elnums[0];
+                     sf.et2 = ma->GetElType(ElementId(BND, sf.sel));
+                     sf.facnr2 = 0;
+                     sf.orient2 = 0;
+                   }
+                 else
+                   {
+                     ElementId ei2(VOL, elnums[1]);
+                     sf.el2 = elnums[1];
+                     sf.et2 = ma->GetElType(ei2);
+                     sf.facnr2 = ma->GetElFacets(ei2).Pos(sf.facet2);
+                     sf.orient2 = orientation(sf.et2, sf.facnr2, ma->GetElVertices(ei2));
+                   }
+               }
+           });
+
+        // remove skipped facets, and group facets of the same class
+        int cnt = 0;
+        for (auto & sf : skel)
+          if (sf.el1 >= 0)
+            skel[cnt++] = sf;
+        skel.SetSize(cnt);
+
+        QuickSort (skel, [] (const SkeletonFacet & a, const SkeletonFacet & b)
+                   {
+                     auto key = [] (const SkeletonFacet & sf)
+                       { return make_tuple (sf.el2 >= 0, sf.et1, sf.facnr1, sf.orient1,
+                                            sf.et2, sf.facnr2, sf.orient2, sf.facet); };
+                     return key(a) < key(b);
+                   });
+      }
+
+    // runs of equal class, split into batches of limited size for load balancing
+    constexpr int maxbatch = 64;
+    Array<Array<IntRange>> colbatches(colfacets.Size());
+    for (auto col : Range(colfacets))
+      {
+        auto & skel = colfacets[col];
+        for (size_t first = 0; first < skel.Size(); )
+          {
+            size_t next = first+1;
+            while (next < skel.Size() && next-first < maxbatch &&
+                   skel[next].SameClass(skel[first]))
+              next++;
+            colbatches[col].Append (IntRange(first, next));
+            first = next;
+          }
+      }
+
+    Array<int> cnt(colfacets.Size());
+    for (auto col : Range(colfacets))
+      cnt[col] = colfacets[col].Size();
+    const_cast<Table<SkeletonFacet>&> (facet_skeleton) = Table<SkeletonFacet> (cnt);
+    for (auto col : Range(colfacets))
+      facet_skeleton[col] = colfacets[col];
+
+    for (auto col : Range(colbatches))
+      cnt[col] = colbatches[col].Size();
+    const_cast<Table<IntRange>&> (facet_skeleton_batches) = Table<IntRange> (cnt);
+    for (auto col : Range(colbatches))
+      facet_skeleton_batches[col] = colbatches[col];
+
+    if (print)
+      {
+        size_t nbatches = 0;
+        for (auto col : Range(colbatches))
+          nbatches += colbatches[col].Size();
+        *testout << "facet-skeleton: " << nbatches << " batches of equal facet classes" << endl;
+      }
+    return facet_skeleton;
+  }
+
+  const Table<IntRange> & FESpace :: FacetSkeletonBatches() const
+  {
+    FacetSkeleton();
+    return facet_skeleton_batches;
+  }
   
 
   // FiniteElement & FESpace :: GetFE (ElementId ei, Allocator & alloc) const
@@ -72,6 +72,31 @@ ANY                  1 1 1 1 | 15
 
   class FESpace;
 
+  /**
+     Precomputed neighbour information of a facet for skeleton (DG) loops.
+     Facets with equal element types, local facet numbers and facet
+     orientations map the reference facet to the same points on the
+     reference elements, and are applied as one batch.
+   */
+  struct SkeletonFacet
+  {
+    int facet, facet2;          // facet2 != facet for periodic facets
+    int el1, el2;               // el2 = -1 on boundary facets
+    int sel;                    // surface element on boundary facets, else -1
+    ELEMENT_TYPE et1, et2;
+    int8_t facnr1, facnr2;      // local facet numbers
+    int8_t orient1, orient2;    // order of the facet vertices within el1, el2
+
+    bool IsBoundary() const { return el2 < 0; }
+    /// same element types, local facet numbers and facet orientations
+    bool SameClass (const SkeletonFacet & sf) const
+    {
+      return (el2 < 0) == (sf.el2 < 0) &&
+        et1 == sf.et1 && facnr1 == sf.facnr1 && orient1 == sf.orient1 &&
+        et2 == sf.et2 && facnr2 == sf.facnr2 && orient2 == sf.orient2;
+    }
+  };
+
   // will be size_t some day 
   typedef int DofId;
   enum IRREGULAR_DOF_NR
@@ -201,6 +226,8 @@ ANY                  1 1 1 1 | 15
     
     Table<int> element_coloring[4]; 
     Table<int> facet_coloring;  // elements on facet in own colors (DG)
+    Table<SkeletonFacet> facet_skeleton;  // neighbour data, same colors as facet_coloring
+    Table<IntRange> facet_skeleton_batches;  // runs of equal facet classes
     Array<COUPLING_TYPE> ctofdof;
 
     shared_ptr<ParallelDofs> paralleldofs;
@@ -261,6 +288,12 @@ ANY                  1 1 1 1 | 15
     { return element_coloring[vb]; }
 
     const Table<int> & FacetColoring() const;
+
+    /// precomputed facet-pairs for skeleton loops, grouped by facet colors.
+    /// within one color, facets are sorted by facet class
+    const Table<SkeletonFacet> & FacetSkeleton() const;
+    /// per color, ranges of FacetSkeleton()[color] of equal facet class
+    const Table<IntRange> & FacetSkeletonBatches() const;
     
     /// print report to stream
     virtual void PrintReport (ostream & ost) const override;
@@ -825,6 +825,333 @@ namespace ngcomp
 
 
 
+#ifdef PARALLEL
+
+  /*
+    Collective checkpoint file:
+
+      "NGSGFCKP", int64 sizeof(SCAL)
+      for vertices, edges, faces, cells:
+        int64 nnodes, int64 ndata
+        nnodes keys  Vec<N+1,int>  (global vertex numbers, number of values)
+        ndata values SCAL
+
+    Every rank writes the nodes it is master of at offsets given by an
+    Exscan. For reading, every rank reads a contiguous slice of the
+    records, and the records are matched with the requesting ranks by
+    a directory distributed by a hash of the key. So the number of
+    ranks can change between save and load.
+  */
+  
+  template <int N>
+  static Vec<N+1,int> CheckpointKey (const MeshAccess & ma, NODE_TYPE nt, size_t nr, int ndata)
+  {
+    ArrayMem<int,8> pnums;
+    switch (nt)
+      {
+      case NT_VERTEX: pnums.SetSize(1); pnums[0] = nr; break;
+      case NT_EDGE: pnums = ma.GetEdgePNums (nr); break;
+      case NT_FACE: pnums = ma.GetFacePNums (nr); break;
+      case NT_CELL: pnums = ma.GetElVertices (ElementId(VOL,nr)); break;
+      default: break;
+      }
+    bool parallel = ma.GetCommunicator().Size() > 1;
+    Vec<N+1,int> key;
+    key = -1;
+    for (int j = 0; j < pnums.Size(); j++)
+      key[j] = parallel ? ma.GetGlobalNodeNum (NodeId(NT_VERTEX, pnums[j])) : pnums[j];
+    key[N] = ndata;
+    return key;
+  }
+
+  template <int N>
+  static int CheckpointOwner (const Vec<N+1,int> & key, int np)
+  {
+    size_t h = 0;
+    for (int j = 0; j < N; j++)
+      h = (h ^ size_t(key[j]+1)) * 0x100000001b3ull;
+    return (h >> 7) % np;
+  }
+
+  // send[p] goes to rank p, returns what the others sent to us 
+  template <typename TBASE, typename T>
+  static Table<T> CheckpointAllToAll (const Table<T> & send, MPI_Comm comm)
+  {
+    constexpr int ES = sizeof(T) / sizeof(TBASE);
+    int np;
+    MPI_Comm_size (comm, &np);
+    Array<int> scnt(np), rcnt(np), sdispl(np), rdispl(np);
+    for (int p = 0; p < np; p++)
+      scnt[p] = send[p].Size();
+    MPI_Alltoall (scnt.Data(), 1, MPI_INT, rcnt.Data(), 1, MPI_INT, comm);
+    Table<T> recv(rcnt);
+
+    int sums = 0, sumr = 0;
+    for (int p = 0; p < np; p++)
+      {
+        scnt[p] *= ES; rcnt[p] *= ES;
+        sdispl[p] = sums; rdispl[p] = sumr;
+        sums += scnt[p]; sumr += rcnt[p];
+      }
+    MPI_Alltoallv (send.AsArray().Data(), scnt.Data(), sdispl.Data(), GetMPIType<TBASE>(),
+                   recv.AsArray().Data(), rcnt.Data(), rdispl.Data(), GetMPIType<TBASE>(), comm);
+    return recv;
+  }
+  
+  template <int N, typename SCAL>
+  static size_t SaveNodeTypeCollective (const S_GridFunction<SCAL> & gf, NODE_TYPE nt,
+                                        MPI_File fh, size_t offset)
+  {
+    const FESpace & fes = *gf.GetFESpace();
+    const MeshAccess & ma = *fes.GetMeshAccess();
+    auto par = fes.GetParallelDofs();
+    NgMPI_Comm comm = ma.GetCommunicator();
+
+    Array<Vec<N+1,int>> keys;
+    Array<SCAL> data;
+    Array<DofId> dnums;
+    for (size_t i = 0; i < ma.GetNNodes(nt); i++)
+      {
+        fes.GetDofNrs (NodeId(nt, i), dnums);
+        if (dnums.Size() == 0) continue;
+        if (par && !par->IsMasterDof (dnums[0])) continue;
+
+        Vector<SCAL> elvec(dnums.Size()*fes.GetDimension());
+        gf.GetElementVector (dnums, elvec);
+        keys.Append (CheckpointKey<N> (ma, nt, i, elvec.Size()));
+        for (auto v : elvec)
+          data.Append (v);
+      }
+
+    int64_t nloc[2] = { int64_t(keys.Size()), int64_t(data.Size()) };
+    int64_t first[2] = { 0, 0 }, total[2];
+    MPI_Exscan (nloc, first, 2, MPI_INT64_T, MPI_SUM, comm);
+    if (comm.Rank() == 0) first[0] = first[1] = 0;
+    MPI_Allreduce (nloc, total, 2, MPI_INT64_T, MPI_SUM, comm);
+
+    if (comm.Rank() == 0)
+      MPI_File_write_at (fh, offset, total, 2, MPI_INT64_T, MPI_STATUS_IGNORE);
+    size_t keys_offset = offset + 2*sizeof(int64_t);
+    size_t data_offset = keys_offset + total[0] * sizeof(Vec<N+1,int>);
+
+    MPI_File_write_at_all (fh, keys_offset + first[0]*sizeof(Vec<N+1,int>), keys.Data(),
+                           keys.Size()*(N+1), MPI_INT, MPI_STATUS_IGNORE);
+    MPI_File_write_at_all (fh, data_offset + first[1]*sizeof(SCAL), data.Data(),
+                           data.Size()*sizeof(SCAL)/sizeof(double), MPI_DOUBLE, MPI_STATUS_IGNORE);
+    return data_offset + total[1]*sizeof(SCAL);
+  }
+
+  template <int N, typename SCAL>
+  static size_t LoadNodeTypeCollective (S_GridFunction<SCAL> & gf, NODE_TYPE nt,
+                                        MPI_File fh, size_t offset)
+  {
+    typedef Vec<N+1,int> TKEY;
+    constexpr int ES = sizeof(SCAL) / sizeof(double);
+    const FESpace & fes = *gf.GetFESpace();
+    const MeshAccess & ma = *fes.GetMeshAccess();
+    auto par = fes.GetParallelDofs();
+    NgMPI_Comm comm = ma.GetCommunicator();
+    int np = comm.Size();
+
+    int64_t total[2];
+    MPI_File_read_at_all (fh, offset, total, 2, MPI_INT64_T, MPI_STATUS_IGNORE);
+    size_t keys_offset = offset + 2*sizeof(int64_t);
+    size_t data_offset = keys_offset + total[0] * sizeof(TKEY);
+
+    // my slice of the file
+    auto myrange = Range(size_t(total[0])).Split (comm.Rank(), np);
+    Array<TKEY> fkeys(myrange.Size());
+    MPI_File_read_at_all (fh, keys_offset + myrange.First()*sizeof(TKEY), fkeys.Data(),
+                          fkeys.Size()*(N+1), MPI_INT, MPI_STATUS_IGNORE);
+    int64_t nfdata = 0, ffirst = 0;
+    for (auto & key : fkeys)
+      nfdata += key[N];
+    MPI_Exscan (&nfdata, &ffirst, 1, MPI_INT64_T, MPI_SUM, comm);
+    if (comm.Rank() == 0) ffirst = 0;
+    Array<SCAL> fdata(nfdata);
+    MPI_File_read_at_all (fh, data_offset + ffirst*sizeof(SCAL), fdata.Data(),
+                          nfdata*ES, MPI_DOUBLE, MPI_STATUS_IGNORE);
+
+    // send the records to the directory ranks
+    Array<int> nkeys(np), ndata(np);
+    nkeys = 0; ndata = 0;
+    for (auto & key : fkeys)
+      {
+        int p = CheckpointOwner<N> (key, np);
+        nkeys[p]++;
+        ndata[p] += key[N];
+      }
+    Table<TKEY> send_keys(nkeys);
+    Table<SCAL> send_data(ndata);
+    nkeys = 0; ndata = 0;
+    for (size_t i = 0, cnt = 0; i < fkeys.Size(); i++)
+      {
+        int p = CheckpointOwner<N> (fkeys[i], np);
+        send_keys[p][nkeys[p]++] = fkeys[i];
+        for (int j = 0; j < fkeys[i][N]; j++)
+          send_data[p][ndata[p]++] = fdata[cnt++];
+      }
+    Table<TKEY> dir_keys = CheckpointAllToAll<int> (send_keys, comm);
+    Table<SCAL> dir_data = CheckpointAllToAll<double> (send_data, comm);
+
+    // ask the directory for my master nodes
+    Array<int> nodes;
+    Array<TKEY> mykeys;
+    Array<DofId> dnums;
+    for (size_t i = 0; i < ma.GetNNodes(nt); i++)
+      {
+        fes.GetDofNrs (NodeId(nt, i), dnums);
+        if (dnums.Size() == 0) continue;
+        if (par && !par->IsMasterDof (dnums[0])) continue;
+        nodes.Append (i);
+        mykeys.Append (CheckpointKey<N> (ma, nt, i, dnums.Size()*fes.GetDimension()));
+      }
+    nkeys = 0;
+    for (auto & key : mykeys)
+      nkeys[CheckpointOwner<N> (key, np)]++;
+    Table<TKEY> req_keys(nkeys);
+    Table<int> req_nodes(nkeys);
+    nkeys = 0;
+    for (size_t i = 0; i < mykeys.Size(); i++)
+      {
+        int p = CheckpointOwner<N> (mykeys[i], np);
+        req_nodes[p][nkeys[p]] = nodes[i];
+        req_keys[p][nkeys[p]++] = mykeys[i];
+      }
+    Table<TKEY> asked = CheckpointAllToAll<int> (req_keys, comm);
+
+    // the directory answers in the order of the requests
+    FlatArray<TKEY> allkeys = dir_keys.AsArray();
+    Array<size_t> first_data(allkeys.Size()+1);
+    first_data[0] = 0;
+    for (size_t i = 0; i < allkeys.Size(); i++)
+      first_data[i+1] = first_data[i] + allkeys[i][N];
+    Array<int> index(allkeys.Size());
+    for (size_t i = 0; i < index.Size(); i++) index[i] = i;
+    QuickSortI (allkeys, index, MyLess<N+1>);
+
+    auto find = [&] (const TKEY & key) -> int
+      {
+        size_t lo = 0, hi = index.Size();
+        while (lo < hi)
+          {
+            size_t mid = (lo+hi)/2;
+            if (MyLess<N+1> (allkeys[index[mid]], key)) lo = mid+1;
+            else hi = mid;
+          }
+        if (lo == index.Size() || MyLess<N+1> (key, allkeys[index[lo]]))
+          throw Exception ("LoadCollective: node not found in file, or has different number of dofs");
+        return index[lo];
+      };
+
+    Array<int> nreply(np);
+    for (int p = 0; p < np; p++)
+      {
+        nreply[p] = 0;
+        for (auto & key : asked[p])
+          nreply[p] += key[N];
+      }
+    Table<SCAL> reply(nreply);
+    FlatArray<SCAL> alldata = dir_data.AsArray();
+    for (int p = 0; p < np; p++)
+      {
+        int cnt = 0;
+        for (auto & key : asked[p])
+          {
+            int rec = find (key);
+            for (size_t j = first_data[rec]; j < first_data[rec+1]; j++)
+              reply[p][cnt++] = alldata[j];
+          }
+      }
+    Table<SCAL> answer = CheckpointAllToAll<double> (reply, comm);
+
+    for (int p = 0; p < np; p++)
+      for (size_t i = 0, cnt = 0; i < req_nodes[p].Size(); i++)
+        {
+          fes.GetDofNrs (NodeId(nt, req_nodes[p][i]), dnums);
+          Vector<SCAL> elvec(dnums.Size()*fes.GetDimension());
+          for (auto & v : elvec)
+            v = answer[p][cnt++];
+          gf.SetElementVector (dnums, elvec);
+        }
+    
+    return data_offset + total[1]*sizeof(SCAL);
+  }
+#endif
+
+  
+  template <class SCAL>
+  void S_GridFunction<SCAL> :: SaveCollective (const string & filename) const
+  {
+#ifdef PARALLEL
+    static Timer t("GridFunction::SaveCollective");
+    RegionTimer reg(t);
+    
+    auto comm = ma->GetCommunicator();
+    GetVector().Cumulate();
+
+    MPI_File fh;
+    if (MPI_File_open (comm, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                       MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+      throw Exception ("SaveCollective: cannot open file " + filename);
+    MPI_File_set_size (fh, 0);
+
+    if (comm.Rank() == 0)
+      {
+        int64_t scalsize = sizeof(SCAL);
+        MPI_File_write_at (fh, 0, "NGSGFCKP", 8, MPI_CHAR, MPI_STATUS_IGNORE);
+        MPI_File_write_at (fh, 8, &scalsize, 1, MPI_INT64_T, MPI_STATUS_IGNORE);
+      }
+    size_t offset = 16;
+    offset = SaveNodeTypeCollective<1> (*this, NT_VERTEX, fh, offset);
+    offset = SaveNodeTypeCollective<2> (*this, NT_EDGE, fh, offset);
+    offset = SaveNodeTypeCollective<4> (*this, NT_FACE, fh, offset);
+    offset = SaveNodeTypeCollective<8> (*this, NT_CELL, fh, offset);
+    MPI_File_close (&fh);
+#else
+    throw Exception ("SaveCollective needs the MPI version");
+#endif
+  }
+
+  template <class SCAL>
+  void S_GridFunction<SCAL> :: LoadCollective (const string & filename) 
+  {
+#ifdef PARALLEL
+    static Timer t("GridFunction::LoadCollective");
+    RegionTimer reg(t);
+    
+    auto comm = ma->GetCommunicator();
+
+    MPI_File fh;
+    if (MPI_File_open (comm, filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+      throw Exception ("LoadCollective: cannot open file " + filename);
+
+    char magic[8];
+    int64_t scalsize;
+    MPI_File_read_at_all (fh, 0, magic, 8, MPI_CHAR, MPI_STATUS_IGNORE);
+    MPI_File_read_at_all (fh, 8, &scalsize, 1, MPI_INT64_T, MPI_STATUS_IGNORE);
+    if (string(magic, 8) != "NGSGFCKP" || scalsize != sizeof(SCAL))
+      {
+        MPI_File_close (&fh);
+        throw Exception ("LoadCollective: " + filename + " is not a checkpoint of this scalar type");
+      }
+
+    GetVector() = 0.0;
+    GetVector().SetParallelStatus (DISTRIBUTED);
+    size_t offset = 16;
+    offset = LoadNodeTypeCollective<1> (*this, NT_VERTEX, fh, offset);
+    offset = LoadNodeTypeCollective<2> (*this, NT_EDGE, fh, offset);
+    offset = LoadNodeTypeCollective<4> (*this, NT_FACE, fh, offset);
+    offset = LoadNodeTypeCollective<8> (*this, NT_CELL, fh, offset);
+    MPI_File_close (&fh);
+    GetVector().Cumulate();
+#else
+    throw Exception ("LoadCollective needs the MPI version");
+#endif
+  }
+
+
+
   ComponentGridFunction ::
   ComponentGridFunction (shared_ptr<GridFunction> agf_parent, int acomp)
     : GridFunction (dynamic_cast<const CompoundFESpace&> (*agf_parent->GetFESpace())[acomp],
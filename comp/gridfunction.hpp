@@ -272,6 +272,9 @@ namespace ngcomp
 
     virtual void Load (istream & ist) = 0;
     virtual void Save (ostream & ost) const = 0;
+    /// collective checkpoint with MPI-IO, can be loaded on any number of ranks
+    virtual void SaveCollective (const string & filename) const = 0;
+    virtual void LoadCollective (const string & filename) = 0;
     using NGS_Object::shared_from_this;
   };
 
@@ -305,6 +308,10 @@ namespace ngcomp
     virtual void Load (istream & ist);
     virtual void Save (ostream & ost) const;
 
+    // every rank writes/reads its own master nodes, keyed by global vertex numbers
+    virtual void SaveCollective (const string & filename) const;
+    virtual void LoadCollective (const string & filename);
+
     virtual void Update ();
 
   private:
@@ -366,6 +373,8 @@ namespace ngcomp
     void Update () override;
     void Load(istream& ist) override { throw Exception("Load not implemented for ComponentGF"); }
     void Save(ostream& ost) const override { throw Exception("Save not implemented for ComponentGF"); }
+    void SaveCollective(const string & filename) const override { throw Exception("SaveCollective not implemented for ComponentGF"); }
+    void LoadCollective(const string & filename) override { throw Exception("LoadCollective not implemented for ComponentGF"); }
     shared_ptr<GridFunction> GetParent() const { return gf_parent; }
     int GetComponent() const { return comp; }
   };
@@ -1568,8 +1568,13 @@ active_dofs : BitArray or None
     .def("Update", [](GF& self) { self.Update(); },
          "update vector size to finite element space dimension after mesh refinement")
     
-    .def("Save", [](GF& self, string filename, bool parallel)
+    .def("Save", [](GF& self, string filename, bool parallel, bool collective)
          {
+           if (collective)
+             {
+               self.SaveCollective(filename);
+               return;
+             }
            ofstream out(filename, ios::binary);
            if (parallel)
              self.Save(out);
@@ -1577,7 +1582,8 @@ active_dofs : BitArray or None
              for (auto d : self.GetVector().FVDouble())
                SaveBin(out, d);
          },
-         py::arg("filename"), py::arg("parallel")=false, docu_string(R"raw_string(
+         py::arg("filename"), py::arg("parallel")=false, py::arg("collective")=false,
+         docu_string(R"raw_string(
 Saves the gridfunction into a file.
 
 Parameters:
@@ -1588,9 +1594,18 @@ filename : string
 parallel : bool
   input parallel
 
+collective : bool
+  every rank writes its own part with MPI-IO, the file can be
+  loaded with collective=True on any number of ranks
+
 )raw_string"))
-    .def("Load", [](GF& self, string filename, bool parallel)
+    .def("Load", [](GF& self, string filename, bool parallel, bool collective)
          {
+           if (collective)
+             {
+               self.LoadCollective(filename);
+               return;
+             }
            ifstream in(filename, ios::binary);
            if (parallel)
              self.Load(in);
@@ -1598,7 +1613,8 @@ parallel : bool
              for (auto & d : self.GetVector().FVDouble())
                LoadBin(in, d);
          },
-         py::arg("filename"), py::arg("parallel")=false, docu_string(R"raw_string(       
+         py::arg("filename"), py::arg("parallel")=false, py::arg("collective")=false,
+         docu_string(R"raw_string(       
 Loads a gridfunction from a file.
 
 Parameters:
@@ -1609,6 +1625,9 @@ filename : string
 parallel : bool
   input parallel
 
+collective : bool
+  load a file written with collective=True
+
 )raw_string"))
     .def("Set", 
          [](shared_ptr<GF> self, spCF cf,
@@ -2055,6 +2074,14 @@ space : ngsolve.FESpace
                      py::arg("geom_free") = "bool = False\n"
                      "  when element matrices are independent of geometry, we store them \n"
                      "  only for the referecne elements",
+                     py::arg("precompute") = "bool = False\n"
+                     "  together with nonassemble: store the mapped shape functions\n"
+                     "  at the integration points per element for a faster\n"
+                     "  matrix-free application on a fixed mesh",
+                     py::arg("precompute_single") = "bool = False\n"
+                     "  store precomputed shapes in single precision",
+                     py::arg("precompute_memory") = "float = 0\n"
+                     "  memory limit for precomputed data in MB, 0 for no limit",
                      py::arg("check_unused") = "bool = True\n"
 		     "  If set prints warnings if not UNUSED_DOFS are not used."
                      );
@@ -3642,7 +3669,8 @@ deformation : ngsolve.comp.GridFunction
 
    py::class_<BaseVTKOutput, shared_ptr<BaseVTKOutput>>(m, "VTKOutput")
     .def(py::init([] (shared_ptr<MeshAccess> ma, py::list coefs_list,
-                      py::list names_list, string filename, int subdivision, int only_element)
+                      py::list names_list, string filename, int subdivision, int only_element,
+                      bool legacy, bool compress)
          -> shared_ptr<BaseVTKOutput>
          {
            Array<shared_ptr<CoefficientFunction> > coefs
@@ -3651,9 +3679,11 @@ deformation : ngsolve.comp.GridFunction
              = makeCArray<string> (names_list);
            shared_ptr<BaseVTKOutput> ret;
            if (ma->GetDimension() == 2)
-             ret = make_shared<VTKOutput<2>> (ma, coefs, names, filename, subdivision, only_element);
+             ret = make_shared<VTKOutput<2>> (ma, coefs, names, filename, subdivision, only_element,
+                                              legacy, compress);
            else
-             ret = make_shared<VTKOutput<3>> (ma, coefs, names, filename, subdivision, only_element);
+             ret = make_shared<VTKOutput<3>> (ma, coefs, names, filename, subdivision, only_element,
+                                              legacy, compress);
            return ret;
          }),
          py::arg("ma"),
@@ -3661,7 +3691,17 @@ deformation : ngsolve.comp.GridFunction
          py::arg("names") = py::list(),
          py::arg("filename") = "vtkout",
          py::arg("subdivision") = 0,
-         py::arg("only_element") = -1
+         py::arg("only_element") = -1,
+         py::arg("legacy") = true,
+         py::arg("compress") = false,
+         docu_string(R"raw_string(
+legacy : bool
+  write ASCII .vtk files, otherwise binary .vtu files (a .pvtu index
+  and one .vtu piece per rank for distributed meshes)
+
+compress : bool
+  zlib-compress the .vtu data
+)raw_string")
          )
      .def("Do", [](shared_ptr<BaseVTKOutput> self, VorB vb)
           { 
@@ -3677,6 +3717,24 @@ deformation : ngsolve.comp.GridFunction
           py::arg("drawelems"),
           py::call_guard<py::gil_scoped_release>())
      ;
+
+   py::class_<AsyncOutput, shared_ptr<AsyncOutput>>(m, "AsyncOutput",
+                                                    docu_string(R"raw_string(
+Writes output on a background thread, while the solver continues.
+VTK output is evaluated when requested, vectors are copied, the
+background thread compresses and writes the files. Queued and running
+outputs are limited by max_memory (in bytes).
+)raw_string"))
+     .def(py::init<size_t>(), py::arg("max_memory")=1000*1000*1000)
+     .def("Do", &AsyncOutput::Do, py::arg("vtk"), py::arg("vb")=VOL,
+          "evaluate vtk and write it in the background",
+          py::call_guard<py::gil_scoped_release>())
+     .def("Save", &AsyncOutput::Save, py::arg("gf"), py::arg("filename"),
+          "snapshot gf and save it in the background",
+          py::call_guard<py::gil_scoped_release>())
+     .def("Wait", &AsyncOutput::Wait, "wait until all output is written",
+          py::call_guard<py::gil_scoped_release>())
+     ;
    
    m.def("PatchwiseSolve",
          [&] (shared_ptr<SumOfIntegrals> bf,
@@ -5,6 +5,9 @@
 /*********************************************************************/
 
 #include <comp.hpp>
+#ifdef NGS_USE_ZLIB
+#include <zlib.h>
+#endif
 
 namespace ngcomp
 { 
@@ -19,7 +22,9 @@ namespace ngcomp
                 flags.GetStringListFlag ("fieldnames" ),
                 flags.GetStringFlag ("filename","output"),
                 (int) flags.GetNumFlag ( "subdivision", 0),
-                (int) flags.GetNumFlag ( "only_element", -1))
+                (int) flags.GetNumFlag ( "only_element", -1),
+                !flags.GetDefineFlag ("vtu"),
+                flags.GetDefineFlag ("compress"))
   {;}
 
 
@@ -27,10 +32,16 @@ namespace ngcomp
   VTKOutput<D>::VTKOutput (shared_ptr<MeshAccess> ama,
                            const Array<shared_ptr<CoefficientFunction>> & a_coefs,
                            const Array<string> & a_field_names,
-                           string a_filename, int a_subdivision, int a_only_element)
+                           string a_filename, int a_subdivision, int a_only_element,
+                           bool a_legacy, bool a_compress)
     : ma(ama), coefs(a_coefs), fieldnames(a_field_names),
-      filename(a_filename), subdivision(a_subdivision), only_element(a_only_element)
+      filename(a_filename), subdivision(a_subdivision), only_element(a_only_element),
+      legacy(a_legacy), compress(a_compress)
   {
+#ifndef NGS_USE_ZLIB
+    if (compress)
+      throw Exception ("VTKOutput: compression needs NGSolve built with zlib");
+#endif
     value_field.SetSize(a_coefs.Size());
     for (int i = 0; i < a_coefs.Size(); i++)
       if (fieldnames.Size() > i)
@@ -410,20 +421,38 @@ namespace ngcomp
 
   template <int D> 
   void VTKOutput<D>::Do (LocalHeap & lh, VorB vb, const BitArray * drawelems)
+  {
+    if (!legacy)
+      {
+        DoVTU (lh, vb, drawelems);
+        return;
+      }
+    
+    string name = StartLegacy();
+    EvaluateLegacy (lh, vb, drawelems);
+    WriteLegacy (name, vb, drawelems);
+  }
+
+  template <int D> 
+  string VTKOutput<D>::StartLegacy ()
   {
     ostringstream filenamefinal;
     filenamefinal << filename;
     if (output_cnt > 0)
       filenamefinal << "_" << output_cnt;
     filenamefinal << ".vtk";
-    fileout = make_shared<ofstream>(filenamefinal.str());
     cout << IM(4) << " Writing VTK-Output";
     if (output_cnt > 0)
       cout << IM(4) << " ( " << output_cnt << " )";
     cout << IM(4) << ":" << flush;
     
     output_cnt++;
+    return filenamefinal.str();
+  }
 
+  template <int D> 
+  void VTKOutput<D>::EvaluateLegacy (LocalHeap & lh, VorB vb, const BitArray * drawelems)
+  {
     ResetArrays();
 
     Array<IntegrationPoint> ref_vertices_tet(0), ref_vertices_prism(0), ref_vertices_trig(0), ref_vertices_quad(0), ref_vertices_hex(0);
@@ -441,12 +470,6 @@ namespace ngcomp
     FillReferenceQuad(ref_vertices_quad,ref_quads);
     FillReferenceTrig(ref_vertices_trig,ref_trigs);
     FillReferenceHex(ref_vertices_hex,ref_hexes);
-      
-    // header:
-    *fileout << "# vtk DataFile Version 3.0" << endl;
-    *fileout << "vtk output" << endl;
-    *fileout << "ASCII" << endl;
-    *fileout << "DATASET UNSTRUCTURED_GRID" << endl;
 
     int ne = ma->GetNE(vb);
 
@@ -538,15 +561,446 @@ namespace ngcomp
       }
 
     }
+  }
+
+  /// plain file output of the evaluated arrays
+  template <int D> 
+  void VTKOutput<D>::WriteLegacy (string name, VorB vb, const BitArray * drawelems)
+  {
+    fileout = make_shared<ofstream>(name);
+    
+    // header:
+    *fileout << "# vtk DataFile Version 3.0" << endl;
+    *fileout << "vtk output" << endl;
+    *fileout << "ASCII" << endl;
+    *fileout << "DATASET UNSTRUCTURED_GRID" << endl;
 
     PrintPoints();
     PrintCells();
     PrintCellTypes(vb,drawelems);
     PrintFieldData();
+    fileout = nullptr;
       
     cout << IM(4) << " Done." << endl;
   }    
 
+  /*
+    One DataArray in the appended section of a .vtu file. The data is
+    streamed into an anonymous temporary file, compressed in blocks of
+    BLOCKSIZE bytes as vtkZLibDataCompressor expects. 
+  */
+  class VTUDataStream
+  {
+    FILE * tmp;
+    bool compress;
+    Array<char> pending;
+    Array<uint64_t> csizes;
+    uint64_t nbytes = 0, stored = 0;
+  public:
+    static constexpr size_t BLOCKSIZE = 1 << 20;
+
+    VTUDataStream (bool acompress) : compress(acompress)
+    {
+      tmp = tmpfile();
+      if (!tmp)
+        throw Exception ("VTKOutput: cannot create temporary file");
+    }
+    ~VTUDataStream () { fclose (tmp); }
+
+    template <typename T>
+    void Append (FlatArray<T> data)
+    {
+      auto p = reinterpret_cast<const char*> (data.Data());
+      size_t bytes = data.Size()*sizeof(T);
+      nbytes += bytes;
+      if (!compress)
+        {
+          Write (p, bytes);
+          return;
+        }
+      while (bytes)
+        {
+          size_t n = min(bytes, BLOCKSIZE-pending.Size());
+          size_t old = pending.Size();
+          pending.SetSize (old+n);
+          memcpy (pending.Data()+old, p, n);
+          p += n;
+          bytes -= n;
+          if (pending.Size() == BLOCKSIZE)
+            CompressPending();
+        }
+    }
+
+    void Finish ()
+    {
+      if (compress && pending.Size())
+        CompressPending();
+    }
+
+    /// block header plus data, as it goes into the appended section
+    size_t TotalSize () const { return Header().Size()*sizeof(uint64_t) + stored; }
+
+    void CopyTo (ostream & ost) const
+    {
+      auto header = Header();
+      ost.write (reinterpret_cast<const char*> (header.Data()), header.Size()*sizeof(uint64_t));
+      rewind (tmp);
+      char buf[1<<16];
+      size_t n;
+      while ((n = fread (buf, 1, sizeof(buf), tmp)) > 0)
+        ost.write (buf, n);
+    }
+
+  private:
+    void Write (const char * p, size_t bytes)
+    {
+      if (fwrite (p, 1, bytes, tmp) != bytes)
+        throw Exception ("VTKOutput: writing temporary file failed");
+      stored += bytes;
+    }
+
+    void CompressPending ()
+    {
+#ifdef NGS_USE_ZLIB
+      uLongf clen = compressBound (pending.Size());
+      Array<char> cbuf(clen);
+      compress2 (reinterpret_cast<Bytef*>(cbuf.Data()), &clen,
+                 reinterpret_cast<const Bytef*>(pending.Data()), pending.Size(), Z_DEFAULT_COMPRESSION);
+      Write (cbuf.Data(), clen);
+      csizes.Append (clen);
+#endif
+      pending.SetSize0();
+    }
+
+    Array<uint64_t> Header () const
+    {
+      Array<uint64_t> header;
+      if (!compress)
+        {
+          header.Append (nbytes);
+          return header;
+        }
+      uint64_t last = nbytes % BLOCKSIZE;
+      if (last == 0 && nbytes > 0) last = BLOCKSIZE;
+      header.Append (csizes.Size());
+      header.Append (BLOCKSIZE);
+      header.Append (last);
+      for (auto c : csizes)
+        header.Append (c);
+      return header;
+    }
+  };
+
+  /*
+    The evaluated data of a block of elements. Connectivity and offsets
+    are already numbered within the whole piece.
+  */
+  struct VTUBlock
+  {
+    Array<float> coords;
+    Array<int64_t> conn, offsets;
+    Array<uint8_t> celltypes;
+    Array<Array<float>> values;
+
+    size_t Bytes () const
+    {
+      size_t bytes = coords.Size()*sizeof(float) + celltypes.Size()
+        + (conn.Size()+offsets.Size())*sizeof(int64_t);
+      for (auto & v : values)
+        bytes += v.Size()*sizeof(float);
+      return bytes;
+    }
+  };
+
+  /*
+    Writes the blocks into the .vtu piece, and the .pvtu index on rank 0.
+    Plain file I/O, it may run on a thread outside the TaskManager.
+  */
+  class VTUWriter
+  {
+    string base, piecename;
+    int rank, size;
+    bool compress;
+    Array<string> names;
+    Array<int> dims;
+    // points, connectivity, offsets, types, then the fields
+    Array<shared_ptr<VTUDataStream>> streams;
+    size_t npoints = 0, ncells = 0;
+  public:
+    VTUWriter (string abase, int arank, int asize, bool acompress,
+               Array<string> && anames, Array<int> && adims)
+      : base(abase), rank(arank), size(asize), compress(acompress),
+        names(std::move(anames)), dims(std::move(adims))
+    {
+      piecename = size > 1 ? base + "_" + ToString(rank) + ".vtu" : base + ".vtu";
+      for (size_t i = 0; i < 4+names.Size(); i++)
+        streams.Append (make_shared<VTUDataStream> (compress));
+    }
+
+    void Append (const VTUBlock & block)
+    {
+      streams[0]->Append (FlatArray<float> (block.coords));
+      streams[1]->Append (FlatArray<int64_t> (block.conn));
+      streams[2]->Append (FlatArray<int64_t> (block.offsets));
+      streams[3]->Append (FlatArray<uint8_t> (block.celltypes));
+      for (size_t k = 0; k < names.Size(); k++)
+        streams[4+k]->Append (FlatArray<float> (block.values[k]));
+      npoints += block.coords.Size()/3;
+      ncells += block.offsets.Size();
+    }
+
+    void Write ()
+    {
+      for (auto & s : streams)
+        s->Finish();
+
+      ofstream out(piecename, ios::binary);
+      out << "<?xml version=\"1.0\"?>\n"
+          << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\"";
+      if (compress)
+        out << " compressor=\"vtkZLibDataCompressor\"";
+      out << ">\n<UnstructuredGrid>\n"
+          << "<Piece NumberOfPoints=\"" << npoints << "\" NumberOfCells=\"" << ncells << "\">\n";
+
+      // the appended data comes in the order the arrays are declared
+      Array<int> order;
+      size_t offset = 0;
+      auto data_array = [&] (string type, string name, int ncomp, int nr)
+        {
+          out << "<DataArray type=\"" << type << "\"";
+          if (name.size())
+            out << " Name=\"" << name << "\"";
+          out << " NumberOfComponents=\"" << ncomp << "\" format=\"appended\" offset=\"" << offset << "\"/>\n";
+          offset += streams[nr]->TotalSize();
+          order.Append (nr);
+        };
+    
+      out << "<PointData>\n";
+      for (size_t k = 0; k < names.Size(); k++)
+        data_array ("Float32", names[k], dims[k], 4+k);
+      out << "</PointData>\n<Points>\n";
+      data_array ("Float32", "", 3, 0);
+      out << "</Points>\n<Cells>\n";
+      data_array ("Int64", "connectivity", 1, 1);
+      data_array ("Int64", "offsets", 1, 2);
+      data_array ("UInt8", "types", 1, 3);
+      out << "</Cells>\n</Piece>\n</UnstructuredGrid>\n"
+          << "<AppendedData encoding=\"raw\">\n_";
+      for (int nr : order)
+        streams[nr]->CopyTo (out);
+      out << "\n</AppendedData>\n</VTKFile>\n";
+      if (!out)
+        throw Exception ("VTKOutput: writing " + piecename + " failed");
+
+      if (size > 1 && rank == 0)
+        {
+          // pieces are referenced relative to the .pvtu file
+          auto slash = base.find_last_of ("/\\");
+          string localbase = (slash == string::npos) ? base : base.substr(slash+1);
+        
+          ofstream pout(base + ".pvtu");
+          pout << "<?xml version=\"1.0\"?>\n"
+               << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n"
+               << "<PUnstructuredGrid GhostLevel=\"0\">\n<PPointData>\n";
+          for (size_t k = 0; k < names.Size(); k++)
+            pout << "<PDataArray type=\"Float32\" Name=\"" << names[k]
+                 << "\" NumberOfComponents=\"" << dims[k] << "\"/>\n";
+          pout << "</PPointData>\n<PPoints>\n"
+               << "<PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n"
+               << "</PPoints>\n";
+          for (int p = 0; p < size; p++)
+            pout << "<Piece Source=\"" << localbase << "_" << p << ".vtu\"/>\n";
+          pout << "</PUnstructuredGrid>\n</VTKFile>\n";
+        }
+    }
+  };
+
+  
+  template <int D> 
+  void VTKOutput<D>::DoVTU (LocalHeap & lh, VorB vb, const BitArray * drawelems)
+  {
+    static Timer t("VTKOutput - vtu");
+    static Timer twrite("VTKOutput - vtu write");
+    RegionTimer reg(t);
+
+    auto writer = StartVTU();
+    EvaluateVTU (lh, vb, drawelems, [&] (VTUBlock & block)
+                 {
+                   RegionTimer regw(twrite);
+                   writer->Append (block);
+                 });
+    RegionTimer regw(twrite);
+    writer->Write();
+    cout << IM(4) << " Done." << endl;
+  }
+
+  template <int D> 
+  shared_ptr<VTUWriter> VTKOutput<D>::StartVTU ()
+  {
+    auto comm = ma->GetCommunicator();
+    string base = filename;
+    if (output_cnt > 0)
+      base += "_" + ToString(output_cnt);
+    cout << IM(4) << " Writing VTU-Output";
+    if (output_cnt > 0)
+      cout << IM(4) << " ( " << output_cnt << " )";
+    cout << IM(4) << ":" << flush;
+    output_cnt++;
+
+    Array<string> names;
+    Array<int> dims;
+    for (int k = 0; k < coefs.Size(); k++)
+      {
+        names.Append (value_field[k]->Name());
+        dims.Append (coefs[k]->Dimension());
+      }
+    return make_shared<VTUWriter> (base, comm.Rank(), comm.Size(), compress,
+                                   std::move(names), std::move(dims));
+  }
+
+  /// evaluates block by block, so memory stays bounded when the sink writes them out
+  template <int D> 
+  void VTKOutput<D>::EvaluateVTU (LocalHeap & lh, VorB vb, const BitArray * drawelems,
+                                  const function<void(VTUBlock&)> & sink)
+  {
+    static Timer teval("VTKOutput - vtu evaluate");
+
+    // reference lattices for trig, quad, tet, hex, prism
+    Array<IntegrationPoint> ref_pts[5];
+    Array<INT<ELEMENT_MAXPOINTS+1>> ref_cells[5];
+    FillReferenceTrig (ref_pts[0], ref_cells[0]);
+    FillReferenceQuad (ref_pts[1], ref_cells[1]);
+    FillReferenceTet (ref_pts[2], ref_cells[2]);
+    FillReferenceHex (ref_pts[3], ref_cells[3]);
+    FillReferencePrism (ref_pts[4], ref_cells[4]);
+    const uint8_t vtk_types[5] = { 5, 9, 10, 12, 13 };
+    auto type_index = [] (ELEMENT_TYPE et) -> int
+      {
+        switch (et)
+          {
+          case ET_TRIG: return 0;
+          case ET_QUAD: return 1;
+          case ET_TET: return 2;
+          case ET_HEX: return 3;
+          case ET_PRISM: return 4;
+          default:
+            throw Exception("VTK output for element-type"+ToString(et)+"not supported");
+          }
+      };
+
+    Array<int> elnrs;
+    int ne = ma->GetNE(vb);
+    IntRange range = only_element >= 0 ? IntRange(only_element,only_element+1) : IntRange(ne);
+    for (int elnr : range)
+      if (!drawelems || drawelems->Test(elnr))
+        elnrs.Append (elnr);
+
+    int ncoefs = coefs.Size();
+    constexpr size_t blocksize = 4096;
+    size_t npoints = 0;
+    int64_t nconn = 0;
+    for (size_t first = 0; first < elnrs.Size(); first += blocksize)
+      {
+        FlatArray<int> block = elnrs.Range (first, min(first+blocksize, elnrs.Size()));
+        Array<int> types(block.Size());
+        Array<size_t> firstpoint(block.Size()+1);
+        firstpoint[0] = 0;
+        for (size_t i = 0; i < block.Size(); i++)
+          {
+            types[i] = type_index (ma->GetElType (ElementId(vb, block[i])));
+            firstpoint[i+1] = firstpoint[i] + ref_pts[types[i]].Size();
+          }
+        size_t bnp = firstpoint[block.Size()];
+
+        VTUBlock data;
+        data.coords.SetSize (3*bnp);
+        data.values.SetSize (ncoefs);
+        for (int k = 0; k < ncoefs; k++)
+          data.values[k].SetSize (bnp*coefs[k]->Dimension());
+
+        teval.Start();
+        ParallelForRange (block.Size(), [&] (IntRange r)
+          {
+            LocalHeap slh = lh.Split();
+            for (size_t i : r)
+              {
+                HeapReset hr(slh);
+                ElementId ei(vb, block[i]);
+                ElementTransformation & eltrans = ma->GetTrafo (ei, slh);
+                FlatArray<IntegrationPoint> pts = ref_pts[types[i]];
+                IntegrationRule ir(pts.Size(), pts.Data());
+                BaseMappedIntegrationRule & mir = eltrans(ir, slh);
+                
+                for (size_t j = 0; j < pts.Size(); j++)
+                  {
+                    auto p = mir[j].GetPoint();
+                    for (int d = 0; d < 3; d++)
+                      data.coords[3*(firstpoint[i]+j)+d] = d < p.Size() ? p(d) : 0.0;
+                  }
+                
+                for (int k = 0; k < ncoefs; k++)
+                  {
+                    int dim = coefs[k]->Dimension();
+                    FlatMatrix<> vals(pts.Size(), dim, slh);
+                    coefs[k]->Evaluate (mir, vals);
+                    for (size_t j = 0; j < pts.Size(); j++)
+                      for (int d = 0; d < dim; d++)
+                        data.values[k][(firstpoint[i]+j)*dim+d] = vals(j,d);
+                  }
+              }
+          });
+        teval.Stop();
+
+        for (size_t i = 0; i < block.Size(); i++)
+          for (auto & c : ref_cells[types[i]])
+            {
+              for (int v = 1; v <= c[0]; v++)
+                data.conn.Append (npoints + firstpoint[i] + c[v]);
+              nconn += c[0];
+              data.offsets.Append (nconn);
+              data.celltypes.Append (vtk_types[types[i]]);
+            }
+        npoints += bnp;
+        sink (data);
+      }
+  }
+
+  template <int D> 
+  function<void()> VTKOutput<D>::Prepare (LocalHeap & lh, VorB vb, size_t & bytes)
+  {
+    static Timer t("VTKOutput::Prepare");
+    RegionTimer reg(t);
+    bytes = 0;
+    
+    if (!legacy)
+      {
+        auto writer = StartVTU();
+        auto blocks = make_shared<Array<VTUBlock>>();
+        EvaluateVTU (lh, vb, nullptr, [&] (VTUBlock & block)
+                     {
+                       bytes += block.Bytes();
+                       blocks->Append (std::move(block));
+                     });
+        return [writer, blocks] ()
+          {
+            for (auto & block : *blocks)
+              writer->Append (block);
+            writer->Write();
+          };
+      }
+
+    string name = StartLegacy();
+    EvaluateLegacy (lh, vb, nullptr);
+    // the copy keeps the evaluated arrays, ours are refilled by the next output
+    auto snapshot = make_shared<VTKOutput<D>> (*this);
+    for (auto & field : snapshot->value_field)
+      field = make_shared<ValueField> (*field);
+    bytes = points.Size()*sizeof(Vec<D>) + cells.Size()*sizeof(INT<ELEMENT_MAXPOINTS+1>);
+    for (auto & field : value_field)
+      bytes += field->Size()*sizeof(double);
+    return [snapshot, name, vb] () { snapshot->WriteLegacy (name, vb, nullptr); };
+  }
+
   NumProcVTKOutput::NumProcVTKOutput (shared_ptr<PDE> apde, const Flags & flags)
     : NumProc (apde)
   {
@@ -31,7 +31,13 @@ namespace ngcomp
   public:
     virtual ~BaseVTKOutput() { ; }
     virtual void Do (LocalHeap & lh, VorB vb = VOL, const BitArray * drawelems = 0) = 0;
+    /// evaluate now, return the file writing (plain I/O, no TaskManager or timers)
+    /// and the size of the evaluated data it holds
+    virtual function<void()> Prepare (LocalHeap & lh, VorB vb, size_t & bytes) = 0;
   };
+
+  struct VTUBlock;
+  class VTUWriter;
   
   template <int D> 
   class VTKOutput : public BaseVTKOutput
@@ -44,6 +50,10 @@ namespace ngcomp
     string filename;
     int subdivision;
     int only_element = -1;
+    /// legacy ASCII .vtk, or XML .vtu with appended binary data
+    bool legacy = true;
+    /// zlib compression of the .vtu data
+    bool compress = false;
 
     Array<shared_ptr<ValueField>> value_field;
     Array<Vec<D>> points;
@@ -59,7 +69,7 @@ namespace ngcomp
                const Flags &,shared_ptr<MeshAccess>);
 
     VTKOutput (shared_ptr<MeshAccess>, const Array<shared_ptr<CoefficientFunction>> &,
-               const Array<string> &, string, int, int);
+               const Array<string> &, string, int, int, bool alegacy = true, bool acompress = false);
     virtual ~VTKOutput() { ; }
     
     void ResetArrays();
@@ -76,6 +86,17 @@ namespace ngcomp
     void PrintFieldData();    
 
     virtual void Do (LocalHeap & lh, VorB vb = VOL, const BitArray * drawelems = 0);
+    virtual function<void()> Prepare (LocalHeap & lh, VorB vb, size_t & bytes);
+    /// streaming .vtu output, one piece per rank and a .pvtu index under MPI
+    void DoVTU (LocalHeap & lh, VorB vb, const BitArray * drawelems);
+
+  protected:
+    string StartLegacy ();
+    void EvaluateLegacy (LocalHeap & lh, VorB vb, const BitArray * drawelems);
+    void WriteLegacy (string name, VorB vb, const BitArray * drawelems);
+    shared_ptr<VTUWriter> StartVTU ();
+    void EvaluateVTU (LocalHeap & lh, VorB vb, const BitArray * drawelems,
+                      const function<void(VTUBlock&)> & sink);
   };
 
 
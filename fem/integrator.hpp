@@ -57,6 +57,8 @@ namespace ngfem
     shared_ptr<BitArray> definedon_element = nullptr;
     std::array<unique_ptr<IntegrationRule>,25> userdefined_intrules;
     std::array<unique_ptr<SIMD_IntegrationRule>,25> userdefined_simd_intrules;
+    /// kind of registered named rule, -1 if none
+    int userdefined_intrule_kind = -1;
 
     mutable bool simd_evaluate = true;
 
@@ -125,13 +127,29 @@ namespace ngfem
         }
     }
 
+    /// use rules registered under this name (see RegisterIntegrationRule)
+    void SetIntegrationRule(const string & name)
+    {
+      userdefined_intrule_kind = GetIntegrationRuleKind(name);
+      if (userdefined_intrule_kind < 0)
+        throw Exception("no integration rule registered as '" + name + "'");
+    }
+
     inline const IntegrationRule& GetIntegrationRule(ELEMENT_TYPE et, int order) const
     {
-      return userdefined_intrules[et] ? *userdefined_intrules[et] : SelectIntegrationRule(et,order);
+      if (userdefined_intrules[et]) return *userdefined_intrules[et];
+      if (userdefined_intrule_kind >= 0)
+        if (auto ir = GetRegisteredIntegrationRule(userdefined_intrule_kind, et, order))
+          return *ir;
+      return SelectIntegrationRule(et,order);
     }
     inline const SIMD_IntegrationRule& GetSIMDIntegrationRule(ELEMENT_TYPE et, int order) const
     {
-      return userdefined_simd_intrules[et] ? *userdefined_simd_intrules[et] : SIMD_SelectIntegrationRule(et,order);
+      if (userdefined_simd_intrules[et]) return *userdefined_simd_intrules[et];
+      if (userdefined_intrule_kind >= 0)
+        if (auto ir = SIMD_GetRegisteredIntegrationRule(userdefined_intrule_kind, et, order))
+          return *ir;
+      return SIMD_SelectIntegrationRule(et,order);
     }
 
     /// defined only on some elements/facets/boundary elements
@@ -436,10 +454,15 @@ namespace ngfem
 				 LocalHeap & lh) const;
 
 
+    /// element-wise data for ApplyElementMatrix, e.g. mapped shapes on static meshes
     virtual void *  
     PrecomputeData (const FiniteElement & fel, 
 		    const ElementTransformation & eltrans, 
+                    bool single_precision,
 		    LocalHeap & lh) const { return 0; }
+    /// memory used by precomputed data in bytes
+    virtual size_t PrecomputedDataSize (void * precomputed) const { return 0; }
+    virtual void DeletePrecomputedData (void * precomputed) const { ; }
   
 
     virtual void 
@@ -755,6 +778,30 @@ namespace ngfem
       throw Exception ("FacetBilinearFormIntegrator::ApplyFacetMatrix for inner facets not implemented!");
     }
 
+    /// one inner facet of a batch
+    struct FacetPair
+    {
+      const FiniteElement * fel1, * fel2;
+      const ElementTransformation * trafo1, * trafo2;
+      FlatArray<int> vnums1, vnums2;
+      FlatVector<double> elx, ely;
+    };
+
+    /**
+       Apply to a batch of inner facets of the same class: equal element
+       types, local facet numbers and facet orientations on both sides
+       (see SkeletonFacet), so all facets share the reference facet rules.
+    */
+    virtual void
+      ApplyFacetMatrixBatch (int LocalFacetNr1, int LocalFacetNr2,
+                             FlatArray<FacetPair> facets, LocalHeap & lh) const
+    {
+      for (auto & f : facets)
+        ApplyFacetMatrix (*f.fel1, LocalFacetNr1, *f.trafo1, f.vnums1,
+                          *f.fel2, LocalFacetNr2, *f.trafo2, f.vnums2,
+                          f.elx, f.ely, lh);
+    }
+
 
     virtual void
     CalcFacetMatrix (const FiniteElement & volumefel, int LocalFacetNr,
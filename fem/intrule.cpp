@@ -16,6 +16,7 @@ namespace ngfem
   static mutex intruletpfacet_mutex;
   static mutex genintrule_mutex;
   static mutex simd_genintrule_mutex[40];
+  static mutex namedintrule_mutex;
 
   ostream & operator<< (ostream & ost, const IntegrationPoint & ip)
   {
@@ -2281,6 +2282,90 @@ namespace ngfem
 
 
 
+  /**
+     Table of rules indexed by order.
+     The slots live in chunks of geometrically growing size, which are
+     never moved, so lookup needs no lock. Set must be called with the
+     generating mutex held, the rule is published by a release-store.
+  */
+  template <typename T>
+  class IntegrationRuleTable
+  {
+    static constexpr int nchunks = 24;
+    static constexpr size_t chunk0 = 32;
+    std::atomic<std::atomic<T*>*> chunks[nchunks];
+
+    static int Locate (size_t i, size_t & offset)
+    {
+      size_t j = i / chunk0 + 1;
+      int k = 0;
+      while (j >>= 1) k++;
+      offset = i - chunk0 * ((size_t(1) << k) - 1);
+      return k;
+    }
+  public:
+    IntegrationRuleTable ()
+    {
+      for (auto & c : chunks) c.store(nullptr, memory_order_relaxed);
+    }
+    ~IntegrationRuleTable ()
+    {
+      for (auto & c : chunks) delete [] c.load(memory_order_relaxed);
+    }
+
+    T * Get (int order) const
+    {
+      if (order < 0) return nullptr;
+      size_t offset;
+      int k = Locate (order, offset);
+      if (k >= nchunks) return nullptr;
+      auto chunk = chunks[k].load(memory_order_acquire);
+      if (!chunk) return nullptr;
+      return chunk[offset].load(memory_order_acquire);
+    }
+    T * operator[] (int order) const { return Get(order); }
+
+    void Set (int order, T * rule)
+    {
+      size_t offset;
+      int k = Locate (order, offset);
+      if (k >= nchunks)
+        throw Exception ("integration order " + ToString(order) + " too high");
+      auto chunk = chunks[k].load(memory_order_relaxed);
+      if (!chunk)
+        {
+          size_t size = chunk0 << k;
+          chunk = new std::atomic<T*>[size];
+          for (size_t i = 0; i < size; i++)
+            chunk[i].store(nullptr, memory_order_relaxed);
+          chunks[k].store(chunk, memory_order_release);
+        }
+      chunk[offset].store(rule, memory_order_release);
+    }
+
+    /// number of slots in allocated chunks
+    size_t Size () const
+    {
+      size_t size = 0;
+      for (int k = 0; k < nchunks && chunks[k].load(memory_order_acquire); k++)
+        size += chunk0 << k;
+      return size;
+    }
+  };
+
+  /**
+     Rules registered under a name by the user.
+     Index 0 holds rules valid for any order, index order+1 rules for 
+     a specific order.
+  */
+  struct NamedIntegrationRules
+  {
+    string name;
+    IntegrationRuleTable<IntegrationRule> rules[25];
+    IntegrationRuleTable<SIMD_IntegrationRule> simd_rules[25];
+  };
+
+  
   /** 
       Integration Rules.
       A global class maintaining integration rules. If a rule of specific
@@ -2290,25 +2375,28 @@ namespace ngfem
   {
   public:
     IntegrationRule pointrule;  // 0-dim IR
-    Array<IntegrationRule*> segmentrules, segmentrules_inv;
-    Array<IntegrationRule*> trigrules;
-    Array<IntegrationRule*> quadrules;
-    Array<IntegrationRule*> tetrules;
-    Array<IntegrationRule*> prismrules;
-    Array<IntegrationRule*> pyramidrules;
-    Array<IntegrationRule*> hexrules;
+    IntegrationRuleTable<IntegrationRule> segmentrules, segmentrules_inv;
+    IntegrationRuleTable<IntegrationRule> trigrules;
+    IntegrationRuleTable<IntegrationRule> quadrules;
+    IntegrationRuleTable<IntegrationRule> tetrules;
+    IntegrationRuleTable<IntegrationRule> prismrules;
+    IntegrationRuleTable<IntegrationRule> pyramidrules;
+    IntegrationRuleTable<IntegrationRule> hexrules;
 
     SIMD_IntegrationRule simd_pointrule;
-    Array<SIMD_IntegrationRule*> simd_segmentrules, simd_segmentrules_inv;
-    Array<SIMD_IntegrationRule*> simd_trigrules;
-    Array<SIMD_IntegrationRule*> simd_quadrules;
-    Array<SIMD_IntegrationRule*> simd_tetrules;
-    Array<SIMD_IntegrationRule*> simd_prismrules;
-    Array<SIMD_IntegrationRule*> simd_pyramidrules;
-    Array<SIMD_IntegrationRule*> simd_hexrules;
+    IntegrationRuleTable<SIMD_IntegrationRule> simd_segmentrules, simd_segmentrules_inv;
+    IntegrationRuleTable<SIMD_IntegrationRule> simd_trigrules;
+    IntegrationRuleTable<SIMD_IntegrationRule> simd_quadrules;
+    IntegrationRuleTable<SIMD_IntegrationRule> simd_tetrules;
+    IntegrationRuleTable<SIMD_IntegrationRule> simd_prismrules;
+    IntegrationRuleTable<SIMD_IntegrationRule> simd_pyramidrules;
+    IntegrationRuleTable<SIMD_IntegrationRule> simd_hexrules;
     
-    Array<IntegrationRule*> jacobirules10;
-    Array<IntegrationRule*> jacobirules20;
+    IntegrationRuleTable<IntegrationRule> jacobirules10;
+    IntegrationRuleTable<IntegrationRule> jacobirules20;
+
+    IntegrationRuleTable<NamedIntegrationRules> namedrules;
+    atomic<int> nnamedrules{0};
 
   public:
     static IntegrationRule intrule0, intrule1;
@@ -2329,6 +2417,15 @@ namespace ngfem
     const IntegrationRule & GenerateIntegrationRule (ELEMENT_TYPE eltyp, int order);
     const IntegrationRule & GenerateIntegrationRuleJacobi10 (int order);
     const IntegrationRule & GenerateIntegrationRuleJacobi20 (int order);
+
+    /// kind-number of named rules, -1 if unknown
+    int GetIntegrationRuleKind (const string & name) const;
+    void RegisterIntegrationRule (const string & name, ELEMENT_TYPE eltyp, int order,
+                                  const IntegrationRule & ir);
+    const IntegrationRule * GetRegisteredIntegrationRule (int kind, ELEMENT_TYPE eltyp, int order) const;
+    const SIMD_IntegrationRule * SIMD_GetRegisteredIntegrationRule (int kind, ELEMENT_TYPE eltyp, int order) const;
+    /// Gauss-Lobatto tensor product rules, registered as kind 0
+    void GenerateGaussLobattoRule (ELEMENT_TYPE eltyp, int order);
   };
 
   IntegrationRule IntegrationRules :: intrule0;
@@ -2373,9 +2470,6 @@ namespace ngfem
     // ** Triangle integration rules
     // ************************************
 
-
-    trigrules.SetSize (7);
-
     static double qf_trig_order1_points[][3] = 
       {
 	{ 1.0/3.0, 1.0/3.0 },
@@ -2386,8 +2480,8 @@ namespace ngfem
 	0.5
       } ;
 
-    trigrules[0] = new IntegrationRule (1, qf_trig_order1_points, qf_trig_order1_weights);
-    trigrules[1] = new IntegrationRule (1, qf_trig_order1_points, qf_trig_order1_weights);
+    trigrules.Set (0, new IntegrationRule (1, qf_trig_order1_points, qf_trig_order1_weights));
+    trigrules.Set (1, new IntegrationRule (1, qf_trig_order1_points, qf_trig_order1_weights));
 
 
     static double qf_trig_order2_points[][3] = 
@@ -2402,7 +2496,7 @@ namespace ngfem
 	1.0/6.0, 1.0/6.0 , 1.0/6.0
       };
 
-    trigrules[2] = new IntegrationRule (3, qf_trig_order2_points, qf_trig_order2_weights);
+    trigrules.Set (2, new IntegrationRule (3, qf_trig_order2_points, qf_trig_order2_weights));
 
 
 
@@ -2423,8 +2517,8 @@ namespace ngfem
 	0.111690794839005, 0.111690794839005, 0.111690794839005
       };
 
-    trigrules[3] = new IntegrationRule (6, qf_trig_order4_points, qf_trig_order4_weights);
-    trigrules[4] = new IntegrationRule (6, qf_trig_order4_points, qf_trig_order4_weights);
+    trigrules.Set (3, new IntegrationRule (6, qf_trig_order4_points, qf_trig_order4_weights));
+    trigrules.Set (4, new IntegrationRule (6, qf_trig_order4_points, qf_trig_order4_weights));
 
 
 
@@ -2454,8 +2548,8 @@ namespace ngfem
 	0.041425537809187, 0.041425537809187, 0.041425537809187 
       };
 
-    trigrules[5] = new IntegrationRule (12, qf_trig_order6_points, qf_trig_order6_weights);
-    trigrules[6] = new IntegrationRule (12, qf_trig_order6_points, qf_trig_order6_weights);
+    trigrules.Set (5, new IntegrationRule (12, qf_trig_order6_points, qf_trig_order6_weights));
+    trigrules.Set (6, new IntegrationRule (12, qf_trig_order6_points, qf_trig_order6_weights));
 
 
     for (int p = 7; p <= 10; p++)
@@ -2492,8 +2586,8 @@ namespace ngfem
 	1.0/6.0
       };
 
-    tetrules[0] = new IntegrationRule (1, qf_tetra_order1_points, qf_tetra_order1_weights);
-    tetrules[1] = new IntegrationRule (1, qf_tetra_order1_points, qf_tetra_order1_weights);    
+    tetrules.Set (0, new IntegrationRule (1, qf_tetra_order1_points, qf_tetra_order1_weights));
+    tetrules.Set (1, new IntegrationRule (1, qf_tetra_order1_points, qf_tetra_order1_weights));    
 
     static double qf_tetra_order2_points[][3] = 
       {
@@ -2506,7 +2600,7 @@ namespace ngfem
     static double qf_tetra_order2_weights[] = 
       { 1.0/24.0, 1.0/24.0, 1.0/24.0, 1.0/24.0 };
 
-    tetrules[2] = new IntegrationRule (4, qf_tetra_order2_points, qf_tetra_order2_weights);    
+    tetrules.Set (2, new IntegrationRule (4, qf_tetra_order2_points, qf_tetra_order2_weights));    
 
 
 
@@ -2537,9 +2631,9 @@ namespace ngfem
 	0.012248840519394, 0.012248840519394, 0.012248840519394, 0.012248840519394
       };
     
-    tetrules[3] = new IntegrationRule (14, qf_tetra_order5_points, qf_tetra_order5_weights);    
-    tetrules[4] = new IntegrationRule (14, qf_tetra_order5_points, qf_tetra_order5_weights);    
-    tetrules[5] = new IntegrationRule (14, qf_tetra_order5_points, qf_tetra_order5_weights);    
+    tetrules.Set (3, new IntegrationRule (14, qf_tetra_order5_points, qf_tetra_order5_weights));    
+    tetrules.Set (4, new IntegrationRule (14, qf_tetra_order5_points, qf_tetra_order5_weights));    
+    tetrules.Set (5, new IntegrationRule (14, qf_tetra_order5_points, qf_tetra_order5_weights));    
 
 
     for (int p = 6; p <= 10; p++)
@@ -2651,6 +2745,11 @@ namespace ngfem
 	GenerateIntegrationRuleJacobi10 (i);
 	GenerateIntegrationRuleJacobi20 (i);
       }
+
+    auto gl = new NamedIntegrationRules;
+    gl->name = "gausslobatto";
+    namedrules.Set (0, gl);
+    nnamedrules = 1;
   }
 
 
@@ -2658,32 +2757,35 @@ namespace ngfem
 
   IntegrationRules :: ~IntegrationRules ()
   {
-    for (int i = 0; i < segmentrules.Size(); i++)
+    for (size_t i = 0; i < segmentrules.Size(); i++)
       delete segmentrules[i];
 
-    for (int i = 0; i < trigrules.Size(); i++)
+    for (size_t i = 0; i < trigrules.Size(); i++)
       delete trigrules[i];
 
-    for (int i = 0; i < quadrules.Size(); i++)
+    for (size_t i = 0; i < quadrules.Size(); i++)
       delete quadrules[i];
 
-    for (int i = 0; i < tetrules.Size(); i++)
+    for (size_t i = 0; i < tetrules.Size(); i++)
       delete tetrules[i];
 
-    for (int i = 0; i < prismrules.Size(); i++)
+    for (size_t i = 0; i < prismrules.Size(); i++)
       delete prismrules[i];
 
-    for (int i = 0; i < pyramidrules.Size(); i++)
+    for (size_t i = 0; i < pyramidrules.Size(); i++)
       delete pyramidrules[i];
 
-    for (int i = 0; i < hexrules.Size(); i++)
+    for (size_t i = 0; i < hexrules.Size(); i++)
       delete hexrules[i];
 
-    for (int i = 0; i < jacobirules10.Size(); i++)
+    for (size_t i = 0; i < jacobirules10.Size(); i++)
       delete jacobirules10[i];
 
-    for (int i = 0; i < jacobirules20.Size(); i++)
+    for (size_t i = 0; i < jacobirules20.Size(); i++)
       delete jacobirules20[i];
+
+    for (size_t i = 0; i < namedrules.Size(); i++)
+      delete namedrules[i];
    
   }
 
@@ -2692,7 +2794,7 @@ namespace ngfem
   const IntegrationRule & IntegrationRules :: 
   SelectIntegrationRule (ELEMENT_TYPE eltyp, int order) const
   {
-    const Array<IntegrationRule*> * ira;
+    const IntegrationRuleTable<IntegrationRule> * ira;
 
     switch (eltyp)
       {
@@ -2723,49 +2825,43 @@ namespace ngfem
     if (order < 0) 
       { order = 0; }
 
-    if (order >= ira->Size() || (*ira)[order] == 0)
-      {
-        return const_cast<IntegrationRules&> (*this).
-	  GenerateIntegrationRule (eltyp, order);
-      }
+    if (auto rule = ira->Get(order))
+      return *rule;
 
-    return *((*ira)[order]);
+    return const_cast<IntegrationRules&> (*this).
+      GenerateIntegrationRule (eltyp, order);
   }
  
 
   const IntegrationRule & IntegrationRules :: SelectIntegrationRuleJacobi10 (int order) const
   {
-    const Array<IntegrationRule*> * ira;
+    const IntegrationRuleTable<IntegrationRule> * ira;
   
     ira = &jacobirules10; 
 
     if (order < 0) { order = 0; }
 
-    if (order >= ira->Size() || (*ira)[order] == 0)
-      {
-	return const_cast<IntegrationRules&> (*this).
-	  GenerateIntegrationRuleJacobi10 (order);
-      }
+    if (auto rule = ira->Get(order))
+      return *rule;
 
-    return *((*ira)[order]);
+    return const_cast<IntegrationRules&> (*this).
+      GenerateIntegrationRuleJacobi10 (order);
   }
  
 
   const IntegrationRule & IntegrationRules :: SelectIntegrationRuleJacobi20 (int order) const
   {
-    const Array<IntegrationRule*> * ira;
+    const IntegrationRuleTable<IntegrationRule> * ira;
   
     ira = &jacobirules20; 
 
     if (order < 0) { order = 0; }
 
-    if (order >= ira->Size() || (*ira)[order] == 0)
-      {
-	return const_cast<IntegrationRules&> (*this).
-	  GenerateIntegrationRuleJacobi20 (order);
-      }
+    if (auto rule = ira->Get(order))
+      return *rule;
 
-    return *((*ira)[order]);
+    return const_cast<IntegrationRules&> (*this).
+      GenerateIntegrationRuleJacobi20 (order);
   }
  
 
@@ -2777,7 +2873,7 @@ namespace ngfem
   const IntegrationRule & IntegrationRules :: 
   GenerateIntegrationRule (ELEMENT_TYPE eltyp, int order)
   {
-    Array<IntegrationRule*> * ira;
+    IntegrationRuleTable<IntegrationRule> * ira;
 
     if (eltyp == ET_QUAD || eltyp == ET_TRIG)
       {
@@ -2823,14 +2919,6 @@ namespace ngfem
 			   ToString(int(eltyp)) + "\n"); 
 	}
 
-      if (ira -> Size() < order+1)
-	{
-	  int oldsize = ira -> Size();
-	  ira -> SetAllocSize (order+1);
-	  for (int i = oldsize; i < order+1; i++)
-	    ira -> Append(nullptr);
-	}
-
       if ( (*ira)[order] == 0)
 	{
 	  switch (eltyp)
@@ -2851,14 +2939,11 @@ namespace ngfem
 		      // ip.SetGlobNr (segmentpoints.Append (ip)-1);
 		    rule->AddIntegrationPoint (ip);
 		  }
-		segmentrules[order] = rule;
-                
                 IntegrationRule * rule_inv = new IntegrationRule;
                 for (int j = rule->Size()-1; j >= 0; j--)
                   rule_inv->AddIntegrationPoint ((*rule)[j]);
-                if (segmentrules_inv.Size() < order+1)
-                  segmentrules_inv.SetSize(order+1);
-                segmentrules_inv[order] = rule_inv;
+                segmentrules_inv.Set (order, rule_inv);
+		segmentrules.Set (order, rule);
 		break;
 	      }
 
@@ -2883,7 +2968,7 @@ namespace ngfem
 			// ip.SetGlobNr (trigpoints.Append (ip)-1);
 		      trigrule->AddIntegrationPoint (ip);
 		    }
-		trigrules[order] = trigrule;
+		trigrules.Set (order, trigrule);
 		break;
 	      }
 
@@ -2912,7 +2997,7 @@ namespace ngfem
 			// ip.SetGlobNr (quadpoints.Append (ip)-1);
 		      quadrule->AddIntegrationPoint (ip);
 		    }
-		quadrules[order] = quadrule;
+		quadrules.Set (order, quadrule);
 		break;
 	      }
   
@@ -2949,7 +3034,7 @@ namespace ngfem
 			  // ip.SetGlobNr (tetpoints.Append (ip)-1);
 			tetrule->AddIntegrationPoint (ip);
 		      }
-		tetrules[order] = tetrule;
+		tetrules.Set (order, tetrule);
 		break;
 	      }
 
@@ -2981,7 +3066,7 @@ namespace ngfem
 			ip.SetNr (ii); ii++;
 			hexrule->AddIntegrationPoint (ip);
 		      }
-		hexrules[order] = hexrule;
+		hexrules.Set (order, hexrule);
 		break;
 	      }
 
@@ -3011,7 +3096,7 @@ namespace ngfem
 		      ip.SetNr (ii); ii++;
 		      prismrule->AddIntegrationPoint (ip);
 		    }
-		prismrules[order] = prismrule;
+		prismrules.Set (order, prismrule);
 		break;
 	      }
 
@@ -3040,7 +3125,7 @@ namespace ngfem
 		      ip.SetNr (ii); ii++;
 		      pyramidrule->AddIntegrationPoint (ip);
 		    }
-		pyramidrules[order] = pyramidrule;
+		pyramidrules.Set (order, pyramidrule);
 		break;
 	      }
 	    }
@@ -3066,19 +3151,11 @@ namespace ngfem
 
   const IntegrationRule & IntegrationRules :: GenerateIntegrationRuleJacobi10 (int order)
   {
-    Array<IntegrationRule*> * ira;
+    IntegrationRuleTable<IntegrationRule> * ira;
     ira = &jacobirules10; 
 
     {
       lock_guard<mutex> guard(genintrule_mutex);
-      if (ira -> Size() < order+1)
-	{
-	  int oldsize = ira -> Size();
-	  ira -> SetSize (order+1);
-	  for (int i = oldsize; i < order+1; i++)
-	    (*ira)[i] = 0;
-	}
-
       if ( (*ira)[order] == 0)
 	{
 	  Array<double> xi, wi;
@@ -3095,7 +3172,7 @@ namespace ngfem
 		// ip.SetGlobNr (segmentpoints.Append (ip)-1);
 	      rule->AddIntegrationPoint (ip);
 	    }
-	  jacobirules10[order] = rule;	      
+	  jacobirules10.Set (order, rule);
 	}
 
       if ( (*ira)[order] == 0)
@@ -3116,19 +3193,11 @@ namespace ngfem
 
   const IntegrationRule & IntegrationRules :: GenerateIntegrationRuleJacobi20 (int order)
   {
-    Array<IntegrationRule*> * ira;
+    IntegrationRuleTable<IntegrationRule> * ira;
     ira = &jacobirules20; 
 
     {
       lock_guard<mutex> guard(genintrule_mutex);
-      if (ira -> Size() < order+1)
-	{
-	  int oldsize = ira -> Size();
-	  ira -> SetSize (order+1);
-	  for (int i = oldsize; i < order+1; i++)
-	    (*ira)[i] = 0;
-	}
-
       if ( (*ira)[order] == 0)
 	{
 	  Array<double> xi, wi;
@@ -3142,7 +3211,7 @@ namespace ngfem
 	      ip.SetNr (j);
 	      rule->AddIntegrationPoint (ip);
 	    }
-	  jacobirules20[order] = rule;	      
+	  jacobirules20.Set (order, rule);
 	}
 
       if ( (*ira)[order] == 0)
@@ -3159,7 +3228,7 @@ namespace ngfem
 
   const SIMD_IntegrationRule & IntegrationRules :: SIMD_SelectIntegrationRule (ELEMENT_TYPE eltype, int order)
   {
-    Array<SIMD_IntegrationRule*> * ira;
+    IntegrationRuleTable<SIMD_IntegrationRule> * ira;
 
     switch (eltype)
       {
@@ -3190,18 +3259,12 @@ namespace ngfem
     if (order < 0) 
       { order = 0; }
 
-    if (order >= ira->Size() || (*ira)[order] == 0)
+    if (auto rule = ira->Get(order))
+      return *rule;
+
       {
         lock_guard<mutex> guard(simd_genintrule_mutex[eltype]);
 
-        if (order >= ira->Size())
-          {
-            int oldsize = ira->Size();
-            ira -> SetAllocSize(order+2);
-            for (int i = oldsize; i < order+2; i++)
-                ira -> Append(nullptr);
-          }
-
         if ( (*ira)[order] == nullptr)
           {
             IntegrationRule ir(eltype, order);
@@ -3210,13 +3273,12 @@ namespace ngfem
               {
               case ET_SEGM:
                 {
-                  if (simd_segmentrules_inv.Size() < order+2)
-                    simd_segmentrules_inv.SetSize(order+2);
-                  simd_segmentrules_inv[order] = new SIMD_IntegrationRule(*segmentrules_inv[order]);
+                  auto rule_inv = new SIMD_IntegrationRule(*segmentrules_inv[order]);
+                  simd_segmentrules_inv.Set (order, rule_inv);
                   if (order % 2 == 0)
-                    simd_segmentrules_inv[order+1] = simd_segmentrules_inv[order];
+                    simd_segmentrules_inv.Set (order+1, rule_inv);
                   else
-                    simd_segmentrules_inv[order-1] = simd_segmentrules_inv[order];
+                    simd_segmentrules_inv.Set (order-1, rule_inv);
                   break;
                 }
               case ET_QUAD:
@@ -3262,13 +3324,148 @@ namespace ngfem
               default:
                 ;
               }
-            (*ira)[order] = tmp;
+            ira->Set (order, tmp);
           }
       }
 
     return *((*ira)[order]);
   }
 
+
+  int IntegrationRules :: GetIntegrationRuleKind (const string & name) const
+  {
+    for (int i = 0; i < nnamedrules; i++)
+      if (namedrules[i]->name == name)
+        return i;
+    return -1;
+  }
+
+  void IntegrationRules :: 
+  RegisterIntegrationRule (const string & name, ELEMENT_TYPE eltyp, int order,
+                           const IntegrationRule & ir)
+  {
+    lock_guard<mutex> guard(namedintrule_mutex);
+
+    int kind = GetIntegrationRuleKind (name);
+    if (kind == 0)
+      throw Exception ("cannot overwrite built-in integration rule '" + name + "'");
+    if (kind < 0)
+      {
+        auto named = new NamedIntegrationRules;
+        named->name = name;
+        kind = nnamedrules;
+        namedrules.Set (kind, named);
+        nnamedrules = kind+1;
+      }
+
+    // a replaced rule may still be in use by other threads, so we keep it alive
+    auto & named = *namedrules[kind];
+    int index = (order < 0) ? 0 : order+1;
+    auto rule = new IntegrationRule (ir.Copy());
+    named.simd_rules[eltyp].Set (index, new SIMD_IntegrationRule (*rule));
+    named.rules[eltyp].Set (index, rule);
+  }
+
+  const IntegrationRule * IntegrationRules :: 
+  GetRegisteredIntegrationRule (int kind, ELEMENT_TYPE eltyp, int order) const
+  {
+    auto named = namedrules[kind];
+    if (!named) return nullptr;
+    if (order < 0) order = 0;
+
+    if (auto rule = named->rules[eltyp].Get(order+1))
+      return rule;
+    if (kind == 0)
+      {
+        if (eltyp == ET_POINT) return &pointrule;
+        // tensor product elements only, the others use the default rules
+        if (eltyp != ET_SEGM && eltyp != ET_QUAD && eltyp != ET_HEX) return nullptr;
+        lock_guard<mutex> guard(namedintrule_mutex);
+        const_cast<IntegrationRules&> (*this).GenerateGaussLobattoRule (eltyp, order);
+        return named->rules[eltyp].Get(order+1);
+      }
+    return named->rules[eltyp].Get(0);
+  }
+
+  const SIMD_IntegrationRule * IntegrationRules :: 
+  SIMD_GetRegisteredIntegrationRule (int kind, ELEMENT_TYPE eltyp, int order) const
+  {
+    auto named = namedrules[kind];
+    if (!named) return nullptr;
+    if (order < 0) order = 0;
+
+    if (auto rule = named->simd_rules[eltyp].Get(order+1))
+      return rule;
+    if (kind == 0)
+      {
+        if (eltyp == ET_POINT) return &simd_pointrule;
+        // tensor product elements only, the others use the default rules
+        if (eltyp != ET_SEGM && eltyp != ET_QUAD && eltyp != ET_HEX) return nullptr;
+        lock_guard<mutex> guard(namedintrule_mutex);
+        const_cast<IntegrationRules&> (*this).GenerateGaussLobattoRule (eltyp, order);
+        return named->simd_rules[eltyp].Get(order+1);
+      }
+    return named->simd_rules[eltyp].Get(0);
+  }
+
+  // called with namedintrule_mutex locked
+  void IntegrationRules :: GenerateGaussLobattoRule (ELEMENT_TYPE eltyp, int order)
+  {
+    auto & named = *namedrules[0];
+    if (named.rules[eltyp][order+1]) return;
+
+    // same number of points as the Gauss rule, exact up to order-1 only,
+    // but collocated with the nodes of spectral elements -> lumped mass
+    int n = max(2, order/2+1);
+    Array<double> xi, wi;
+    ComputeGaussLobattoRule (n, xi, wi);
+
+    IntegrationRule * rule = new IntegrationRule;
+    SIMD_IntegrationRule * simd_rule;
+    switch (eltyp)
+      {
+      case ET_SEGM:
+        {
+          for (int i = 0; i < n; i++)
+            {
+              IntegrationPoint ip (xi[i], 0, 0, wi[i]);
+              ip.SetNr (i);
+              rule->AddIntegrationPoint (ip);
+            }
+          simd_rule = new SIMD_IntegrationRule (*rule);
+          break;
+        }
+      case ET_QUAD:
+      case ET_HEX:
+        {
+          GenerateGaussLobattoRule (ET_SEGM, order);
+          bool hex = eltyp == ET_HEX;
+          int ii = 0;
+          for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+              for (int k = 0; k < (hex ? n : 1); k++)
+                {
+                  IntegrationPoint ip (xi[i], xi[j], hex ? xi[k] : 0,
+                                       wi[i]*wi[j]*(hex ? wi[k] : 1));
+                  ip.SetNr (ii); ii++;
+                  rule->AddIntegrationPoint (ip);
+                }
+          simd_rule = new SIMD_IntegrationRule (*rule);
+          auto simd_segm = named.simd_rules[ET_SEGM][order+1];
+          simd_rule->SetIRX (simd_segm);
+          simd_rule->SetIRY (simd_segm);
+          if (hex) simd_rule->SetIRZ (simd_segm);
+          break;
+        }
+      default:
+        delete rule;
+        throw Exception (string("no Gauss-Lobatto rules for element ") +
+                         ElementTopology::GetElementName(eltyp));
+      }
+    named.simd_rules[eltyp].Set (order+1, simd_rule);
+    named.rules[eltyp].Set (order+1, rule);
+  }
+
   SIMD_IntegrationRule::SIMD_IntegrationRule (const IntegrationRule & ir)
     : Array<SIMD<IntegrationPoint>> (0, nullptr)
   {
@@ -3515,6 +3712,27 @@ namespace ngfem
     return const_cast<IntegrationRules&>(GetIntegrationRules()).SIMD_SelectIntegrationRule (eltype, order);
   }
 
+  int GetIntegrationRuleKind (const string & name)
+  {
+    return GetIntegrationRules().GetIntegrationRuleKind (name);
+  }
+
+  void RegisterIntegrationRule (const string & name, ELEMENT_TYPE eltype, int order,
+                                const IntegrationRule & ir)
+  {
+    const_cast<IntegrationRules&>(GetIntegrationRules()).RegisterIntegrationRule (name, eltype, order, ir);
+  }
+
+  const IntegrationRule * GetRegisteredIntegrationRule (int kind, ELEMENT_TYPE eltype, int order)
+  {
+    return GetIntegrationRules().GetRegisteredIntegrationRule (kind, eltype, order);
+  }
+
+  const SIMD_IntegrationRule * SIMD_GetRegisteredIntegrationRule (int kind, ELEMENT_TYPE eltype, int order)
+  {
+    return GetIntegrationRules().SIMD_GetRegisteredIntegrationRule (kind, eltype, order);
+  }
+
 
 
 
@@ -854,6 +854,21 @@ namespace ngfem
   extern NGS_DLL_HEADER const IntegrationRule & SelectIntegrationRuleJacobi10 (int order);
   extern NGS_DLL_HEADER const IntegrationRule & SelectIntegrationRuleJacobi20 (int order);
 
+  /**
+     User-registered integration rules, e.g. reduced rules.
+     A rule registered with order < 0 is used for all orders.
+     The kind "gausslobatto" is built-in and provides tensor product
+     Gauss-Lobatto rules on segments, quads and hexes with order/2+1 points
+     per direction, which give a diagonal mass matrix for nodal elements.
+     Lookup is lock-free.
+  */
+  extern NGS_DLL_HEADER void RegisterIntegrationRule (const string & name, ELEMENT_TYPE eltype, int order,
+                                                      const IntegrationRule & ir);
+  /// kind number of named rule, -1 if not registered
+  extern NGS_DLL_HEADER int GetIntegrationRuleKind (const string & name);
+  /// nullptr if no rule for this element type and order
+  extern NGS_DLL_HEADER const IntegrationRule * GetRegisteredIntegrationRule (int kind, ELEMENT_TYPE eltype, int order);
+
   INLINE IntegrationRule :: IntegrationRule (ELEMENT_TYPE eltype, int order)
   { 
     const IntegrationRule & ir = SelectIntegrationRule (eltype, order);
@@ -2319,6 +2334,7 @@ namespace ngfem
   };
 
   extern NGS_DLL_HEADER const SIMD_IntegrationRule & SIMD_SelectIntegrationRule (ELEMENT_TYPE eltype, int order);
+  extern NGS_DLL_HEADER const SIMD_IntegrationRule * SIMD_GetRegisteredIntegrationRule (int kind, ELEMENT_TYPE eltype, int order);
 
   inline SIMD_IntegrationRule :: SIMD_IntegrationRule (ELEMENT_TYPE eltype, int order)
   { 
@@ -359,6 +359,12 @@ namespace ngfem
         size_t nipx = irx.GetNIP();
         size_t nipy = iry.GetNIP();
         size_t nipz = irz.GetNIP();
+        if (nipx == 1 || nipy == 1 || nipz == 1)
+          {
+            EvaluateTrace (ir, bcoefs, values);
+            return;
+          }
+        
         size_t nip = nipx*nipy*nipz;
         size_t ndof = (order+1)*(order+1)*(order+1);
         bool needs_copy = bcoefs.Dist() != 1;
@@ -456,6 +462,12 @@ namespace ngfem
         size_t nipx = irx.GetNIP();
         size_t nipy = iry.GetNIP();
         size_t nipz = irz.GetNIP();
+        if (nipx == 1 || nipy == 1 || nipz == 1)
+          {
+            AddTransTrace (ir, values, bcoefs);
+            return;
+          }
+        
         //size_t nip = nipx*nipy*nipz;
         size_t ndof = (order+1)*(order+1)*(order+1);
 
@@ -538,6 +550,172 @@ namespace ngfem
   }
 
 
+  /*
+    Coefficients are stored x-slowest, z-fastest. The fixed direction is
+    contracted first, leaving an (order+1)^2 coefficient matrix c2 for the
+    remaining directions dir1 < dir2, which is evaluated as a 2D tensor
+    product. Point values are stored as (nip1, nip2) matrix.
+   */
+  void L2HighOrderFETP<ET_HEX> ::
+  EvaluateTrace (const SIMD_IntegrationRule & ir,
+                 BareSliceVector<> bcoefs,
+                 BareVector<SIMD<double>> values) const
+  {
+    static Timer t("hex evaluate trace");
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+
+    const SIMD_IntegrationRule * irs[3] = { &ir.GetIRX(), &ir.GetIRY(), &ir.GetIRZ() };
+    int dirfix = (irs[0]->GetNIP() == 1) ? 0 : ( (irs[1]->GetNIP() == 1) ? 1 : 2 );
+    int dir1 = (dirfix == 0) ? 1 : 0;
+    int dir2 = (dirfix == 2) ? 1 : 2;
+    auto & ir1 = *irs[dir1];
+    auto & ir2 = *irs[dir2];
+    size_t nip1 = ir1.GetNIP();
+    size_t nip2 = ir2.GetNIP();
+    size_t n = order+1;
+    size_t ndof = n*n*n;
+
+    NgProfiler::AddThreadFlops (t, TaskManager::GetThreadId(), ndof + n*n*nip2 + n*nip1*nip2);
+    
+    bool needs_copy = bcoefs.Dist() != 1;
+    STACK_ARRAY(double, mem_coefs, needs_copy ? ndof : 0);
+    if (needs_copy)
+      {
+        FlatVector<> coefs(ndof, mem_coefs);
+        coefs = bcoefs;
+      }
+    double * pcoefs = needs_copy ? mem_coefs : &bcoefs(0);
+
+    STACK_ARRAY(double, mem_shapefix, n);
+    FlatVector<> shapefix(n, mem_shapefix);
+    LegendrePolynomial (order, (2*(*irs[dirfix])[0](0)[0]-1), shapefix);
+
+    STACK_ARRAY(double, mem_c2, n*n);
+    FlatMatrix<> c2(n, n, mem_c2);
+    FlatVector<> vec_c2(n*n, mem_c2);
+    switch (dirfix)
+      {
+      case 0:
+        {
+          FlatMatrix<> mat_coefs(n, n*n, pcoefs);
+          vec_c2 = Trans(mat_coefs) * shapefix;
+          break;
+        }
+      case 1:
+        {
+          for (size_t ix = 0; ix < n; ix++)
+            {
+              FlatMatrix<> mat_coefs(n, n, pcoefs+ix*n*n);
+              c2.Row(ix) = Trans(mat_coefs) * shapefix;
+            }
+          break;
+        }
+      case 2:
+        {
+          FlatMatrix<> mat_coefs(n*n, n, pcoefs);
+          vec_c2 = mat_coefs * shapefix;
+          break;
+        }
+      }
+    
+    STACK_ARRAY(SIMD<double>, mem_shape1, n*ir1.Size());
+    FlatMatrix<SIMD<double>> simd_shape1(n, ir1.Size(), mem_shape1);
+    SliceMatrix<double> shape1(n, nip1, SIMD<double>::Size()*ir1.Size(), &mem_shape1[0][0]);
+    for (size_t i = 0; i < ir1.Size(); i++)
+      LegendrePolynomial (order, (2*ir1[i](0)-1), simd_shape1.Col(i));
+
+    STACK_ARRAY(SIMD<double>, mem_shape2, n*ir2.Size());
+    FlatMatrix<SIMD<double>> simd_shape2(n, ir2.Size(), mem_shape2);
+    SliceMatrix<double> shape2(n, nip2, SIMD<double>::Size()*ir2.Size(), &mem_shape2[0][0]);
+    for (size_t i = 0; i < ir2.Size(); i++)
+      LegendrePolynomial (order, (2*ir2[i](0)-1), simd_shape2.Col(i));
+
+    STACK_ARRAY(double, mem_tmp, n*nip2);
+    FlatMatrix<> tmp(n, nip2, mem_tmp);
+    tmp = c2 * shape2;
+
+    values(ir.Size()-1) = 0.0; // clear overhead
+    FlatMatrix<> mat_values(nip1, nip2, &values(0)[0]);
+    mat_values = Trans(shape1) * tmp;
+  }
+
+  void L2HighOrderFETP<ET_HEX> ::
+  AddTransTrace (const SIMD_IntegrationRule & ir,
+                 BareVector<SIMD<double>> values,
+                 BareSliceVector<> bcoefs) const
+  {
+    static Timer t("hex AddTrans trace");
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+
+    const SIMD_IntegrationRule * irs[3] = { &ir.GetIRX(), &ir.GetIRY(), &ir.GetIRZ() };
+    int dirfix = (irs[0]->GetNIP() == 1) ? 0 : ( (irs[1]->GetNIP() == 1) ? 1 : 2 );
+    int dir1 = (dirfix == 0) ? 1 : 0;
+    int dir2 = (dirfix == 2) ? 1 : 2;
+    auto & ir1 = *irs[dir1];
+    auto & ir2 = *irs[dir2];
+    size_t nip1 = ir1.GetNIP();
+    size_t nip2 = ir2.GetNIP();
+    size_t n = order+1;
+    size_t ndof = n*n*n;
+
+    NgProfiler::AddThreadFlops (t, TaskManager::GetThreadId(), ndof + n*n*nip2 + n*nip1*nip2);
+
+    STACK_ARRAY(double, mem_shapefix, n);
+    FlatVector<> shapefix(n, mem_shapefix);
+    LegendrePolynomial (order, (2*(*irs[dirfix])[0](0)[0]-1), shapefix);
+
+    STACK_ARRAY(SIMD<double>, mem_shape1, n*ir1.Size());
+    FlatMatrix<SIMD<double>> simd_shape1(n, ir1.Size(), mem_shape1);
+    SliceMatrix<double> shape1(n, nip1, SIMD<double>::Size()*ir1.Size(), &mem_shape1[0][0]);
+    for (size_t i = 0; i < ir1.Size(); i++)
+      LegendrePolynomial (order, (2*ir1[i](0)-1), simd_shape1.Col(i));
+
+    STACK_ARRAY(SIMD<double>, mem_shape2, n*ir2.Size());
+    FlatMatrix<SIMD<double>> simd_shape2(n, ir2.Size(), mem_shape2);
+    SliceMatrix<double> shape2(n, nip2, SIMD<double>::Size()*ir2.Size(), &mem_shape2[0][0]);
+    for (size_t i = 0; i < ir2.Size(); i++)
+      LegendrePolynomial (order, (2*ir2[i](0)-1), simd_shape2.Col(i));
+
+    FlatMatrix<> mat_values(nip1, nip2, &values(0)[0]);
+    STACK_ARRAY(double, mem_tmp, n*nip2);
+    FlatMatrix<> tmp(n, nip2, mem_tmp);
+    tmp = shape1 * mat_values;
+
+    STACK_ARRAY(double, mem_c2, n*n);
+    FlatMatrix<> c2(n, n, mem_c2);
+    FlatVector<> vec_c2(n*n, mem_c2);
+    c2 = tmp * Trans(shape2);
+
+    STACK_ARRAY(double, mem_res, ndof);
+    FlatVector<> res(ndof, mem_res);
+    switch (dirfix)
+      {
+      case 0:
+        {
+          FlatMatrix<> mat_res(n, n*n, mem_res);
+          mat_res = shapefix * Trans(vec_c2);
+          break;
+        }
+      case 1:
+        {
+          for (size_t ix = 0; ix < n; ix++)
+            {
+              FlatMatrix<> mat_res(n, n, mem_res+ix*n*n);
+              mat_res = shapefix * Trans(c2.Row(ix));
+            }
+          break;
+        }
+      case 2:
+        {
+          FlatMatrix<> mat_res(n*n, n, mem_res);
+          mat_res = vec_c2 * Trans(shapefix);
+          break;
+        }
+      }
+    bcoefs.Range(0,ndof) += res;
+  }
+
+  
   void L2HighOrderFETP<ET_HEX> ::  
   AddGradTrans (const SIMD_BaseMappedIntegrationRule & mir,
                 BareSliceMatrix<SIMD<double>> values,
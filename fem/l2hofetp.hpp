@@ -1140,6 +1140,17 @@ namespace ngfem
     virtual void AddGradTrans (const SIMD_BaseMappedIntegrationRule & mir,
                                BareSliceMatrix<SIMD<double>> values,
                                BareSliceVector<> bcoefs) const override;
+
+  protected:
+    // tensor-product rules with one single-point direction (facet traces):
+    // contract the fixed direction first, O(p^3) instead of O(p^3 nip)
+    void EvaluateTrace (const SIMD_IntegrationRule & ir,
+                        BareSliceVector<> bcoefs,
+                        BareVector<SIMD<double>> values) const;
+
+    void AddTransTrace (const SIMD_IntegrationRule & ir,
+                        BareVector<SIMD<double>> values,
+                        BareSliceVector<> bcoefs) const;
   };
   
 
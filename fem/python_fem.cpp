@@ -1668,6 +1668,41 @@ weights : list
                            }, "Points of IntegrationRule as tuple")
     ;
 
+  m.def("RegisterIntegrationRule", [](string name, ELEMENT_TYPE et, IntegrationRule & ir, int order)
+        {
+          RegisterIntegrationRule (name, et, order, ir);
+        }, py::arg("name"), py::arg("et"), py::arg("intrule"), py::arg("order")=-1,
+        docu_string(R"raw_string(
+Register an integration rule under a name. Integrators use it after
+SetIntegrationRule(name).
+
+Parameters:
+
+name : str
+  name of the rule, "gausslobatto" is built-in
+
+et : ngsolve.fem.ET
+  element type
+
+intrule : ngsolve.fem.IntegrationRule
+  integration rule
+
+order : int
+  integration order the rule is used for, negative for all orders
+
+)raw_string"));
+
+  m.def("GetIntegrationRule", [](string name, ELEMENT_TYPE et, int order)
+        {
+          int kind = GetIntegrationRuleKind (name);
+          auto ir = GetRegisteredIntegrationRule (kind, et, order);
+          if (!ir)
+            throw Exception("no integration rule '" + name + "' for element " +
+                            ElementTopology::GetElementName(et) + ", order " + ToString(order));
+          return ir->Copy();
+        }, py::arg("name"), py::arg("et"), py::arg("order"),
+        "Get a registered integration rule");
+
 
   py::class_<MeshPoint>(m, "MeshPoint")
     .def_property_readonly("pnt", [](MeshPoint& p) { return py::make_tuple(p.x,p.y,p.z); }, "Gives coordinates of point on reference triangle. One can create a MappedIntegrationPoint using the ngsolve.fem.BaseMappedIntegrationPoint constructor. For physical coordinates the coordinate CoefficientFunctions x,y,z can be evaluated in the MeshPoint")
@@ -1972,6 +2007,11 @@ intrule : ngsolve.fem.Integrationrule
   input integration rule
 
 )raw_string"))
+    .def("SetIntegrationRule", [] (shared_ptr<BFI> self, string name)
+         {
+           self -> SetIntegrationRule(name);
+           return self;
+         }, py::arg("name"), "Use integration rules registered under name, see RegisterIntegrationRule")
     .def("CalcElementMatrix",
          [] (shared_ptr<BFI> self,
              const FiniteElement & fe, const ElementTransformation &trafo,
@@ -2167,6 +2207,11 @@ ir : ngsolve.fem.IntegrationRule
   input integration rule
 
 )raw_string"))
+    .def("SetIntegrationRule", [](shared_ptr<LFI> self, string name)
+         {
+           self->SetIntegrationRule(name);
+           return self;
+         }, py::arg("name"), "Use integration rules registered under name, see RegisterIntegrationRule")
 
     .def("CalcElementVector", 
          static_cast<void(LinearFormIntegrator::*)(const FiniteElement&, const ElementTransformation&, FlatVector<double>, LocalHeap&)const>(&LinearFormIntegrator::CalcElementVector), py::arg("fel"), py::arg("trafo"), py::arg("vec"), py::arg("lh"))
@@ -2269,22 +2314,34 @@ alpha : double
   m.def("GenerateL2ElementCode", &GenerateL2ElementCode);
 
   m.def("VoxelCoefficient",
-        [](py::tuple pystart, py::tuple pyend, py::array values,
-           bool linear, py::object trafocf)
+        [](py::tuple pystart, py::tuple pyend, py::object pyvalues,
+           bool linear, py::object trafocf, py::object pyshape, bool iscomplex)
         -> shared_ptr<CoefficientFunction>
         {
           shared_ptr<CoefficientFunction> trafo;
           try { trafo = MakeCoefficient(trafocf); }
           catch(...) { trafo=nullptr; }
-          Array<string> allowed_types = { "float64", "complex128" };
-          if(!allowed_types.Contains(py::cast<string>(values.dtype().attr("name"))))
-            throw Exception("Only float64 and complex128 dtype arrays allowed!");
           Array<double> start, end;
-          Array<size_t> dim_vals;
           for(auto val : pystart)
             start.Append(py::cast<double>(val));
           for(auto val : pyend)
             end.Append(py::cast<double>(val));
+
+          if(py::isinstance<py::str>(pyvalues))
+            {
+              Array<size_t> shape;
+              if(!pyshape.is_none())
+                for(auto dim : py::cast<py::tuple>(pyshape))
+                  shape.Append(py::cast<size_t>(dim));
+              return MappedVoxelCoefficient(start, end, py::cast<string>(pyvalues),
+                                            move(shape), iscomplex, linear, trafo);
+            }
+
+          auto values = py::cast<py::array>(pyvalues);
+          Array<string> allowed_types = { "float64", "complex128" };
+          if(!allowed_types.Contains(py::cast<string>(values.dtype().attr("name"))))
+            throw Exception("Only float64 and complex128 dtype arrays allowed!");
+          Array<size_t> dim_vals;
           for(auto dim : Range(values.ndim()))
             dim_vals.Insert(0,values.shape(dim));
 
@@ -2304,13 +2361,17 @@ alpha : double
           return make_shared<VoxelCoefficientFunction<double>>
               (start, end, dim_vals, move(vals), linear, trafo);
         }, py::arg("start"), py::arg("end"), py::arg("values"),
-        py::arg("linear")=true, py::arg("trafocf")=DummyArgument(), R"delimiter(CoefficientFunction defined on a grid.
+        py::arg("linear")=true, py::arg("trafocf")=DummyArgument(),
+        py::arg("shape")=py::none(), py::arg("iscomplex")=false,
+        R"delimiter(CoefficientFunction defined on a grid.
 
 Start and end mark the cartesian boundary of domain. The function will be continued by a constant function outside of this box. Inside a cartesian grid will be created by the dimensions of the numpy input array 'values'. This array must have the dimensions of the mesh and the values stored as:
 x1y1z1, x2y1z1, ..., xNy1z1, x1y2z1, ...
 
 If linear is True the function will be interpolated linearly between the values. Otherwise the nearest voxel value is taken.
 
+If values is a filename, the voxel data is memory mapped instead of copied, and pages are loaded on demand. For a .npy file (C order, float64 or complex128) type and shape are read from the file header. Other files contain raw values, their shape (in numpy ordering) and type are given by 'shape' and 'iscomplex'.
+
 )delimiter");
 
 }
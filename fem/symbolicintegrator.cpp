@@ -1208,7 +1208,7 @@ namespace ngfem
     auto et = fel.ElementType();
     if (et == ET_TRIG || et == ET_TET)
       intorder -= test_difforder+trial_difforder;
-    return SelectIntegrationRule (et, intorder);
+    return GetIntegrationRule (et, intorder);
   }
 
   const SIMD_IntegrationRule& SymbolicBilinearFormIntegrator ::
@@ -1234,7 +1234,7 @@ namespace ngfem
     auto et = fel.ElementType();
     if (et == ET_TRIG || et == ET_TET)
       intorder -= test_difforder+trial_difforder;
-    return SIMD_SelectIntegrationRule (et, intorder);
+    return GetSIMDIntegrationRule (et, intorder);
   }
 
 
@@ -2648,6 +2648,185 @@ namespace ngfem
 
   
   
+  INLINE SIMD<double> LoadShape (const double * p) { return SIMD<double>(p); }
+  INLINE SIMD<double> LoadShape (const float * p)
+  {
+    return SIMD<double>([p] (int l) { return double(p[l]); });
+  }
+
+  /*
+    Mapped shapes of the trial- and test-proxies of one element, for
+    matrix-free application on static meshes. Each shape block is stored 
+    as (used-dofs * dim) x (simd-points), in double or single precision.
+    Proxies with the same evaluator share a block.
+   */
+  struct SymbolicBFIPrecomputed
+  {
+    bool single;
+    size_t nsimd;
+    Array<int> trial_shape, test_shape;    // shape block of proxy
+    Array<const DifferentialOperator*> evaluators;
+    Array<const FiniteElement*> fels;
+    Array<IntRange> ranges;
+    Array<int> dims;
+    Array<Array<double>> dshapes;
+    Array<Array<float>> fshapes;
+
+    template <typename T>
+    void T_Apply (FlatArray<T> shapes, IntRange r, int dim,
+                  FlatVector<double> elx, BareSliceMatrix<SIMD<double>> values) const
+    {
+      constexpr size_t W = SIMD<double>::Size();
+      for (int k = 0; k < dim; k++)
+        for (size_t i = 0; i < nsimd; i++)
+          values(k,i) = SIMD<double>(0.0);
+      for (size_t j = 0; j < r.Size(); j++)
+        {
+          SIMD<double> xj = elx(r.First()+j);
+          for (int k = 0; k < dim; k++)
+            {
+              const T * row = &shapes[(j*dim+k)*nsimd*W];
+              for (size_t i = 0; i < nsimd; i++)
+                values(k,i) += xj * LoadShape(row+i*W);
+            }
+        }
+    }
+
+    template <typename T>
+    void T_AddTrans (FlatArray<T> shapes, IntRange r, int dim,
+                     BareSliceMatrix<SIMD<double>> values, FlatVector<double> ely) const
+    {
+      constexpr size_t W = SIMD<double>::Size();
+      for (size_t j = 0; j < r.Size(); j++)
+        {
+          SIMD<double> sum(0.0);
+          for (int k = 0; k < dim; k++)
+            {
+              const T * row = &shapes[(j*dim+k)*nsimd*W];
+              for (size_t i = 0; i < nsimd; i++)
+                sum += LoadShape(row+i*W) * values(k,i);
+            }
+          ely(r.First()+j) += HSum(sum);
+        }
+    }
+
+    void Apply (int nr, FlatVector<double> elx, BareSliceMatrix<SIMD<double>> values) const
+    {
+      if (single)
+        T_Apply<float> (fshapes[nr], ranges[nr], dims[nr], elx, values);
+      else
+        T_Apply<double> (dshapes[nr], ranges[nr], dims[nr], elx, values);
+    }
+
+    void AddTrans (int nr, BareSliceMatrix<SIMD<double>> values, FlatVector<double> ely) const
+    {
+      if (single)
+        T_AddTrans<float> (fshapes[nr], ranges[nr], dims[nr], values, ely);
+      else
+        T_AddTrans<double> (dshapes[nr], ranges[nr], dims[nr], values, ely);
+    }
+    
+    size_t Bytes() const
+    {
+      size_t bytes = sizeof(*this);
+      for (auto & s : dshapes) bytes += s.Size()*sizeof(double);
+      for (auto & s : fshapes) bytes += s.Size()*sizeof(float);
+      return bytes;
+    }
+  };
+
+  
+  void * SymbolicBilinearFormIntegrator ::
+  PrecomputeData (const FiniteElement & fel,
+                  const ElementTransformation & trafo,
+                  bool single_precision,
+                  LocalHeap & lh) const
+  {
+    if (element_vb != VOL || !simd_evaluate) return nullptr;
+    
+    auto save_userdata = trafo.PushUserData();
+    HeapReset hr(lh);
+    
+    bool is_mixed = typeid(fel) == typeid(const MixedFiniteElement&);
+    const MixedFiniteElement * mixedfe = static_cast<const MixedFiniteElement*> (&fel);    
+    const FiniteElement & fel_trial = is_mixed ? mixedfe->FETrial() : fel;
+    const FiniteElement & fel_test = is_mixed ? mixedfe->FETest() : fel;
+
+    constexpr size_t W = SIMD<double>::Size();
+    auto pre = make_unique<SymbolicBFIPrecomputed>();
+    try
+      {
+        const SIMD_IntegrationRule& simd_ir = Get_SIMD_IntegrationRule (fel, lh);
+        auto & simd_mir = trafo(simd_ir, lh);
+        size_t nsimd = simd_ir.Size();
+        pre->single = single_precision;
+        pre->nsimd = nsimd;
+
+        auto add_shape = [&] (ProxyFunction * proxy, const FiniteElement & fe)
+          {
+            auto evaluator = proxy->Evaluator().get();
+            for (int i = 0; i < pre->evaluators.Size(); i++)
+              if (pre->evaluators[i] == evaluator && pre->fels[i] == &fe)
+                return i;
+
+            HeapReset hr(lh);
+            int dim = proxy->Dimension();
+            IntRange r = evaluator->UsedDofs(fe);
+            FlatMatrix<SIMD<double>> bmat(fe.GetNDof()*dim, nsimd, lh);
+            evaluator->CalcMatrix(fe, simd_mir, bmat);
+            auto rows = bmat.Rows(r.First()*dim, r.Next()*dim);
+
+            size_t size = rows.Height()*nsimd*W;
+            if (single_precision)
+              {
+                Array<float> shapes(size);
+                for (size_t ii = 0, cnt = 0; ii < rows.Height(); ii++)
+                  for (size_t i = 0; i < nsimd; i++)
+                    for (size_t l = 0; l < W; l++, cnt++)
+                      shapes[cnt] = rows(ii,i)[l];
+                pre->fshapes.Append (std::move(shapes));
+              }
+            else
+              {
+                Array<double> shapes(size);
+                for (size_t ii = 0, cnt = 0; ii < rows.Height(); ii++)
+                  for (size_t i = 0; i < nsimd; i++)
+                    for (size_t l = 0; l < W; l++, cnt++)
+                      shapes[cnt] = rows(ii,i)[l];
+                pre->dshapes.Append (std::move(shapes));
+              }
+            pre->evaluators.Append (evaluator);
+            pre->fels.Append (&fe);
+            pre->ranges.Append (r);
+            pre->dims.Append (dim);
+            return int(pre->evaluators.Size()-1);
+          };
+
+        for (auto proxy : trial_proxies)
+          pre->trial_shape.Append (add_shape(proxy, fel_trial));
+        for (auto proxy : test_proxies)
+          pre->test_shape.Append (add_shape(proxy, fel_test));
+      }
+    catch (ExceptionNOSIMD e)
+      {
+        return nullptr;
+      }
+    return pre.release();
+  }
+
+  size_t SymbolicBilinearFormIntegrator ::
+  PrecomputedDataSize (void * precomputed) const
+  {
+    return precomputed ? static_cast<SymbolicBFIPrecomputed*> (precomputed) -> Bytes() : 0;
+  }
+
+  void SymbolicBilinearFormIntegrator ::
+  DeletePrecomputedData (void * precomputed) const
+  {
+    delete static_cast<SymbolicBFIPrecomputed*> (precomputed);
+  }
+  
+
   void
   SymbolicBilinearFormIntegrator :: ApplyElementMatrix (const FiniteElement & fel, 
                                                         const ElementTransformation & trafo, 
@@ -2688,12 +2867,22 @@ namespace ngfem
           for (CoefficientFunction * cf : gridfunction_cfs)
             ud.AssignMemory (cf, simd_ir.GetNIP(), cf->Dimension(), lh);
           
-          for (ProxyFunction * proxy : trial_proxies)
-            proxy->Evaluator()->Apply(fel_trial, simd_mir, elx, ud.GetAMemory(proxy)); 
+          auto pre = static_cast<const SymbolicBFIPrecomputed*> (precomputed);
+          if (pre && pre->nsimd != simd_ir.Size()) pre = nullptr;
+          
+          for (size_t i = 0; i < trial_proxies.Size(); i++)
+            {
+              ProxyFunction * proxy = trial_proxies[i];
+              if (pre)
+                pre->Apply(pre->trial_shape[i], elx, ud.GetAMemory(proxy));
+              else
+                proxy->Evaluator()->Apply(fel_trial, simd_mir, elx, ud.GetAMemory(proxy));
+            }
           
           ely = 0;
-          for (auto proxy : test_proxies)
+          for (size_t l = 0; l < test_proxies.Size(); l++)
             {
+              ProxyFunction * proxy = test_proxies[l];
               HeapReset hr(lh);
 
               FlatMatrix<SIMD<double>> simd_proxyvalues(proxy->Dimension(), simd_ir.Size(), lh);
@@ -2711,7 +2900,10 @@ namespace ngfem
                     row(j) *= simd_mir[j].GetWeight(); //  * simd_ir[j].Weight();
                 }
               
-              proxy->Evaluator()->AddTrans(fel_test, simd_mir, simd_proxyvalues, ely); 
+              if (pre)
+                pre->AddTrans(pre->test_shape[l], simd_proxyvalues, ely);
+              else
+                proxy->Evaluator()->AddTrans(fel_test, simd_mir, simd_proxyvalues, ely); 
             }
           return;
         }
@@ -3422,6 +3614,81 @@ namespace ngfem
   
 
 
+  // inner facet apply with given reference facet rules on both elements
+  void SymbolicFacetBilinearFormIntegrator ::
+  ApplyInnerFacetSIMD (const FiniteElement & fel1, int LocalFacetNr1,
+                       const ElementTransformation & trafo1,
+                       const FiniteElement & fel2, int LocalFacetNr2,
+                       const ElementTransformation & trafo2,
+                       const SIMD_IntegrationRule & simd_ir_facet,
+                       const SIMD_IntegrationRule & simd_ir_facet_vol1,
+                       const SIMD_IntegrationRule & simd_ir_facet_vol2,
+                       FlatVector<double> elx, FlatVector<double> ely,
+                       LocalHeap & lh) const
+  {
+    HeapReset hr(lh);
+    ely = 0;
+    
+    auto & simd_mir1 = trafo1(simd_ir_facet_vol1, lh);
+    auto & simd_mir2 = trafo2(simd_ir_facet_vol2, lh);
+
+    simd_mir1.SetOtherMIR(&simd_mir2);
+    simd_mir2.SetOtherMIR(&simd_mir1);
+
+    simd_mir1.ComputeNormalsAndMeasure(trafo1.GetElementType(), LocalFacetNr1);
+    simd_mir2.ComputeNormalsAndMeasure(trafo2.GetElementType(), LocalFacetNr2);
+    
+    // evaluate proxy-values
+    ProxyUserData ud(trial_proxies.Size(), gridfunction_cfs.Size(), lh);
+    const_cast<ElementTransformation&>(trafo1).userdata = &ud;
+    ud.fel = &fel1;   // necessary to check remember-map
+    for (ProxyFunction * proxy : trial_proxies)
+      ud.AssignMemory (proxy, simd_ir_facet.GetNIP(), proxy->Dimension(), lh);
+    for (CoefficientFunction * cf : gridfunction_cfs)
+      ud.AssignMemory (cf, simd_ir_facet.GetNIP(), cf->Dimension(), lh);
+
+    for (ProxyFunction * proxy : trial_proxies)
+      {
+        IntRange trial_range  = proxy->IsOther() ?
+          IntRange(proxy->Evaluator()->BlockDim()*fel1.GetNDof(), elx.Size()) :
+          IntRange(0, proxy->Evaluator()->BlockDim()*fel1.GetNDof());
+        
+        if (proxy->IsOther())
+          proxy->Evaluator()->Apply(fel2, simd_mir2, elx.Range(trial_range), ud.GetAMemory(proxy));
+        else
+          proxy->Evaluator()->Apply(fel1, simd_mir1, elx.Range(trial_range), ud.GetAMemory(proxy));
+      }
+
+    for (auto proxy : test_proxies)
+      {
+        HeapReset hr(lh);
+        FlatMatrix<SIMD<double>> simd_proxyvalues(proxy->Dimension(), simd_ir_facet.Size(), lh);        
+        
+        for (int k = 0; k < proxy->Dimension(); k++)
+          {
+            ud.testfunction = proxy;
+            ud.test_comp = k;
+            cf -> Evaluate (simd_mir1, simd_proxyvalues.Rows(k,k+1));
+          }
+        
+        for (int i = 0; i < simd_proxyvalues.Height(); i++)
+          {
+            auto row = simd_proxyvalues.Row(i);
+            for (int j = 0; j < row.Size(); j++)
+              row(j) *= simd_mir1[j].GetMeasure() * simd_ir_facet[j].Weight();
+          }
+        IntRange test_range  = proxy->IsOther() ? IntRange(fel1.GetNDof(), elx.Size()) : IntRange(0, fel1.GetNDof());
+        int blockdim = proxy->Evaluator()->BlockDim();
+        test_range = blockdim * test_range;
+        
+        if (proxy->IsOther())
+          proxy->Evaluator()->AddTrans(fel2, simd_mir2, simd_proxyvalues, ely.Range(test_range));
+        else
+          proxy->Evaluator()->AddTrans(fel1, simd_mir1, simd_proxyvalues, ely.Range(test_range));
+      }
+  }
+
+
   void SymbolicFacetBilinearFormIntegrator ::
   ApplyFacetMatrix (const FiniteElement & fel1, int LocalFacetNr1,
                     const ElementTransformation & trafo1, FlatArray<int> & ElVertices1,
@@ -3447,8 +3714,6 @@ namespace ngfem
             
             // tstart.Start();
             
-            ely = 0;
-            
             int maxorder = max2 (fel1.Order(), fel2.Order());
             
             auto eltype1 = trafo1.GetElementType();
@@ -3461,78 +3726,11 @@ namespace ngfem
             const SIMD_IntegrationRule& simd_ir_facet = GetSIMDIntegrationRule(etfacet, 2*maxorder+bonus_intorder);
             
             auto & simd_ir_facet_vol1 = transform1(LocalFacetNr1, simd_ir_facet, lh);
-            auto & simd_mir1 = trafo1(simd_ir_facet_vol1, lh);
-            
             auto & simd_ir_facet_vol2 = transform2(LocalFacetNr2, simd_ir_facet, lh);
-            auto & simd_mir2 = trafo2(simd_ir_facet_vol2, lh);
-
-            simd_mir1.SetOtherMIR(&simd_mir2);
-            simd_mir2.SetOtherMIR(&simd_mir1);
-
-            
-            simd_mir1.ComputeNormalsAndMeasure(eltype1, LocalFacetNr1);
-            simd_mir2.ComputeNormalsAndMeasure(eltype2, LocalFacetNr2);
-            
-            // evaluate proxy-values
-            ProxyUserData ud(trial_proxies.Size(), gridfunction_cfs.Size(), lh);
-            const_cast<ElementTransformation&>(trafo1).userdata = &ud;
-            ud.fel = &fel1;   // necessary to check remember-map
-            for (ProxyFunction * proxy : trial_proxies)
-              ud.AssignMemory (proxy, simd_ir_facet.GetNIP(), proxy->Dimension(), lh);
-            for (CoefficientFunction * cf : gridfunction_cfs)
-              ud.AssignMemory (cf, simd_ir_facet.GetNIP(), cf->Dimension(), lh);
-            // tstart.Stop();
-            // tapply.Start();
-
-            // RegionTracer rtapply(TaskManager::GetThreadId(), tapply);                        
-            for (ProxyFunction * proxy : trial_proxies)
-              {
-                IntRange trial_range  = proxy->IsOther() ?
-                  IntRange(proxy->Evaluator()->BlockDim()*fel1.GetNDof(), elx.Size()) :
-                  IntRange(0, proxy->Evaluator()->BlockDim()*fel1.GetNDof());
-                
-                if (proxy->IsOther())
-                  proxy->Evaluator()->Apply(fel2, simd_mir2, elx.Range(trial_range), ud.GetAMemory(proxy));
-                else
-                  proxy->Evaluator()->Apply(fel1, simd_mir1, elx.Range(trial_range), ud.GetAMemory(proxy));
-                // tapply.AddFlops (trial_range.Size() * simd_ir_facet_vol1.GetNIP());
-              }
-            // tapply.Stop();
 
-            // RegionTracer rtapplyt(TaskManager::GetThreadId(), tapplyt);            
-            for (auto proxy : test_proxies)
-              {
-                HeapReset hr(lh);
-                // tcoef.Start();
-                FlatMatrix<SIMD<double>> simd_proxyvalues(proxy->Dimension(), simd_ir_facet.Size(), lh);        
-                
-                for (int k = 0; k < proxy->Dimension(); k++)
-                  {
-                    ud.testfunction = proxy;
-                    ud.test_comp = k;
-                    cf -> Evaluate (simd_mir1, simd_proxyvalues.Rows(k,k+1));
-                  }
-                
-                for (int i = 0; i < simd_proxyvalues.Height(); i++)
-                  {
-                    auto row = simd_proxyvalues.Row(i);
-                    for (int j = 0; j < row.Size(); j++)
-                      row(j) *= simd_mir1[j].GetMeasure() * simd_ir_facet[j].Weight();
-                  }
-                // tcoef.Stop();
-                // tapplyt.Start();
-                IntRange test_range  = proxy->IsOther() ? IntRange(fel1.GetNDof(), elx.Size()) : IntRange(0, fel1.GetNDof());
-                int blockdim = proxy->Evaluator()->BlockDim();
-                test_range = blockdim * test_range;
-                
-                if (proxy->IsOther())
-                  proxy->Evaluator()->AddTrans(fel2, simd_mir2, simd_proxyvalues, ely.Range(test_range));
-                else
-                  proxy->Evaluator()->AddTrans(fel1, simd_mir1, simd_proxyvalues, ely.Range(test_range));
-                // tapplyt.AddFlops (test_range.Size() * simd_ir_facet_vol1.GetNIP());                
-                // tapplyt.Stop();
-              }
-            // tall.Stop();
+            ApplyInnerFacetSIMD (fel1, LocalFacetNr1, trafo1, fel2, LocalFacetNr2, trafo2,
+                                 simd_ir_facet, simd_ir_facet_vol1, simd_ir_facet_vol2,
+                                 elx, ely, lh);
           }
         catch (ExceptionNOSIMD e)
           {
@@ -3656,6 +3854,64 @@ namespace ngfem
     // t.Stop();
   }
 
+  void SymbolicFacetBilinearFormIntegrator ::
+  ApplyFacetMatrixBatch (int LocalFacetNr1, int LocalFacetNr2,
+                         FlatArray<FacetPair> facets, LocalHeap & lh) const
+  {
+    if (!simd_evaluate || facets.Size() == 0)
+      {
+        FacetBilinearFormIntegrator::ApplyFacetMatrixBatch (LocalFacetNr1, LocalFacetNr2, facets, lh);
+        return;
+      }
+
+    static Timer t("SymbolicFacetBFI::ApplyBatch", 2);
+    ThreadRegionTimer reg(t, TaskManager::GetThreadId());
+    HeapReset hr(lh);
+
+    // the facets of a batch have equal facet orientations, so the
+    // reference facet rules are computed once per integration order
+    auto eltype1 = facets[0].trafo1->GetElementType();
+    auto eltype2 = facets[0].trafo2->GetElementType();
+    auto etfacet = ElementTopology::GetFacetType (eltype1, LocalFacetNr1);
+    Facet2ElementTrafo transform1(eltype1, facets[0].vnums1);
+    Facet2ElementTrafo transform2(eltype2, facets[0].vnums2);
+
+    int order = -1;
+    const SIMD_IntegrationRule * simd_ir_facet = nullptr;
+    const SIMD_IntegrationRule * simd_ir_facet_vol1 = nullptr;
+    const SIMD_IntegrationRule * simd_ir_facet_vol2 = nullptr;
+
+    for (size_t i = 0; i < facets.Size(); i++)
+      {
+        auto & f = facets[i];
+        int maxorder = max2 (f.fel1->Order(), f.fel2->Order());
+        if (maxorder != order)
+          {
+            order = maxorder;
+            simd_ir_facet = &GetSIMDIntegrationRule(etfacet, 2*order+bonus_intorder);
+            simd_ir_facet_vol1 = &transform1(LocalFacetNr1, *simd_ir_facet, lh);
+            simd_ir_facet_vol2 = &transform2(LocalFacetNr2, *simd_ir_facet, lh);
+          }
+
+        try
+          {
+            ApplyInnerFacetSIMD (*f.fel1, LocalFacetNr1, *f.trafo1,
+                                 *f.fel2, LocalFacetNr2, *f.trafo2,
+                                 *simd_ir_facet, *simd_ir_facet_vol1, *simd_ir_facet_vol2,
+                                 f.elx, f.ely, lh);
+          }
+        catch (ExceptionNOSIMD e)
+          {
+            cout << IM(6) << "caught in SymbolicFacetInegtrator::ApplyBatch: " << endl
+                 << e.What() << endl;
+            simd_evaluate = false;
+            FacetBilinearFormIntegrator::ApplyFacetMatrixBatch
+              (LocalFacetNr1, LocalFacetNr2, facets.Range(i, facets.Size()), lh);
+            return;
+          }
+      }
+  }
+
 
   void SymbolicFacetBilinearFormIntegrator :: 
   CalcTraceValues (const FiniteElement & volumefel, int LocalFacetNr,
@@ -4186,7 +4442,7 @@ namespace ngfem
     auto et = fel.ElementType();
     if (et == ET_TRIG || et == ET_TET)
       intorder -= 2*trial_difforder;
-    return SelectIntegrationRule (et, intorder);
+    return GetIntegrationRule (et, intorder);
   }
 
   const SIMD_IntegrationRule& SymbolicEnergy ::
@@ -4203,7 +4459,7 @@ namespace ngfem
     auto et = fel.ElementType();
     if (et == ET_TRIG || et == ET_TET)
       intorder -= 2*trial_difforder;
-    return SIMD_SelectIntegrationRule (et, intorder);
+    return GetSIMDIntegrationRule (et, intorder);
   }
 
   
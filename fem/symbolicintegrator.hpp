@@ -724,6 +724,15 @@ public:
                                           FlatMatrix<double> elmat,
                                           LocalHeap & lh) const;
     
+    /// mapped trial and test shapes at the integration points
+    NGS_DLL_HEADER virtual void *
+    PrecomputeData (const FiniteElement & fel,
+                    const ElementTransformation & trafo,
+                    bool single_precision,
+                    LocalHeap & lh) const override;
+    NGS_DLL_HEADER virtual size_t PrecomputedDataSize (void * precomputed) const override;
+    NGS_DLL_HEADER virtual void DeletePrecomputedData (void * precomputed) const override;
+
     NGS_DLL_HEADER virtual void 
     ApplyElementMatrix (const FiniteElement & fel, 
 			const ElementTransformation & trafo, 
@@ -855,6 +864,10 @@ public:
                       FlatVector<double> elx, FlatVector<double> ely,
                       LocalHeap & lh) const;
 
+    NGS_DLL_HEADER virtual void
+    ApplyFacetMatrixBatch (int LocalFacetNr1, int LocalFacetNr2,
+                           FlatArray<FacetPair> facets, LocalHeap & lh) const;
+
     NGS_DLL_HEADER virtual void
     CalcTraceValues (const FiniteElement & volumefel, int LocalFacetNr,
 		     const ElementTransformation & eltrans, FlatArray<int> & ElVertices,
@@ -875,6 +888,16 @@ public:
                       LocalHeap & lh) const;
 
   private:
+    void ApplyInnerFacetSIMD (const FiniteElement & fel1, int LocalFacetNr1,
+                              const ElementTransformation & trafo1,
+                              const FiniteElement & fel2, int LocalFacetNr2,
+                              const ElementTransformation & trafo2,
+                              const SIMD_IntegrationRule & simd_ir_facet,
+                              const SIMD_IntegrationRule & simd_ir_facet_vol1,
+                              const SIMD_IntegrationRule & simd_ir_facet_vol2,
+                              FlatVector<double> elx, FlatVector<double> ely,
+                              LocalHeap & lh) const;
+
     template<typename TSCAL>
     void T_CalcFacetMatrix(const FiniteElement & volumefel1, int LocalFacetNr1,
                            const ElementTransformation & eltrans1, FlatArray<int> & ElVertices1,
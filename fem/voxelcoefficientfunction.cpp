@@ -3,6 +3,28 @@
 
 namespace ngfem
 {
+  static size_t NumVoxels (FlatArray<size_t> dim_vals)
+  {
+    size_t n = 1;
+    for (auto d : dim_vals)
+      n *= d;
+    return n;
+  }
+  
+  template<typename T>
+  VoxelCoefficientFunction<T> ::
+  VoxelCoefficientFunction(const Array<double>& _start,
+                           const Array<double>& _end,
+                           const Array<size_t>& _dim_vals,
+                           shared_ptr<MappedFile> _file, size_t offset,
+                           bool _linear,
+                           shared_ptr<CoefficientFunction> trafo)
+    : CoefficientFunctionNoDerivative(1, is_same_v<T, Complex>),
+      start(_start), end(_end), dim_vals(_dim_vals), mapped_file(_file),
+      values(_file->View<T>(offset, NumVoxels(_dim_vals))),
+      linear(_linear), trafocf(trafo)
+  { ; }
+
   template<typename T>
   T VoxelCoefficientFunction<T> :: T_Evaluate(const BaseMappedIntegrationPoint& ip) const
   {
@@ -17,7 +39,7 @@ namespace ngfem
           trafocf->Evaluate(ip,pnt);
 
         size_t ind[DIM];
-        size_t weight[DIM];
+        double weight[DIM];
         
         for(auto i : Range(DIM))
           {
@@ -167,6 +189,163 @@ namespace ngfem
     throw Exception("Real evaluate for complex VoxelCoefficient called!");
   }
 
+  template<typename T>
+  void VoxelCoefficientFunction<T> ::
+  Evaluate(const SIMD_BaseMappedIntegrationRule& ir, BareSliceMatrix<SIMD<double>> res) const
+  {
+    if constexpr(!is_same_v<T, double>)
+      throw ExceptionNOSIMD("SIMD evaluate for complex VoxelCoefficient called!");
+    else
+      Switch<3> (start.Size()-1, [&] (auto ICDIM) {
+          constexpr int DIM = ICDIM.value+1;
+          constexpr int SW = SIMD<double>::Size();
+          size_t np = ir.Size();
+          
+          auto pnts = ir.GetPoints();
+          STACK_ARRAY(SIMD<double>, mem_pnts, trafocf ? trafocf->Dimension()*np : 0);
+          FlatMatrix<SIMD<double>> trafo_pnts(trafocf ? trafocf->Dimension() : 0, np, mem_pnts);
+          if (trafocf)
+            trafocf->Evaluate(ir, trafo_pnts);
+
+          double len[DIM];
+          for (auto i : Range(DIM))
+            len[i] = (end[i] - start[i]) / (linear ? dim_vals[i] - 1 : dim_vals[i]);
+
+          for (size_t k = 0; k < np; k++)
+            {
+              // voxel indices per lane, interpolation weights vectorized
+              size_t ind[DIM][SW];
+              SIMD<double> weight[DIM];
+              for (int i = 0; i < DIM; i++)
+                {
+                  SIMD<double> coord = trafocf ? trafo_pnts(i,k) : pnts(k,i);
+                  double pos[SW];
+                  for (int l = 0; l < SW; l++)
+                    {
+                      double c = min2(end[i], max2(start[i], coord[l]));
+                      if(!linear && c == end[i])
+                        c *= (1-1e-12);
+                      pos[l] = (c - start[i])/len[i];
+                      ind[i][l] = pos[l];
+                    }
+                  weight[i] = SIMD<double>([&] (int l) -> double { return 1.-(pos[l]-ind[i][l]); });
+                }
+
+              if(!linear)
+                {
+                  res(0,k) = SIMD<double>([&] (int l) -> double
+                                          {
+                                            size_t offset = dim_vals[0];
+                                            size_t index = ind[0][l];
+                                            for(int i = 1; i < DIM; i++)
+                                              {
+                                                index += offset * ind[i][l];
+                                                offset *= dim_vals[i];
+                                              }
+                                            return values[index];
+                                          });
+                  continue;
+                }
+
+              SIMD<double> sum = 0.0;
+              for (int corner = 0; corner < (1 << DIM); corner++)
+                {
+                  SIMD<double> tot_weight = 1.0;
+                  for (int i = 0; i < DIM; i++)
+                    tot_weight *= (corner & (1 << i)) ? SIMD<double>(1.0)-weight[i] : weight[i];
+                  
+                  SIMD<double> val([&] (int l) -> double
+                                   {
+                                     size_t offset = 1;
+                                     size_t index = 0;
+                                     for(int i = 0; i < DIM; i++)
+                                       {
+                                         size_t indi = (corner & (1 << i)) ?
+                                           min2(ind[i][l]+1, dim_vals[i]-1) : ind[i][l];
+                                         index += offset * indi;
+                                         offset *= dim_vals[i];
+                                       }
+                                     return values[index];
+                                   });
+                  sum += tot_weight * val;
+                }
+              res(0,k) = sum;
+            }
+        });
+  }
+
+  
+  shared_ptr<CoefficientFunction>
+  MappedVoxelCoefficient (const Array<double>& start, const Array<double>& end,
+                          const string & filename, Array<size_t> shape, bool is_complex,
+                          bool linear, shared_ptr<CoefficientFunction> trafo)
+  {
+    auto file = make_shared<MappedFile>(filename);
+    size_t offset = 0;
+
+    if (filename.size() > 4 && filename.substr(filename.size()-4) == ".npy")
+      {
+        // magic string, version, header length, header as python dict literal
+        const char * data = file->Data();
+        if (file->Size() < 12 || string(data+1, 5) != "NUMPY")
+          throw Exception("VoxelCoefficient: '" + filename + "' is not a .npy file");
+        size_t headerlen;
+        if (data[6] == 1)
+          {
+            headerlen = uint8_t(data[8]) + (size_t(uint8_t(data[9])) << 8);
+            offset = 10;
+          }
+        else
+          {
+            headerlen = uint8_t(data[8]) + (size_t(uint8_t(data[9])) << 8) +
+              (size_t(uint8_t(data[10])) << 16) + (size_t(uint8_t(data[11])) << 24);
+            offset = 12;
+          }
+        string header(data+offset, headerlen);
+        offset += headerlen;
+
+        auto entry = [&] (string key, char last)
+          {
+            auto pos = header.find("'"+key+"'");
+            if (pos == string::npos)
+              throw Exception("VoxelCoefficient: no '" + key + "' in header of " + filename);
+            pos = header.find(':', pos)+1;
+            return header.substr(pos, header.find(last, pos)-pos);
+          };
+
+        string descr = entry("descr", ',');
+        if (descr.find("<f8") != string::npos)
+          is_complex = false;
+        else if (descr.find("<c16") != string::npos)
+          is_complex = true;
+        else
+          throw Exception("VoxelCoefficient: only little endian float64 and complex128 .npy files are supported");
+        if (entry("fortran_order", ',').find("True") != string::npos)
+          throw Exception("VoxelCoefficient: .npy file must be stored in C order");
+
+        string sshape = entry("shape", ')');
+        sshape = sshape.substr(sshape.find('(')+1);
+        shape.SetSize0();
+        stringstream ss(sshape);
+        string item;
+        while (getline(ss, item, ','))
+          if (item.find_first_not_of(" ") != string::npos)
+            shape.Append(stoul(item));
+      }
+
+    Array<size_t> dim_vals;
+    for (auto s : shape)
+      dim_vals.Insert(0, s);
+    if (dim_vals.Size() != start.Size() || dim_vals.Size() != end.Size())
+      throw Exception("VoxelCoefficient: dimension of voxel data does not fit to start/end");
+
+    if (is_complex)
+      return make_shared<VoxelCoefficientFunction<Complex>>
+        (start, end, dim_vals, file, offset, linear, trafo);
+    return make_shared<VoxelCoefficientFunction<double>>
+      (start, end, dim_vals, file, offset, linear, trafo);
+  }
+
   template class VoxelCoefficientFunction<double>;
   template class VoxelCoefficientFunction<Complex>;
 } // namespace ngfem
@@ -10,7 +10,10 @@ namespace ngfem
   {
     Array<double> start, end;
     Array<size_t> dim_vals;
-    Array<SCAL> values;
+    // owner of values, either an array or a memory mapped file
+    Array<SCAL> own_values;
+    shared_ptr<MappedFile> mapped_file;
+    FlatArray<SCAL> values;
     bool linear;
     shared_ptr<CoefficientFunction> trafocf;
   public:
@@ -22,18 +25,39 @@ namespace ngfem
                              shared_ptr<CoefficientFunction> trafo=nullptr)
       : CoefficientFunctionNoDerivative(1, is_same_v<SCAL, Complex>),
         start(_start), end(_end), dim_vals(_dim_vals),
-        values(move(_values)), linear(_linear), trafocf(trafo)
+        own_values(move(_values)), values(own_values),
+        linear(_linear), trafocf(trafo)
     { ; }
 
+    /// values are read from the memory mapped file, starting at byte offset
+    VoxelCoefficientFunction(const Array<double>& _start,
+                             const Array<double>& _end,
+                             const Array<size_t>& _dim_vals,
+                             shared_ptr<MappedFile> _file, size_t offset,
+                             bool _linear,
+                             shared_ptr<CoefficientFunction> trafo=nullptr);
+
     using CoefficientFunctionNoDerivative::Evaluate;
     double Evaluate(const BaseMappedIntegrationPoint& ip) const override;
     Complex EvaluateComplex(const BaseMappedIntegrationPoint& ip) const override;
 
     void Evaluate(const BaseMappedIntegrationPoint& mip, FlatVector<Complex> values) const override;
+    void Evaluate(const SIMD_BaseMappedIntegrationRule& ir, BareSliceMatrix<SIMD<double>> values) const override;
 
   private:
     SCAL T_Evaluate(const BaseMappedIntegrationPoint& ip) const;
   };
+
+  /**
+     Voxel coefficient with values from a memory mapped file.
+     If the filename ends with .npy, type and dimensions are read from the
+     NumPy header, otherwise the file contains raw values of the given
+     shape (in NumPy ordering).
+  */
+  NGS_DLL_HEADER shared_ptr<CoefficientFunction>
+  MappedVoxelCoefficient (const Array<double>& start, const Array<double>& end,
+                          const string & filename, Array<size_t> shape, bool is_complex,
+                          bool linear, shared_ptr<CoefficientFunction> trafo = nullptr);
 } // namespace ngfem
 
 #endif // NGSOLVE_VOXELCOEFFICIENTFUNCTION_HPP
@@ -6,7 +6,7 @@
 
 /* 
 
-Arnoldi Eigenvalue Solver
+Arnoldi Eigenvalue Solver, Krylov-Schur restarts (Stewart 2001)
   
 */ 
 
@@ -14,6 +14,20 @@ Arnoldi Eigenvalue Solver
 
 namespace ngla
 {
+
+  namespace
+  {
+    // coefficients v^* w
+    template <typename SCAL>
+    Vector<SCAL> Coefficients (const MultiVector & v, const BaseVector & w)
+    {
+      if constexpr (is_same<SCAL,double>::value)
+        return v.InnerProductD (w);
+      else
+        return Conj (v.InnerProductC (w, true));
+    }
+  }
+
   
   template <typename SCAL>
   void Arnoldi<SCAL>::Calc (int numval, Array<Complex> & lam, int numev, 
@@ -21,128 +35,193 @@ namespace ngla
                             shared_ptr<BaseMatrix> pre) const
   { 
     static Timer t("arnoldi");    
+    static Timer t1("arnoldi - factor");
     static Timer t2("arnoldi - orthogonalize");    
     static Timer t3("arnoldi - compute large vectors");
+    static Timer t4("arnoldi - Schur");
 
     RegionTimer reg(t);
 
+    if (!inv)
+      {
+        RegionTimer reg(t1);
+        auto mat_shift = a->CreateMatrix();
+        mat_shift->AsVector() = a->AsVector() - shift*b->AsVector();  
+        if (!pre)
+          inv = mat_shift->InverseMatrix (freedofs);
+        else
+          {
+            auto itso = make_shared<GMRESSolver<double>> (mat_shift, pre);
+            itso->SetPrintRates(1);
+            itso->SetMaxSteps(2000);
+            inv = itso;
+          }
+        invshift = shift;
+      }
+
     auto hv  = a->CreateColVector();
-    auto hv2 = a->CreateColVector();
     auto hva = a->CreateColVector();
-    auto hvm = a->CreateColVector();
    
     int n = hv.template FV<SCAL>().Size();    
     int m = min2 (numval, n);
+    int nev = min2 (numev, m);
+    // restarts need space to expand, and must not split a conjugate pair
+    bool restart = nev+2 <= m;
 
-
-    Matrix<SCAL> matH(m);
-    Array<shared_ptr<BaseVector>> abv(m);
-    for (int i = 0; i < m; i++)
-      abv[i] = a->CreateColVector();
-
-    auto mat_shift = a->CreateMatrix();
-    mat_shift->AsVector() = a->AsVector() - shift*b->AsVector();  
-    shared_ptr<BaseMatrix> inv;
-    if (!pre)
-      inv = mat_shift->InverseMatrix (freedofs);
-    else
-      {
-        auto itso = make_shared<GMRESSolver<double>> (mat_shift, pre);
-        itso->SetPrintRates(1);
-        itso->SetMaxSteps(2000);
-        inv = itso;
-      }
-
-    hv.SetRandom();
-    hv.SetParallelStatus (CUMULATED);
-    FlatVector<SCAL> fv = hv.template FV<SCAL>();
-    if (freedofs)
-      for (int i = 0; i < hv.Size(); i++)
-	if (! (*freedofs)[i] ) fv(i) = 0;
-
-    t2.Start();
-    // matV = SCAL(0.0);   why ?
+    // Krylov basis v[0..m], Rayleigh quotient H
+    auto v = (*hv).CreateMultiVector (m+1);
+    Matrix<SCAL> matH(m+1, m);
     matH = SCAL(0.0);
 
-    *hv2 = *hv;
-    SCAL len = sqrt (S_InnerProduct<SCAL> (*hv, *hv2)); // parallel
-    *hv /= len;
+    auto SetRandom = [&] ()
+      {
+        hv.SetRandom();
+        hv.SetParallelStatus (CUMULATED);
+        FlatVector<SCAL> fv = hv.template FV<SCAL>();
+        if (freedofs)
+          for (int i = 0; i < hv.Size(); i++)
+            if (! (*freedofs)[i] ) fv(i) = 0;
+      };
     
-    for (int i = 0; i < m; i++)
+    // classical Gram-Schmidt against v[0..j], orthogonalized twice
+    auto Orthogonalize = [&] (int j, auto && h)
+      {
+        auto vj = v->Range (IntRange(0, j+1));
+        for (int l = 0; l < 2; l++)
+          {
+            Vector<SCAL> hl = Coefficients<SCAL> (*vj, *hv);
+            h += hl;
+            hl *= -1;
+            vj->AddTo (hl, *hv);
+          }
+      };
+
+    SetRandom();
+    *(*v)[0] = (1.0 / L2Norm(*hv)) * *hv;
+
+    // closest to the shift, for the shift-and-invert eigenvalue mu
+    auto dist = [&] (Complex mu) { return abs (Complex(invshift) + 1.0/mu - Complex(shift)); };
+    auto SortByDistance = [&] (FlatVector<Complex> mu)
+      {
+        Array<int> order(mu.Size());
+        for (int i = 0; i < order.Size(); i++) order[i] = i;
+        QuickSort (order, [&] (int i, int j) { return dist(mu(i)) < dist(mu(j)); });
+        return order;
+      };
+
+    Matrix<SCAL,ColMajor> matT(m), matQ(m);
+    Vector<Complex> mu(m);
+    Array<int> select(m);
+    int k = 0;    // size of the kept Krylov-Schur decomposition
+    int nw = nev; // size of the wanted block
+
+    for (int it = 0; ; it++)
       {
-	cout << IM(1) << "\ri = " << i << "/" << m << flush;
-	/*
-	for (int j = 0; j < n; j++)
-	  matV(i,j) = hv.FV<SCAL>()(j);
-	*/
-	*abv[i] = *hv;
+        // expand to m+1 basis vectors
+        for (int j = k; j < m; j++)
+          {
+            *hva = *b * *(*v)[j];
+            *hv = *inv * *hva;
+
+            RegionTimer reg(t2);
+            double len0 = L2Norm (*hv);
+            Orthogonalize (j, matH.Col(j).Range(0, j+1));
+            double len = L2Norm (*hv);
+            if (len <= 1e-12 * len0)
+              {
+                // breakdown, span v[0..j] is invariant: H(j+1,j) = 0,
+                // continue with a random vector orthogonal to the basis
+                len = 0;
+                SetRandom();
+                Vector<SCAL> dummy(j+1);
+                dummy = SCAL(0.0);
+                Orthogonalize (j, dummy);
+                *(*v)[j+1] = (1.0 / L2Norm(*hv)) * *hv;
+              }
+            else
+              *(*v)[j+1] = (1.0 / len) * *hv;
+            matH(j+1,j) = len;
+          }
+
+        // H = Q T Q^*, wanted eigenvalues in the leading block
+        {
+          RegionTimer reg(t4);
+          matT = matH.Rows(0, m);
+          LapackSchur (matT, matQ, mu);
+          auto order = SortByDistance (mu);
+          select = 0;
+          for (int i = 0; i < nev; i++)
+            select[order[i]] = 1;
+          nw = LapackReorderSchur (matT, matQ, select, mu);
+        }
+
+        // the last row of the Krylov-Schur decomposition gives the residuals
+        Vector<SCAL> bq = Trans(matQ) * matH.Row(m);
+        double minmu = 1e300;
+        for (int i = 0; i < nw; i++)
+          minmu = min2 (minmu, abs(mu(i)));
+        double res = L2Norm (bq.Range(0, nw)) / minmu;
+        cout << IM(3) << "Krylov-Schur restart " << it << ", residual = " << res << endl;
+
+        if (!restart || res < tol)
+          break;
+        if (it >= maxrestarts)
+          {
+            cout << "WARNING: Krylov-Schur Arnoldi not converged after " << maxrestarts
+                 << " restarts, residual = " << res << endl;
+            break;
+          }
+
+        // keep the wanted and the next closest Ritz values
+        {
+          RegionTimer reg(t4);
+          int keep = min2 (m-2, max2 (nw, (nev+m)/2));
+          auto order = SortByDistance (mu);
+          select = 0;
+          for (int i = 0; i < keep; i++)
+            select[order[i]] = 1;
+          k = LapackReorderSchur (matT, matQ, select, mu);
+        }
+        bq = Trans(matQ) * matH.Row(m);
+
+        // v[0..k) = v[0..m) Q[:,0..k), v[k] = v[m]
+        {
+          RegionTimer reg(t3);
+          Matrix<SCAL> qk = matQ.Cols(0, k);
+          auto vk = (*hv).CreateMultiVector (k);
+          *vk = 0.0;
+          vk->Add (*v->Range(IntRange(0, m)), qk);
+          for (int i = 0; i < k; i++)
+            *(*v)[i] = *(*vk)[i];
+          *(*v)[k] = *(*v)[m];
+        }
+        matH = SCAL(0.0);
+        matH.Rows(0, k).Cols(0, k) = matT.Rows(0, k).Cols(0, k);
+        matH.Row(k).Range(0, k) = bq.Range(0, k);
+      }
 
-	*hva = *b * *hv;
-	*hvm = *inv * *hva;
+    // Ritz pairs of the wanted block, T y = mu y
+    Matrix<Complex> matTt(nw), evecs(nw);
+    Vector<Complex> lami(nw);
+    matTt = Trans (matT.Rows(0, nw).Cols(0, nw));
+    LapackEigenValues (matTt, lami, evecs);
 
-	for (int j = 0; j <= i; j++)
-	  {
-            /*
-            SCAL sum = 0.0;
-	    for (int k = 0; k < n; k++)
-	      sum += hvm.FV<SCAL>()(k) * matV(j,k);
-	    matH(j,i) = sum;
-	    for (int k = 0; k < n; k++)
-	      hvm.FV<SCAL>()(k) -= sum * matV(j,k);
-            */
-            /*
-            SCAL sum = 0.0;
-            FlatVector<SCAL> abvj = abv[j] -> FV<SCAL>();
-            FlatVector<SCAL> fv_hvm = hvm.FV<SCAL>();
-	    for (int k = 0; k < n; k++)
-	      sum += fv_hvm(k) * abvj(k);
-	    matH(j,i) = sum;
-	    for (int k = 0; k < n; k++)
-	      fv_hvm(k) -= sum * abvj(k);
-            */
-
-	    matH(j,i) = S_InnerProduct<SCAL> (*hvm, *abv[j]);
-	    *hvm -= matH(j,i) * *abv[j];
-	  }
-		
-	*hv = *hvm;
-	*hv2 = *hv;
-	SCAL len = sqrt (S_InnerProduct<SCAL> (*hv, *hv2));
-	if (i<m-1) matH(i+1,i) = len; 
-	
-	*hv /= len;
-      }
-      
-    t2.Stop();
-    t2.AddFlops (double(n)*m*m);
-    cout << "n = " << n << ", m = " << m << " n*m*m = " << n*m*m << endl;
-    cout << IM(1) << "\ri = " << m << "/" << m << endl;	    
-
-	    
-    Vector<Complex> lami(m);
-    Matrix<Complex> evecs(m);    
-    Matrix<Complex> matHt(m);
-
-    matHt = Trans (matH);
-    
-    evecs = Complex (0.0);
-    lami = Complex (0.0);
+    for (int i = 0; i < nw; i++)
+      lami(i) =  1.0 / lami(i) + invshift;
 
-    cout << "Solve Hessenberg evp with Lapack ... " << flush;
-    LapackHessenbergEP (matH.Height(), &matHt(0,0), &lami(0), &evecs(0,0));
-    cout << "done" << endl;
-	    
-    for (int i = 0; i < m; i++)
-      lami(i) =  1.0 / lami(i) + shift;
+    Array<int> order(nw);
+    for (int i = 0; i < nw; i++) order[i] = i;
+    QuickSort (order, [&] (int i, int j)
+               { return abs(lami(i)-Complex(shift)) < abs(lami(j)-Complex(shift)); });
 
-    lam.SetSize (m);
-    for (int i = 0; i < m; i++)
-      lam[i] = lami(i);
+    lam.SetSize (nw);
+    for (int i = 0; i < nw; i++)
+      lam[i] = lami(order[i]);
 
-    t3.Start();
+    RegionTimer reg3(t3);
     if (numev>0)
       {
-	int nout = min2 (numev, m); 
+	int nout = min2 (numev, nw); 
 	hevecs.SetSize(nout);
 	for (int i = 0; i< nout; i++)
 	  {
@@ -150,14 +229,19 @@ namespace ngla
               hevecs[i] = a->CreateColVector();
             else // real biform and system-vecors not yet supported
               hevecs[i] =  make_shared<VVector<Complex>> (a->Height());
+
+            // Ritz vector v[0..m) Q[:,0..nw) y
+            Vector<Complex> coefs(m);
+            coefs = Complex(0.0);
+            for (int j = 0; j < m; j++)
+              for (int l = 0; l < nw; l++)
+                coefs(j) += matQ(j,l) * evecs(order[i],l);
             
 	    *hevecs[i] = 0;
 	    for (int j = 0; j < m; j++)
-	      *hevecs[i] += evecs(i,j) * *abv[j];
-	    // hevecs[i]->FVComplex() = Trans(matV)*evecs.Row(i);
+	      *hevecs[i] += coefs(j) * *(*v)[j];
 	  }
       }
-    t3.Stop();
   } 
 	
 
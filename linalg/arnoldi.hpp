@@ -20,7 +20,14 @@ namespace ngla
      B must by symmetric and (in theory) positive definite
      A can be non-symmetric
 
-     It uses a shift-and-invert Arnoldi method 
+     It uses a shift-and-invert Arnoldi method, restarted by the
+     Krylov-Schur method: the Krylov space dimension stays bounded by
+     numval, independent of the number of requested eigenvalues.
+
+     The shifted matrix (A - s B) is factored in the first call of Calc
+     (or given by SetInverse), and reused for later calls and other
+     shifts. The computed eigenvalues are the ones closest to the
+     current shift.
    */
 
   template <typename SCAL>
@@ -30,6 +37,11 @@ namespace ngla
     shared_ptr<BaseMatrix> b;
     shared_ptr<BitArray> freedofs;
     SCAL shift;
+    int maxrestarts = 20;
+    double tol = 1e-8;
+    // (a - invshift b)^{-1}
+    mutable shared_ptr<BaseMatrix> inv;
+    mutable SCAL invshift;
 
   public:
     Arnoldi (shared_ptr<BaseMatrix> aa, shared_ptr<BaseMatrix> ab, shared_ptr<BitArray> afreedofs = nullptr)
@@ -38,9 +50,19 @@ namespace ngla
       shift = 1.0;
     }
 
+    /// eigenvalues closest to the shift are computed
     void SetShift (SCAL ashift)
     { shift = ashift; }
 
+    /// use a given factorization of (A - ainvshift B) for all shifts
+    void SetInverse (shared_ptr<BaseMatrix> ainv, SCAL ainvshift)
+    { inv = ainv; invshift = ainvshift; }
+
+    shared_ptr<BaseMatrix> GetInverse () const { return inv; }
+
+    void SetMaxRestarts (int amaxrestarts) { maxrestarts = amaxrestarts; }
+    void SetTolerance (double atol) { tol = atol; }
+
     void Calc (int numval, Array<Complex> & lam, int nev, 
                Array<shared_ptr<BaseVector>> & evecs, 
                shared_ptr<BaseMatrix> pre = nullptr) const;
@@ -358,6 +358,7 @@ namespace ngla
                       size_t(0));
 
     bigmem.SetSize(totmem);
+    tracked.Set (MemoryTracker::PRECONDITIONER, totmem*sizeof(TM));
     
     totmem = 0;
     for (auto i : Range (*blocktable))
@@ -62,6 +62,10 @@ namespace ngla
     }
 
 
+    shared_ptr<Table<int>> GetBlockTable () const { return blocktable; }
+    /// blocks of one color do not overlap
+    const Table<int> & GetBlockColoring () const { return block_coloring; }
+
     /// reorders block entries for band-width minimization
     int Reorder (FlatArray<int> block, const MatrixGraph & graph,
 		 FlatArray<int> usedflags,        // in and out: array of -1, size = graph.size
@@ -119,6 +123,7 @@ namespace ngla
     Array<FlatMatrix<TM>> invdiag;
     /// the data for the inverses
     Array<TM> bigmem;
+    TrackedMemory tracked;
 
   public:
     // typedef typename mat_traits<TM>::TV_ROW TVX;
@@ -138,6 +143,8 @@ namespace ngla
 
     AutoVector CreateRowVector() const override { return mat.CreateColVector(); }
     AutoVector CreateColVector() const override { return mat.CreateRowVector(); }
+
+    FlatArray<FlatMatrix<TM>> GetInverseBlocks () const { return invdiag; }
     
     ///
     void MultAdd (TSCAL s, const BaseVector & x, BaseVector & y) const override;
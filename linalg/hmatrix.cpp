@@ -0,0 +1,458 @@
+/*********************************************************************/
+/* File:   hmatrix.cpp                                               */
+/* Date:   2024                                                      */
+/*********************************************************************/
+
+#include <la.hpp>
+#include "hmatrix.hpp"
+
+namespace ngla
+{
+
+  void AdaptiveCrossApproximation (const function<double(size_t,size_t)> & entry,
+                                   IntRange rows, IntRange cols, double tol,
+                                   Matrix<> & u, Matrix<> & v)
+  {
+    size_t m = rows.Size(), n = cols.Size();
+    size_t maxrank = min(m, n);
+
+    // column l of u is ubuf[l*m ...], row l of v is vbuf[l*n ...]
+    Array<double> ubuf, vbuf;
+    Array<bool> usedrow(m);
+    usedrow = false;
+    Vector<> r(n), c(m);
+
+    double norm2 = 0;     // |sum_l u_l v_l|_F^2
+    size_t k = 0;
+    size_t i = 0;         // pivot row
+    while (k < maxrank)
+      {
+        // residual of row i
+        usedrow[i] = true;
+        for (size_t j = 0; j < n; j++)
+          r(j) = entry(rows.First()+i, cols.First()+j);
+        for (size_t l = 0; l < k; l++)
+          r -= ubuf[l*m+i] * FlatVector<>(n, &vbuf[l*n]);
+
+        size_t jp = 0;
+        for (size_t j = 1; j < n; j++)
+          if (fabs(r(j)) > fabs(r(jp))) jp = j;
+
+        if (r(jp) == 0)
+          {
+            // row is represented exactly, try the next unused one
+            i = 0;
+            while (i < m && usedrow[i]) i++;
+            if (i == m) break;
+            continue;
+          }
+        r /= r(jp);
+
+        // residual of column jp
+        for (size_t ii = 0; ii < m; ii++)
+          c(ii) = entry(rows.First()+ii, cols.First()+jp);
+        for (size_t l = 0; l < k; l++)
+          c -= vbuf[l*n+jp] * FlatVector<>(m, &ubuf[l*m]);
+
+        // |S_k|^2 = |S_k-1|^2 + 2 sum_l (u_l,c) (v_l,r) + |c|^2 |r|^2
+        double cross = 0;
+        for (size_t l = 0; l < k; l++)
+          cross += InnerProduct (FlatVector<>(m, &ubuf[l*m]), c)
+            * InnerProduct (FlatVector<>(n, &vbuf[l*n]), r);
+        double nc2 = L2Norm2(c), nr2 = L2Norm2(r);
+        norm2 += 2*cross + nc2*nr2;
+
+        for (size_t ii = 0; ii < m; ii++) ubuf.Append (c(ii));
+        for (size_t j = 0; j < n; j++) vbuf.Append (r(j));
+        k++;
+
+        if (sqrt(nc2*nr2) <= tol * sqrt(norm2)) break;
+
+        // next pivot row: largest entry of the new column
+        i = m;
+        double cmax = -1;
+        for (size_t ii = 0; ii < m; ii++)
+          if (!usedrow[ii] && fabs(c(ii)) > cmax)
+            {
+              cmax = fabs(c(ii));
+              i = ii;
+            }
+        if (i == m) break;
+      }
+
+    u.SetSize (m, k);
+    v.SetSize (k, n);
+    for (size_t l = 0; l < k; l++)
+      {
+        u.Col(l) = FlatVector<>(m, &ubuf[l*m]);
+        v.Row(l) = FlatVector<>(n, &vbuf[l*n]);
+      }
+    RecompressLowRank (u, v, tol);
+  }
+
+
+  void RecompressLowRank (Matrix<> & u, Matrix<> & v, double tol)
+  {
+    size_t m = u.Height(), k = u.Width(), n = v.Width();
+    if (k == 0) return;
+
+    // u = q r by Gram-Schmidt with reorthogonalization,
+    // linearly dependent columns are dropped
+    double umax = 0;
+    for (size_t l = 0; l < k; l++)
+      umax = max2(umax, L2Norm(u.Col(l)));
+
+    Matrix<> q(m, k), r(k, k);
+    r = 0.0;
+    size_t rk = 0;
+    Vector<> w(m);
+    for (size_t l = 0; l < k; l++)
+      {
+        w = u.Col(l);
+        for (int pass = 0; pass < 2; pass++)
+          for (size_t j = 0; j < rk; j++)
+            {
+              double rjl = InnerProduct (q.Col(j), w);
+              r(j,l) += rjl;
+              w -= rjl * q.Col(j);
+            }
+        double nw = L2Norm(w);
+        if (nw <= 1e-14 * umax) continue;
+        q.Col(rk) = (1/nw) * w;
+        r(rk,l) = nw;
+        rk++;
+      }
+
+    if (rk == 0)
+      {
+        u.SetSize (m, 0);
+        v.SetSize (0, n);
+        return;
+      }
+
+    // singular values of u v = q b from the eigen-decomposition of b b^T.
+    // Squaring the singular values limits the accuracy to sqrt(eps),
+    // which is below any tolerance we compress with.
+    Matrix<> b = r.Rows(0, rk) * v;
+    Matrix<> g = b * Trans(b);
+    Vector<> lami(rk);
+    Matrix<> evecs(rk, rk);
+    FlatMatrix<> fg = g, fevecs = evecs;
+    FlatVector<> flami = lami;
+    BatchedSymEig (FlatArray<FlatMatrix<double>> (1, &fg),
+                   FlatArray<FlatVector<double>> (1, &flami),
+                   FlatArray<FlatMatrix<double>> (1, &fevecs));
+
+    // drop the smallest singular values, as long as their
+    // sum of squares stays below tol^2 |u v|^2
+    double total = 0;
+    for (size_t l = 0; l < rk; l++)
+      total += max2(lami(l), 0.0);
+    double dropped = 0;
+    size_t first = 0;
+    while (first < rk && dropped + max2(lami(first), 0.0) <= sqr(tol) * total)
+      dropped += max2(lami(first++), 0.0);
+
+    auto w_k = evecs.Rows(first, rk);
+    Matrix<> newu = q.Cols(0, rk) * Trans(w_k);
+    Matrix<> newv = w_k * b;
+    u = std::move(newu);
+    v = std::move(newv);
+  }
+
+
+
+  HODLRMatrix :: HODLRMatrix (size_t n, const function<double(size_t,size_t)> & entry,
+                              double atol, size_t leafsize)
+    : height(n), tol(atol)
+  {
+    Build (entry, leafsize);
+  }
+
+  HODLRMatrix :: HODLRMatrix (FlatMatrix<double> mat, double atol, size_t leafsize)
+    : height(mat.Height()), tol(atol)
+  {
+    if (mat.Height() != mat.Width())
+      throw Exception ("HODLRMatrix: matrix must be square, have "
+                       + ToString(mat.Height()) + " x " + ToString(mat.Width()));
+    Build ([mat] (size_t i, size_t j) { return mat(i,j); }, leafsize);
+  }
+
+  void HODLRMatrix :: Build (const function<double(size_t,size_t)> & entry, size_t leafsize)
+  {
+    static Timer t("HODLRMatrix::Build");
+    RegionTimer reg(t);
+
+    leafsize = max2(leafsize, size_t(1));
+
+    // the cluster tree by bisection
+    Array<Node*> nodes;
+    function<unique_ptr<Node>(IntRange,int)> create = [&] (IntRange r, int level)
+      {
+        auto node = make_unique<Node>();
+        node->range = r;
+        node->level = level;
+        node->nr = nodes.Size();
+        nodes.Append (node.get());
+        if (levels.Size() <= size_t(level))
+          levels.SetSize (level+1);
+        levels[level].Append (node.get());
+
+        if (r.Size() > leafsize)
+          {
+            size_t mid = r.First() + r.Size()/2;
+            node->left = create (IntRange(r.First(), mid), level+1);
+            node->right = create (IntRange(mid, r.Next()), level+1);
+          }
+        return node;
+      };
+    root = create (IntRange(0, height), 0);
+    nnodes = nodes.Size();
+
+    // dense leaves and low-rank blocks are independent
+    ParallelFor (nodes.Size(), [&] (size_t nr)
+                 {
+                   Node & node = *nodes[nr];
+                   if (node.IsLeaf())
+                     {
+                       IntRange r = node.range;
+                       node.dense.SetSize (r.Size(), r.Size());
+                       for (size_t i = 0; i < r.Size(); i++)
+                         for (size_t j = 0; j < r.Size(); j++)
+                           node.dense(i,j) = entry (r.First()+i, r.First()+j);
+                       return;
+                     }
+                   AdaptiveCrossApproximation (entry, node.left->range, node.right->range, tol,
+                                               node.u12, node.v12);
+                   AdaptiveCrossApproximation (entry, node.right->range, node.left->range, tol,
+                                               node.u21, node.v21);
+                 });
+
+    tracked.Set (MemoryTracker::MATRIX, NZE()*sizeof(double));
+  }
+
+  AutoVector HODLRMatrix :: CreateRowVector () const
+  {
+    return CreateBaseVector (height, false, 1);
+  }
+
+  AutoVector HODLRMatrix :: CreateColVector () const
+  {
+    return CreateBaseVector (height, false, 1);
+  }
+
+  void HODLRMatrix :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("HODLRMatrix::MultAdd");
+    RegionTimer reg(t);
+    t.AddFlops (NZE());
+
+    FlatVector<> fx = x.FV<double>();
+    FlatVector<> fy = y.FV<double>();
+
+    for (auto & level : levels)
+      ParallelFor (level.Size(), [&] (size_t nr)
+                   {
+                     const Node & node = *level[nr];
+                     if (node.IsLeaf())
+                       {
+                         fy.Range(node.range) += s * node.dense * fx.Range(node.range);
+                         return;
+                       }
+                     IntRange r1 = node.left->range, r2 = node.right->range;
+                     Vector<> h1 = node.v12 * fx.Range(r2);
+                     fy.Range(r1) += s * node.u12 * h1;
+                     Vector<> h2 = node.v21 * fx.Range(r1);
+                     fy.Range(r2) += s * node.u21 * h2;
+                   });
+  }
+
+  void HODLRMatrix :: MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("HODLRMatrix::MultTransAdd");
+    RegionTimer reg(t);
+    t.AddFlops (NZE());
+
+    FlatVector<> fx = x.FV<double>();
+    FlatVector<> fy = y.FV<double>();
+
+    for (auto & level : levels)
+      ParallelFor (level.Size(), [&] (size_t nr)
+                   {
+                     const Node & node = *level[nr];
+                     if (node.IsLeaf())
+                       {
+                         fy.Range(node.range) += s * Trans(node.dense) * fx.Range(node.range);
+                         return;
+                       }
+                     IntRange r1 = node.left->range, r2 = node.right->range;
+                     Vector<> h1 = Trans(node.u12) * fx.Range(r1);
+                     fy.Range(r2) += s * Trans(node.v12) * h1;
+                     Vector<> h2 = Trans(node.u21) * fx.Range(r2);
+                     fy.Range(r1) += s * Trans(node.v21) * h2;
+                   });
+  }
+
+  size_t HODLRMatrix :: MaxRank () const
+  {
+    size_t maxrank = 0;
+    for (auto & level : levels)
+      for (const Node * node : level)
+        if (!node->IsLeaf())
+          maxrank = max2(maxrank, max2(node->u12.Width(), node->u21.Width()));
+    return maxrank;
+  }
+
+  size_t HODLRMatrix :: NZE () const
+  {
+    size_t nze = 0;
+    for (auto & level : levels)
+      for (const Node * node : level)
+        nze += node->dense.Height()*node->dense.Width()
+          + node->u12.Height()*node->u12.Width() + node->v12.Height()*node->v12.Width()
+          + node->u21.Height()*node->u21.Width() + node->v21.Height()*node->v21.Width();
+    return nze;
+  }
+
+  Array<MemoryUsage> HODLRMatrix :: GetMemoryUsage () const
+  {
+    return { MemoryUsage ("HODLRMatrix", NZE()*sizeof(double), nnodes) };
+  }
+
+
+
+  /*
+    For a node with children A1, A2
+
+      A = diag(A1,A2) + diag(u12,u21) [ 0 v12 ; v21 0 ] = D + U V
+
+    and by Sherman-Morrison-Woodbury
+
+      A^-1 = D^-1 - W S^-1 V D^-1,   W = D^-1 U,   S = I + V W
+
+    W is computed by the solvers of the children, so the factorization
+    runs bottom up, level by level.
+  */
+  class HODLRInverse : public BaseMatrix
+  {
+    struct Factor
+    {
+      /// leaf: the inverse of the dense block, otherwise the inverse of S
+      Matrix<> sinv;
+      /// W = diag(w1, w2)
+      Matrix<> w1, w2;
+    };
+
+    shared_ptr<const HODLRMatrix> mat;
+    Array<Factor> factors;
+    TrackedMemory tracked;
+
+  public:
+    HODLRInverse (shared_ptr<const HODLRMatrix> amat)
+      : mat(amat), factors(amat->NumNodes())
+    {
+      static Timer t("HODLRInverse::Factor");
+      RegionTimer reg(t);
+
+      auto levels = mat->GetLevels();
+      for (int l = int(levels.Size())-1; l >= 0; l--)
+        ParallelFor (levels[l].Size(), [&] (size_t i)
+                     {
+                       const auto & node = *levels[l][i];
+                       Factor & f = factors[node.nr];
+                       if (node.IsLeaf())
+                         {
+                           f.sinv = node.dense;
+                           CalcInverse (f.sinv);
+                           return;
+                         }
+
+                       f.w1 = node.u12;
+                       Solve (*node.left, f.w1);
+                       f.w2 = node.u21;
+                       Solve (*node.right, f.w2);
+
+                       size_t k1 = f.w1.Width(), k2 = f.w2.Width();
+                       f.sinv.SetSize (k1+k2, k1+k2);
+                       f.sinv = 0.0;
+                       for (size_t j = 0; j < k1+k2; j++)
+                         f.sinv(j,j) = 1;
+                       f.sinv.Rows(0,k1).Cols(k1,k1+k2) = node.v12 * f.w2;
+                       f.sinv.Rows(k1,k1+k2).Cols(0,k1) = node.v21 * f.w1;
+                       if (k1+k2 > 0)
+                         CalcInverse (f.sinv);
+                     });
+
+      tracked.Set (MemoryTracker::FACTORIZATION, NZE()*sizeof(double));
+    }
+
+    bool IsComplex() const override { return false; }
+    int VHeight() const override { return mat->Height(); }
+    int VWidth() const override { return mat->Height(); }
+
+    AutoVector CreateRowVector () const override { return mat->CreateColVector(); }
+    AutoVector CreateColVector () const override { return mat->CreateRowVector(); }
+
+    /// x <- A(node)^-1 x, for all columns of x
+    void Solve (const HODLRMatrix::Node & node, SliceMatrix<> x) const
+    {
+      const Factor & f = factors[node.nr];
+      if (node.IsLeaf())
+        {
+          Matrix<> hx = x;
+          x = f.sinv * hx;
+          return;
+        }
+
+      size_t n1 = node.left->range.Size();
+      SliceMatrix<> x1 = x.Rows(0, n1);
+      SliceMatrix<> x2 = x.Rows(n1, x.Height());
+      Solve (*node.left, x1);
+      Solve (*node.right, x2);
+
+      size_t k1 = f.w1.Width(), k2 = f.w2.Width();
+      if (k1+k2 == 0) return;
+      Matrix<> vy(k1+k2, x.Width());
+      vy.Rows(0,k1) = node.v12 * x2;
+      vy.Rows(k1,k1+k2) = node.v21 * x1;
+      Matrix<> z = f.sinv * vy;
+      x1 -= f.w1 * z.Rows(0,k1);
+      x2 -= f.w2 * z.Rows(k1,k1+k2);
+    }
+
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override
+    {
+      static Timer t("HODLRInverse::MultAdd");
+      RegionTimer reg(t);
+
+      FlatVector<> fx = x.FV<double>();
+      FlatVector<> fy = y.FV<double>();
+      Matrix<> hx(fx.Size(), 1);
+      hx.Col(0) = fx;
+      Solve (mat->GetRoot(), hx);
+      fy += s * hx.Col(0);
+    }
+
+    size_t NZE () const override
+    {
+      size_t nze = 0;
+      for (auto & f : factors)
+        nze += f.sinv.Height()*f.sinv.Width() + f.w1.Height()*f.w1.Width() + f.w2.Height()*f.w2.Width();
+      return nze;
+    }
+
+    Array<MemoryUsage> GetMemoryUsage () const override
+    {
+      return { MemoryUsage ("HODLRInverse", NZE()*sizeof(double), factors.Size()) };
+    }
+  };
+
+
+  shared_ptr<BaseMatrix> HODLRMatrix :: InverseMatrix (shared_ptr<BitArray> subset) const
+  {
+    if (subset)
+      throw Exception ("HODLRMatrix::InverseMatrix: subsets not supported");
+    return make_shared<HODLRInverse> (dynamic_pointer_cast<const HODLRMatrix> (shared_from_this()));
+  }
+
+}
@@ -0,0 +1,103 @@
+#ifndef FILE_NGS_HMATRIX
+#define FILE_NGS_HMATRIX
+
+/**************************************************************************/
+/* File:   hmatrix.hpp                                                    */
+/* Date:   2024                                                           */
+/**************************************************************************/
+
+namespace ngla
+{
+
+  /*
+    Hierarchically off-diagonal low-rank (HODLR) matrix.
+
+    The index range is bisected recursively down to leafsize. Diagonal
+    leaf blocks are kept dense, the two off-diagonal blocks of every
+    node are stored as U V with U of size m x k and V of size k x n.
+    The factors are computed by adaptive cross approximation (ACA with
+    partial pivoting), which evaluates only O((m+n) k) entries of a
+    block, and are then recompressed to the rank needed for the relative
+    accuracy tol. For smooth kernels (boundary element matrices, Schur
+    complements of elliptic problems) the rank grows only slowly with n,
+    and storage and matrix-vector product are O(n k log n).
+  */
+
+  class NGS_DLL_HEADER HODLRMatrix : public BaseMatrix
+  {
+  public:
+    struct Node
+    {
+      IntRange range;
+      int level;
+      /// number in creation order, 0 <= nr < NumNodes()
+      size_t nr;
+      unique_ptr<Node> left, right;
+      /// leaf: the diagonal block
+      Matrix<> dense;
+      /// A(left,right) = u12 v12, A(right,left) = u21 v21
+      Matrix<> u12, v12, u21, v21;
+
+      bool IsLeaf() const { return left == nullptr; }
+    };
+
+  protected:
+    unique_ptr<Node> root;
+    /// nodes of level l, they have disjoint ranges
+    Array<Array<Node*>> levels;
+    size_t height;
+    size_t nnodes = 0;
+    double tol;
+    TrackedMemory tracked;
+
+  public:
+    /// compress the matrix with entries entry(i,j), 0 <= i,j < n.
+    /// entry is called concurrently from several threads
+    HODLRMatrix (size_t n, const function<double(size_t,size_t)> & entry,
+                 double atol = 1e-8, size_t leafsize = 64);
+    /// compress a dense matrix
+    HODLRMatrix (FlatMatrix<double> mat, double atol = 1e-8, size_t leafsize = 64);
+
+    bool IsComplex() const override { return false; }
+    int VHeight() const override { return height; }
+    int VWidth() const override { return height; }
+
+    AutoVector CreateRowVector () const override;
+    AutoVector CreateColVector () const override;
+
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    /// direct solver by recursive Sherman-Morrison-Woodbury, O(n k^2 log^2 n)
+    shared_ptr<BaseMatrix> InverseMatrix (shared_ptr<BitArray> subset = nullptr) const override;
+
+    const Node & GetRoot() const { return *root; }
+    FlatArray<Array<Node*>> GetLevels() const { return levels; }
+    size_t NumNodes() const { return nnodes; }
+    double GetTolerance() const { return tol; }
+
+    /// maximal rank of the off-diagonal blocks
+    size_t MaxRank () const;
+    /// number of stored values, compare to n*n for the dense matrix
+    size_t NZE () const override;
+    Array<MemoryUsage> GetMemoryUsage () const override;
+
+  protected:
+    void Build (const function<double(size_t,size_t)> & entry, size_t leafsize);
+  };
+
+
+  /**
+     Low-rank approximation A(rows,cols) ~ u v by adaptive cross
+     approximation with partial pivoting, followed by recompression.
+     The relative accuracy is tol in the Frobenius norm.
+  */
+  NGS_DLL_HEADER void AdaptiveCrossApproximation (const function<double(size_t,size_t)> & entry,
+                                                  IntRange rows, IntRange cols, double tol,
+                                                  Matrix<> & u, Matrix<> & v);
+
+  /// truncate u v to the smallest rank with relative accuracy tol
+  NGS_DLL_HEADER void RecompressLowRank (Matrix<> & u, Matrix<> & v, double tol);
+}
+
+#endif
@@ -58,6 +58,8 @@ namespace ngla
     ///
     AutoVector CreateRowVector() const override { return mat.CreateColVector(); }
     AutoVector CreateColVector() const override { return mat.CreateRowVector(); }
+
+    FlatArray<TM> GetInverseDiagonal () const { return invdiag; }
     ///
     void GSSmooth (BaseVector & x, const BaseVector & b) const override;
 
@@ -47,6 +47,10 @@ namespace ngla
 #include "chebyshev.hpp"
 #include "eigen.hpp"
 #include "arnoldi.hpp"
+#include "lobpcg.hpp"
+#include "mappedmatrix.hpp"
+#include "singleprecision.hpp"
+#include "hmatrix.hpp"
 
 #include "cuda_linalg.hpp"
 #endif
@@ -0,0 +1,239 @@
+/**************************************************************************/
+/* File:   lobpcg.cpp                                                     */
+/* Date:   2024                                                           */
+/**************************************************************************/
+
+/*
+  LOBPCG eigenvalue solver (Knyazev 2001), all vector operations
+  are block operations on MultiVectors
+*/
+
+#include <la.hpp>
+
+namespace ngla
+{
+
+  namespace
+  {
+    // shares the vectors of several MultiVectors, no copies
+    class StackedMultiVector : public MultiVector
+    {
+    public:
+      StackedMultiVector (shared_ptr<BaseVector> ref) : MultiVector (ref, 0) { ; }
+      void Stack (const MultiVector & mv)
+      {
+        for (size_t i = 0; i < mv.Size(); i++)
+          vecs.Append (mv[i]);
+      }
+    };
+
+    void Mult (const BaseMatrix * mat, const MultiVector & x, MultiVector & y)
+    {
+      static Timer t("LOBPCG - block mult");
+      RegionTimer reg(t);
+
+      if (!mat)
+        {
+          y = x;
+          return;
+        }
+      y = 0.0;
+      Vector<double> ones(x.Size());
+      ones = 1;
+      mat->MultAdd (ones, x, y);
+    }
+
+    // x -= y (my^T x), for M-orthonormal y with my = M y
+    void OrthogonalizeAgainst (MultiVector & x, const MultiVector & y, const MultiVector & my)
+    {
+      if (!x.Size() || !y.Size()) return;
+      Matrix<double> c = my.InnerProductD (x);
+      c *= -1;
+      x.Add (y, c);
+    }
+  }
+
+  
+  Vector<double> LOBPCG (const BaseMatrix & mata, const BaseMatrix * matm,
+                         const BaseMatrix * pre, MultiVector & x,
+                         int maxit, double tol, int printrates)
+  {
+    static Timer t("LOBPCG");
+    static Timer tortho("LOBPCG - orthogonalize");
+    static Timer trr("LOBPCG - Rayleigh-Ritz");
+    RegionTimer reg(t);
+
+    if (x.IsComplex())
+      throw Exception ("LOBPCG: only real problems are supported");
+
+    size_t nev = x.Size();
+    Vector<double> lam(nev);
+    if (nev == 0) return lam;
+
+    auto ref = x.RefVec();
+    auto create = [&] () { return ref->CreateMultiVector (nev); };
+    auto X = create(), AX = create(), MX = create();
+    auto Xn = create(), AXn = create(), MXn = create();
+    auto R = create(), W = create(), AW = create(), MW = create();
+    auto P = create(), Pn = create(), AP = create(), MP = create();
+    BaseMatrix * ipmat = const_cast<BaseMatrix*> (matm);
+
+    // small generalized evp on span(S), keeps the nev lowest Ritz pairs
+    // in Xn, AXn, MXn and returns the coefficients. Fails if the basis
+    // is numerically linearly dependent (M-Gram matrix not SPD)
+    auto RayleighRitz = [&] (const MultiVector & S, const MultiVector & AS,
+                             const MultiVector & MS, Matrix<double> & c) -> bool
+      {
+        RegionTimer reg(trr);
+        size_t ns = S.Size();
+        Matrix<double> ga = S.InnerProductD (AS);
+        Matrix<double> gm = S.InnerProductD (MS);
+        ga = 0.5 * (ga + Trans(ga));
+        gm = 0.5 * (gm + Trans(gm));
+
+        // the blocks are M-orthonormal, so gm is close to I unless they
+        // are nearly dependent
+        Matrix<double> gmcopy = gm;
+        Vector<double> gmlam(ns);
+        LapackEigenValuesSymmetric (gmcopy, gmlam);
+        if (!(gmlam(0) > 1e-10 * gmlam(ns-1)))
+          return false;
+
+        Vector<double> lami(ns);
+        Matrix<double> evecs(ns);
+        LapackEigenValuesSymmetric (ga, gm, lami, evecs);
+        for (size_t i = 0; i < nev; i++)
+          if (!isfinite(lami(i)))
+            return false;
+
+        // eigenvectors are the rows of evecs
+        c.SetSize (ns, nev);
+        c = Trans (evecs.Rows(0, nev));
+        lam = lami.Range(0, nev);
+
+        *Xn = 0.0;  Xn->Add (S, c);
+        *AXn = 0.0; AXn->Add (AS, c);
+        *MXn = 0.0; MXn->Add (MS, c);
+        swap (X, Xn); swap (AX, AXn); swap (MX, MXn);
+        return true;
+      };
+
+    *X = x;
+    {
+      RegionTimer reg(tortho);
+      X->Orthogonalize (ipmat);
+    }
+    Mult (&mata, *X, *AX);
+    Mult (matm, *X, *MX);
+    {
+      Matrix<double> c;
+      if (!RayleighRitz (*X, *AX, *MX, c))
+        throw Exception ("LOBPCG: initial vectors are linearly dependent");
+    }
+
+    Vector<double> res(nev);
+    size_t np = 0;    // P is empty in the first iteration
+    int it = 0;
+    for ( ; it < maxit; it++)
+      {
+        // R = AX - MX diag(lam), relative residuals
+        *R = *AX;
+        Matrix<double> dlam(nev);
+        dlam = 0.0;
+        for (size_t i = 0; i < nev; i++)
+          dlam(i,i) = -lam(i);
+        R->Add (*MX, dlam);
+
+        Array<int> active;
+        for (size_t i = 0; i < nev; i++)
+          {
+            double scale = (*AX)[i]->L2Norm() + fabs(lam(i)) * (*MX)[i]->L2Norm();
+            res(i) = (*R)[i]->L2Norm() / (scale > 0 ? scale : 1);
+            if (res(i) > tol)
+              active.Append (i);
+          }
+
+        if (printrates)
+          cout << IM(1) << "LOBPCG it " << it << ", active " << active.Size()
+               << ", max residual " << MaxNorm(res) << endl;
+        if (active.Size() == 0) break;
+        size_t nact = active.Size();
+
+        // W = pre R for the active pairs, M-orthonormal to X
+        auto Ra = R->SubSet (active);
+        auto Wa = W->Range (IntRange(0, nact));
+        Mult (pre, *Ra, *Wa);
+        {
+          RegionTimer reg(tortho);
+          OrthogonalizeAgainst (*Wa, *X, *MX);
+          Wa->Orthogonalize (ipmat);
+        }
+        auto AWa = AW->Range (IntRange(0, nact));
+        auto MWa = MW->Range (IntRange(0, nact));
+        Mult (&mata, *Wa, *AWa);
+        Mult (matm, *Wa, *MWa);
+
+        // search directions of the active pairs, M-orthonormal to X and W
+        Array<int> pind;
+        if (np) pind = active;
+        auto Pa = P->SubSet (pind);
+        auto APa = AP->Range (IntRange(0, Pa->Size()));
+        auto MPa = MP->Range (IntRange(0, Pa->Size()));
+        if (Pa->Size())
+          {
+            {
+              RegionTimer reg(tortho);
+              OrthogonalizeAgainst (*Pa, *X, *MX);
+              OrthogonalizeAgainst (*Pa, *Wa, *MWa);
+              Pa->Orthogonalize (ipmat);
+            }
+            Mult (&mata, *Pa, *APa);
+            Mult (matm, *Pa, *MPa);
+          }
+
+        // Rayleigh-Ritz on [X, W, P], or [X, W] for a restart
+        auto RayleighRitzStep = [&] (bool withp)
+          {
+            StackedMultiVector S(ref), AS(ref), MS(ref), WP(ref);
+            S.Stack (*X);   S.Stack (*Wa);
+            AS.Stack (*AX); AS.Stack (*AWa);
+            MS.Stack (*MX); MS.Stack (*MWa);
+            WP.Stack (*Wa);
+            if (withp)
+              {
+                S.Stack (*Pa); AS.Stack (*APa); MS.Stack (*MPa);
+                WP.Stack (*Pa);
+              }
+
+            Matrix<double> c;
+            if (!RayleighRitz (S, AS, MS, c))
+              return false;
+
+            // P = [W, P] * C_wp, for all pairs
+            *Pn = 0.0;
+            Pn->Add (WP, c.Rows(nev, c.Height()));
+            swap (P, Pn);
+            return true;
+          };
+
+        bool ok = RayleighRitzStep (Pa->Size() > 0);
+        if (!ok && Pa->Size())
+          {
+            // W and P are nearly linearly dependent, drop P
+            if (printrates)
+              cout << IM(1) << "LOBPCG it " << it << ", restart without search directions" << endl;
+            ok = RayleighRitzStep (false);
+          }
+        if (!ok)
+          throw Exception ("LOBPCG: Rayleigh-Ritz basis is linearly dependent, check the preconditioner");
+        np = nev;
+      }
+
+    if (printrates)
+      cout << IM(1) << "LOBPCG finished after " << it << " iterations" << endl;
+
+    x = *X;
+    return lam;
+  }
+
+}
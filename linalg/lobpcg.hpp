@@ -0,0 +1,30 @@
+#ifndef FILE_LOBPCG
+#define FILE_LOBPCG
+
+/**************************************************************************/
+/* File:   lobpcg.hpp                                                     */
+/* Date:   2024                                                           */
+/**************************************************************************/
+
+namespace ngla
+{
+  /**
+     Locally optimal block preconditioned conjugate gradient method.
+
+     Computes the x.Size() smallest eigenpairs of the symmetric evp
+
+     A x = lam M x
+
+     M must be symmetric positive definite (nullptr means identity),
+     pre is a spd preconditioner for A (nullptr means identity).
+     On entry x holds the initial guesses, on exit the M-orthonormal
+     eigenvectors. Converged pairs are locked (soft locking): they take
+     part in the Rayleigh-Ritz step, but are no longer preconditioned.
+     Returns the eigenvalues.
+   */
+  NGS_DLL_HEADER Vector<double> LOBPCG (const BaseMatrix & mata, const BaseMatrix * matm,
+                                        const BaseMatrix * pre, MultiVector & x,
+                                        int maxit = 100, double tol = 1e-8, int printrates = 0);
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*********************************************************************/
+/* File:   mappedmatrix.cpp                                          */
+/* Date:   2024                                                      */
+/*********************************************************************/
+
+#include <la.hpp>
+#include "mappedmatrix.hpp"
+#include <fstream>
+
+namespace ngla
+{
+
+  namespace
+  {
+    enum { MAPPED_MATRIX = 0, MAPPED_VECTOR = 1 };
+    constexpr size_t MAPPED_ALIGN = 64;
+
+    struct MappedHeader
+    {
+      char magic[8];
+      int32_t kind;        // MAPPED_MATRIX or MAPPED_VECTOR
+      int32_t iscomplex;
+      int32_t entrysize;   // scalars per entry
+      int32_t symmetric;
+      int64_t height, width, nze;
+    };
+
+    size_t AlignUp (size_t n) { return (n + MAPPED_ALIGN-1) / MAPPED_ALIGN * MAPPED_ALIGN; }
+
+    void WriteSection (ostream & ost, const void * data, size_t bytes)
+    {
+      ost.write (static_cast<const char*> (data), bytes);
+      static const char zeros[MAPPED_ALIGN] = { 0 };
+      ost.write (zeros, AlignUp(bytes) - bytes);
+    }
+
+    ofstream OpenOutput (const string & filename, const MappedHeader & header)
+    {
+      ofstream ost(filename, ios::binary);
+      if (!ost)
+        throw Exception ("SaveBinary: cannot open file '" + filename + "'");
+      WriteSection (ost, &header, sizeof(header));
+      return ost;
+    }
+
+    MappedHeader ReadHeader (const MappedFile & file)
+    {
+      auto header = file.View<MappedHeader> (0, 1)[0];
+      if (string(header.magic, 8) != "NGSBIN01")
+        throw Exception ("'" + file.GetFileName() + "' is not a binary matrix/vector file");
+      return header;
+    }
+
+    // keeps the mapping alive as long as the matrix lives
+    template <typename TBASE>
+    class Mapped : public TBASE
+    {
+      shared_ptr<MappedFile> file;
+    public:
+      template <typename ... ARGS>
+      Mapped (shared_ptr<MappedFile> afile, ARGS && ... args)
+        : TBASE (std::forward<ARGS>(args)...), file(afile) { ; }
+    };
+
+    template <typename TSCAL>
+    class MappedVector : public S_BaseVectorPtr<TSCAL>
+    {
+      shared_ptr<MappedFile> file;
+    public:
+      MappedVector (shared_ptr<MappedFile> afile, size_t size, int es, void * data)
+        : S_BaseVectorPtr<TSCAL> (size, es, data), file(afile) { ; }
+    };
+
+    template <typename TM>
+    shared_ptr<BaseSparseMatrix> MapMatrix (shared_ptr<MappedFile> file, const MappedHeader & header)
+    {
+      size_t offset = AlignUp (sizeof(MappedHeader));
+      auto firsti = file->View<size_t> (offset, header.height+1);
+      offset += AlignUp (firsti.Size()*sizeof(size_t));
+      auto colnr = file->View<int> (offset, header.nze+1);
+      offset += AlignUp (colnr.Size()*sizeof(int));
+      auto data = file->View<TM> (offset, header.nze);
+
+      if (header.symmetric)
+        return make_shared<Mapped<SparseMatrixSymmetric<TM>>> (file, header.height, firsti, colnr, data);
+      return make_shared<Mapped<SparseMatrix<TM>>> (file, header.height, header.width, firsti, colnr, data);
+    }
+  }
+
+
+  void SaveBinary (const BaseMatrix & mat, const string & filename)
+  {
+    static Timer t("SaveBinary - matrix");
+    RegionTimer reg(t);
+
+    auto pspmat = dynamic_cast<const BaseSparseMatrix*> (&mat);
+    auto dmat = dynamic_cast<const SparseMatrixTM<double>*> (&mat);
+    auto cmat = dynamic_cast<const SparseMatrixTM<Complex>*> (&mat);
+    if (!pspmat || (!dmat && !cmat))
+      throw Exception ("SaveBinary: only SparseMatrix with scalar entries supported, have "
+                       + string(typeid(mat).name()));
+    auto & spmat = *pspmat;
+
+    MappedHeader header = { { 'N','G','S','B','I','N','0','1' }, MAPPED_MATRIX,
+                            cmat != nullptr, 1, spmat.SymmetricStorage(),
+                            spmat.Height(), spmat.Width(), int64_t(spmat.NZE()) };
+    ofstream ost = OpenOutput (filename, header);
+
+    FlatArray<size_t> firsti = spmat.GetFirstArray();
+    WriteSection (ost, firsti.Data(), firsti.Size()*sizeof(size_t));
+
+    Array<int> colnr(spmat.NZE()+1);
+    for (size_t i = 0; i < spmat.Height(); i++)
+      colnr.Range(firsti[i], firsti[i+1]) = spmat.GetRowIndices(i);
+    colnr[spmat.NZE()] = 0;
+    WriteSection (ost, colnr.Data(), colnr.Size()*sizeof(int));
+
+    auto & vals = mat.AsVector();
+    WriteSection (ost, vals.Memory(), vals.Size()*vals.EntrySize()*sizeof(double));
+    if (!ost)
+      throw Exception ("SaveBinary: writing '" + filename + "' failed");
+  }
+
+
+  void SaveBinary (const BaseVector & vec, const string & filename)
+  {
+    static Timer t("SaveBinary - vector");
+    RegionTimer reg(t);
+
+    bool iscomplex = vec.IsComplex();
+    int es = vec.EntrySize() / (iscomplex ? 2 : 1);
+    MappedHeader header = { { 'N','G','S','B','I','N','0','1' }, MAPPED_VECTOR,
+                            iscomplex, es, 0, int64_t(vec.Size()), 1, 0 };
+    ofstream ost = OpenOutput (filename, header);
+    WriteSection (ost, vec.Memory(), vec.Size()*vec.EntrySize()*sizeof(double));
+    if (!ost)
+      throw Exception ("SaveBinary: writing '" + filename + "' failed");
+  }
+
+
+  bool IsMappedMatrixFile (const string & filename)
+  {
+    MappedFile file(filename);
+    return ReadHeader(file).kind == MAPPED_MATRIX;
+  }
+
+
+  shared_ptr<BaseSparseMatrix> LoadMappedMatrix (const string & filename)
+  {
+    static Timer t("LoadMappedMatrix");
+    RegionTimer reg(t);
+
+    auto file = make_shared<MappedFile> (filename, true);   // handed out writable
+    auto header = ReadHeader (*file);
+    if (header.kind != MAPPED_MATRIX)
+      throw Exception ("LoadMappedMatrix: '" + filename + "' contains a vector");
+
+    if (header.iscomplex)
+      return MapMatrix<Complex> (file, header);
+    return MapMatrix<double> (file, header);
+  }
+
+
+  shared_ptr<BaseVector> LoadMappedVector (const string & filename)
+  {
+    static Timer t("LoadMappedVector");
+    RegionTimer reg(t);
+
+    auto file = make_shared<MappedFile> (filename, true);   // handed out writable
+    auto header = ReadHeader (*file);
+    if (header.kind != MAPPED_VECTOR)
+      throw Exception ("LoadMappedVector: '" + filename + "' contains a matrix");
+
+    size_t offset = AlignUp (sizeof(MappedHeader));
+    if (header.iscomplex)
+      {
+        auto data = file->View<Complex> (offset, header.height*header.entrysize);
+        return make_shared<MappedVector<Complex>> (file, header.height, header.entrysize, data.Data());
+      }
+    auto data = file->View<double> (offset, header.height*header.entrysize);
+    return make_shared<MappedVector<double>> (file, header.height, header.entrysize, data.Data());
+  }
+
+}
@@ -0,0 +1,41 @@
+#ifndef FILE_NGS_MAPPEDMATRIX
+#define FILE_NGS_MAPPEDMATRIX
+
+/**************************************************************************/
+/* File:   mappedmatrix.hpp                                               */
+/* Date:   2024                                                           */
+/**************************************************************************/
+
+namespace ngla
+{
+
+  /*
+    Binary container for assembled sparse matrices and vectors, which
+    is loaded by mapping the file into memory. The loaded objects
+    reference the mapped pages directly: loading costs only the page
+    faults, and processes on one node share the memory. The mapping is
+    copy-on-write: written pages become private copies, the file is
+    not changed.
+
+    Layout (all sections aligned to 64 bytes):
+      header:   magic "NGSBIN01", kind, scalar type, entry size, symmetric,
+                height, width, nze
+      matrix:   firsti [height+1] (size_t), colnr [nze+1] (int), values [nze]
+      vector:   values [height]
+  */
+
+
+  /// write a SparseMatrix with scalar entries, or a vector
+  NGS_DLL_HEADER void SaveBinary (const BaseMatrix & mat, const string & filename);
+  NGS_DLL_HEADER void SaveBinary (const BaseVector & vec, const string & filename);
+
+  /// mapped matrix, throws if the file contains a vector
+  NGS_DLL_HEADER shared_ptr<BaseSparseMatrix> LoadMappedMatrix (const string & filename);
+  /// mapped vector, throws if the file contains a matrix
+  NGS_DLL_HEADER shared_ptr<BaseVector> LoadMappedVector (const string & filename);
+
+  /// does the file contain a matrix (or a vector) ?
+  NGS_DLL_HEADER bool IsMappedMatrixFile (const string & filename);
+}
+
+#endif
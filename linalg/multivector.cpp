@@ -342,6 +342,36 @@ namespace ngla {
     static Timer t("MultiVector::InnerProductD");
     RegionTimer reg(t);
 
+    auto local = [] (const BaseVector & v)
+      { return v.GetParallelStatus() == NOT_PARALLEL && !v.IsComplex(); };
+    bool all_local = Size() > 0 && y.Size() > 0;
+    for (auto & v : vecs) all_local = all_local && local(*v);
+    for (auto j : ngstd::Range(y.Size())) all_local = all_local && local(*y[j]);
+
+    if (all_local)
+      {
+        // all pairs in one sweep over the entries, chunks stay in cache
+        size_t n = vecs[0]->FVDouble().Size();
+        Array<double*> px(Size()), py(y.Size());
+        for (auto i : ngstd::Range(Size())) px[i] = vecs[i]->FVDouble().Data();
+        for (auto j : ngstd::Range(y.Size())) py[j] = y[j]->FVDouble().Data();
+
+        Matrix<double> res(Size(), y.Size());
+        res = 0.0;
+        std::mutex m;
+        ParallelForRange (n, [&] (IntRange r)
+          {
+            Matrix<double> part(Size(), y.Size());
+            for (size_t i = 0; i < Size(); i++)
+              for (size_t j = 0; j < y.Size(); j++)
+                part(i,j) = ngbla::InnerProduct (FlatVector<double>(r.Size(), px[i]+r.First()),
+                                                 FlatVector<double>(r.Size(), py[j]+r.First()));
+            lock_guard<std::mutex> guard(m);
+            res += part;
+          });
+        return res;
+      }
+    
     Matrix<double> res(Size(), y.Size());
     for (int i = 0; i < Size(); i++)
       for (int j = 0; j < y.Size(); j++)
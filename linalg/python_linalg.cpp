@@ -1108,6 +1108,13 @@ inverse : string
 
   py::implicitly_convertible<BaseVector, DynamicVectorExpression>();
   py::implicitly_convertible<DynamicVectorExpression, BaseVector>();
+
+  m.def("SetCoarseAgglomerationRanks", [](int n) { coarse_agglomeration_ranks = n; },
+        py::arg("n"), docu_string(R"raw_string(
+Number of ranks the 'agglomerate' inverse of a ParallelMatrix factorizes
+on. Every rank factorizes the whole matrix redundantly and serves only its
+group of ranks. 0 (default) chooses about sqrt(number of ranks).
+)raw_string"));
   
 #ifndef PARALLEL
 
@@ -1234,8 +1241,102 @@ inverse : string
          "perform smoothing step (needs non-symmetric storage so symmetric sparse matrix)")
     ;
 
-  py::class_<SparseCholesky<double>, shared_ptr<SparseCholesky<double>>, SparseFactorization> (m, "SparseCholesky_d");
-  py::class_<SparseCholesky<Complex>, shared_ptr<SparseCholesky<Complex>>, SparseFactorization> (m, "SparseCholesky_c");
+  py::class_<SparseCholesky<double>, shared_ptr<SparseCholesky<double>>, SparseFactorization> (m, "SparseCholesky_d")
+    .def_property_readonly("outofcore", [] (SparseCholesky<double> & self) { return self.IsOutOfCore(); },
+                           "is the factor stored in a scratch file ?")
+    .def("InverseDiagonal", [] (SparseCholesky<double> & self) -> shared_ptr<BaseVector>
+         {
+           auto d = self.InverseDiagonal();
+           auto vec = make_shared<VVector<double>> (d.Size());
+           vec->FV() = FlatVector<double> (d.Size(), d.Data());
+           return vec;
+         }, py::call_guard<py::gil_scoped_release>(),
+         "diagonal of the inverse matrix by selected inversion, 0 for unused dofs")
+    .def("InverseEntry", &SparseCholesky<double>::InverseEntry, py::arg("i"), py::arg("j"),
+         "entry of the inverse matrix, (i,j) must be in the pattern of the factor")
+    .def("SolveSparse", [] (SparseCholesky<double> & self, const BaseVector & f, BaseVector & u,
+                            vector<int> rhsdofs, vector<int> soldofs)
+         {
+           self.SolveSparse (FlatArray<int> (rhsdofs.size(), rhsdofs.data()), f,
+                             FlatArray<int> (soldofs.size(), soldofs.data()), u);
+         }, py::arg("f"), py::arg("u"), py::arg("rhsdofs"), py::arg("soldofs")=vector<int>(),
+         py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
+u[soldofs] = A^-1 f, where f is zero outside of rhsdofs. Only the parts
+of the factor on the elimination tree paths from rhsdofs and soldofs
+to the root are visited. Empty soldofs computes all entries of u.
+)raw_string"))
+    .def("UpdateLowRank", [] (SparseCholesky<double> & self, vector<int> dofs, Matrix<double> w, double sigma)
+         {
+           self.UpdateLowRank (FlatArray<int> (dofs.size(), dofs.data()), w, sigma);
+         }, py::arg("dofs"), py::arg("w"), py::arg("sigma")=1,
+         py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
+Modify the factorization to A + sigma W W^T, sigma = 1 (update) or -1
+(downdate). Row k of w belongs to dofs[k]. The modification must not
+leave the pattern of the factor.
+)raw_string"))
+    .def("UpdatePartial", [] (SparseCholesky<double> & self, vector<int> dofs)
+         {
+           self.UpdatePartial (FlatArray<int> (dofs.size(), dofs.data()));
+         }, py::arg("dofs"), py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
+Refactor after the entries of the matrix in the rows and columns dofs
+have been changed, within the sparsity pattern. Only the supernodes on
+the elimination tree paths from these dofs to the root are recomputed.
+)raw_string"))
+    ;
+  py::class_<SparseCholesky<Complex>, shared_ptr<SparseCholesky<Complex>>, SparseFactorization> (m, "SparseCholesky_c")
+    .def_property_readonly("outofcore", [] (SparseCholesky<Complex> & self) { return self.IsOutOfCore(); },
+                           "is the factor stored in a scratch file ?")
+    .def("InverseDiagonal", [] (SparseCholesky<Complex> & self) -> shared_ptr<BaseVector>
+         {
+           auto d = self.InverseDiagonal();
+           auto vec = make_shared<VVector<Complex>> (d.Size());
+           vec->FV() = FlatVector<Complex> (d.Size(), d.Data());
+           return vec;
+         }, py::call_guard<py::gil_scoped_release>(),
+         "diagonal of the inverse matrix by selected inversion, 0 for unused dofs")
+    .def("InverseEntry", &SparseCholesky<Complex>::InverseEntry, py::arg("i"), py::arg("j"),
+         "entry of the inverse matrix, (i,j) must be in the pattern of the factor")
+    .def("SolveSparse", [] (SparseCholesky<Complex> & self, const BaseVector & f, BaseVector & u,
+                            vector<int> rhsdofs, vector<int> soldofs)
+         {
+           self.SolveSparse (FlatArray<int> (rhsdofs.size(), rhsdofs.data()), f,
+                             FlatArray<int> (soldofs.size(), soldofs.data()), u);
+         }, py::arg("f"), py::arg("u"), py::arg("rhsdofs"), py::arg("soldofs")=vector<int>(),
+         py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
+u[soldofs] = A^-1 f, where f is zero outside of rhsdofs. Only the parts
+of the factor on the elimination tree paths from rhsdofs and soldofs
+to the root are visited. Empty soldofs computes all entries of u.
+)raw_string"))
+    .def("UpdateLowRank", [] (SparseCholesky<Complex> & self, vector<int> dofs, Matrix<Complex> w, double sigma)
+         {
+           self.UpdateLowRank (FlatArray<int> (dofs.size(), dofs.data()), w, sigma);
+         }, py::arg("dofs"), py::arg("w"), py::arg("sigma")=1,
+         py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
+Modify the factorization to A + sigma W W^T, sigma = 1 (update) or -1
+(downdate). Row k of w belongs to dofs[k]. The modification must not
+leave the pattern of the factor.
+)raw_string"))
+    .def("UpdatePartial", [] (SparseCholesky<Complex> & self, vector<int> dofs)
+         {
+           self.UpdatePartial (FlatArray<int> (dofs.size(), dofs.data()));
+         }, py::arg("dofs"), py::call_guard<py::gil_scoped_release>(), docu_string(R"raw_string(
+Refactor after the entries of the matrix in the rows and columns dofs
+have been changed, within the sparsity pattern. Only the supernodes on
+the elimination tree paths from these dofs to the root are recomputed.
+)raw_string"))
+    ;
+
+  m.def("SetCholeskyOutOfCore", [] (size_t memory_budget, string directory)
+        {
+          cholesky_outofcore.memory_budget = memory_budget;
+          cholesky_outofcore.directory = directory;
+        }, py::arg("memory_budget"), py::arg("directory")="/tmp", docu_string(R"raw_string(
+Sparse Cholesky factors larger than memory_budget bytes are stored in
+a scratch file in directory, which should be on a fast local disk.
+Finished parts of the factor are written back during factorization,
+the solves read ahead in elimination order. memory_budget = 0 keeps
+all factors in memory (default).
+)raw_string"));
   
   py::class_<Projector, shared_ptr<Projector>, BaseMatrix> (m, "Projector")
     .def(py::init<shared_ptr<BitArray>,bool>(),
@@ -1435,9 +1536,76 @@ maxsteps : int
 )raw_string"))
     ;
   
+  m.def("LOBPCG", [](shared_ptr<BaseMatrix> mata, shared_ptr<BaseMatrix> matm,
+                     shared_ptr<BaseMatrix> pre, int num, int maxit, double tol,
+                     bool printrates, shared_ptr<MultiVector> initial)
+        {
+          shared_ptr<MultiVector> vecs;
+          if (initial)
+            {
+              vecs = initial;
+              if (vecs->Size() < 1)
+                throw Exception ("LOBPCG: empty initial MultiVector");
+            }
+          else
+            {
+              auto hv = mata->CreateColVector();
+              auto r = hv.CreateVector();
+              vecs = (*hv).CreateMultiVector(num);
+              for (size_t i = 0; i < vecs->Size(); i++)
+                {
+                  r.SetRandom();
+                  if (pre)
+                    *(*vecs)[i] = *pre * *r;
+                  else
+                    *(*vecs)[i] = *r;
+                }
+            }
+          auto lam = LOBPCG (*mata, matm.get(), pre.get(), *vecs, maxit, tol, printrates);
+          return py::make_tuple (lam, vecs);
+        },
+        py::arg("mata"), py::arg("matm")=nullptr, py::arg("pre")=nullptr, py::arg("num")=1,
+        py::arg("maxit")=100, py::arg("tol")=1e-8, py::arg("printrates")=false,
+        py::arg("initial")=nullptr,
+        docu_string(R"raw_string(
+LOBPCG eigenvalue solver
+
+Computes the smallest eigenpairs of the symmetric EVP A*u = lam*M*u by the
+locally optimal block preconditioned conjugate gradient method. Converged
+pairs are locked. Returns a tuple (eigenvalues, MultiVector of eigenvectors).
+
+Parameters:
+
+mata : ngsolve.la.BaseMatrix
+  matrix A
+
+matm : ngsolve.la.BaseMatrix
+  spd matrix M, identity if not given
+
+pre : ngsolve.la.BaseMatrix
+  spd preconditioner for A, e.g. an inverse with freedofs
+
+num : int
+  number of eigenpairs, ignored if initial is given
+
+maxit : int
+  maximal number of iterations
+
+tol : float
+  relative residual for convergence of an eigenpair
+
+printrates : bool
+  print residuals
+
+initial : ngsolve.la.MultiVector
+  initial guesses, overwritten by the eigenvectors. Random vectors
+  smoothed by pre are used if not given.
+)raw_string"));
+
   m.def("ArnoldiSolver", [](shared_ptr<BaseMatrix> mata, shared_ptr<BaseMatrix> matm,
                             shared_ptr<BitArray> freedofs,
-                            py::list vecs, Complex shift)
+                            py::list vecs, Complex shift, shared_ptr<BaseMatrix> inverse,
+                            optional<Complex> inverseshift, int maxrestarts, double tol)
         {
           int nev;
           {
@@ -1452,6 +1620,10 @@ maxsteps : int
             {
               Arnoldi<Complex> arnoldi (mata, matm, freedofs);
               arnoldi.SetShift (shift);
+              if (inverse)
+                arnoldi.SetInverse (inverse, inverseshift.value_or(shift));
+              arnoldi.SetMaxRestarts (maxrestarts);
+              arnoldi.SetTolerance (tol);
               
               Array<shared_ptr<BaseVector>> evecs(nev);
                                                   
@@ -1475,6 +1647,10 @@ maxsteps : int
               if (shift.imag())
                 throw Exception("Only real shifts allowed for real arnoldi");
               arnoldi.SetShift (shift.real());
+              if (inverse)
+                arnoldi.SetInverse (inverse, inverseshift.value_or(shift).real());
+              arnoldi.SetMaxRestarts (maxrestarts);
+              arnoldi.SetTolerance (tol);
               
               Array<shared_ptr<BaseVector>> evecs(nev);
               
@@ -1494,13 +1670,16 @@ maxsteps : int
             }
         },
           py::arg("mata"), py::arg("matm"), py::arg("freedofs"), py::arg("vecs"), py::arg("shift")=DummyArgument(),
+        py::arg("inverse")=nullptr, py::arg("inverseshift")=optional<Complex>(),
+        py::arg("maxrestarts")=20, py::arg("tol")=1e-8,
         py::call_guard<py::gil_scoped_release>(),
         docu_string(R"raw_string(
 Shift-and-invert Arnoldi eigenvalue solver
 
 Solves the generalized linear EVP A*u = M*lam*u using an Arnoldi iteration for the 
-shifted EVP (A-shift*M)^(-1)*M*u = lam*u with a Krylow space of dimension 2*len(vecs)+1.
-len(vecs) eigenpairs with the closest eigenvalues to the shift are returned.
+shifted EVP (A-shift*M)^(-1)*M*u = lam*u with a Krylow space of dimension 2*len(vecs)+1,
+restarted by the Krylov-Schur method. len(vecs) eigenpairs with the closest eigenvalues
+to the shift are returned.
 
 Parameters:
 
@@ -1518,6 +1697,19 @@ vecs : list
 
 shift : object
   complex or real shift
+
+inverse : ngsolve.la.BaseMatrix
+  factorization of (A-inverseshift*M), reused for several shifts instead of
+  factoring A-shift*M
+
+inverseshift : object
+  shift of the given inverse, defaults to shift
+
+maxrestarts : int
+  maximal number of Krylov-Schur restarts
+
+tol : float
+  relative residual of the wanted Schur vectors
 )raw_string"));
   
   
@@ -1525,6 +1717,52 @@ shift : object
   m.def("DoArchive" , [](shared_ptr<Archive> & arch, BaseMatrix & mat)
                                          { cout << "output basematrix" << endl;
                                            mat.DoArchive(*arch); return arch; });
+
+  m.def("SaveBinary", [](py::object obj, string filename)
+        {
+          if (py::isinstance<BaseMatrix>(obj))
+            SaveBinary (py::cast<BaseMatrix&>(obj), filename);
+          else
+            SaveBinary (py::cast<BaseVector&>(obj), filename);
+        }, py::arg("obj"), py::arg("filename"), docu_string(R"raw_string(
+Saves a SparseMatrix or a vector into a binary file, which can be
+loaded by LoadMapped without copying the data.
+)raw_string"));
+
+  m.def("LoadMapped", [](string filename) -> py::object
+        {
+          if (IsMappedMatrixFile (filename))
+            return py::cast (shared_ptr<BaseMatrix> (LoadMappedMatrix (filename)));
+          return py::cast (LoadMappedVector (filename));
+        }, py::arg("filename"), docu_string(R"raw_string(
+Loads a matrix or vector written by SaveBinary by mapping the file
+into memory. The object references the mapped pages, which are shared
+between all processes on a node. Writing into the object makes private
+copies of the written pages, the file is not changed.
+)raw_string"));
+
+  m.def("SinglePrecision", &SinglePrecision, py::arg("mat"), docu_string(R"raw_string(
+Copy of a real SparseMatrix, Jacobi or block-Jacobi preconditioner
+(also from symmetric storage) with the values stored in single
+precision. It is applied to double
+vectors, so it can be used as preconditioner in a double precision
+Krylov solver, with half the memory traffic.
+)raw_string"));
+
+  py::class_<HODLRMatrix, shared_ptr<HODLRMatrix>, BaseMatrix> (m, "HODLRMatrix", docu_string(R"raw_string(
+Hierarchically off-diagonal low-rank compression of a dense square
+matrix. Off-diagonal blocks are approximated by adaptive cross
+approximation and truncated to the relative accuracy tol. Inverse()
+provides a direct solver by recursive Sherman-Morrison-Woodbury.
+)raw_string"))
+    .def(py::init([] (const Matrix<double> & mat, double tol, size_t leafsize)
+                  {
+                    return make_shared<HODLRMatrix> (mat, tol, leafsize);
+                  }),
+         py::arg("mat"), py::arg("tol")=1e-8, py::arg("leafsize")=64)
+    .def_property_readonly("maxrank", &HODLRMatrix::MaxRank, "maximal rank of the off-diagonal blocks")
+    .def_property_readonly("nze", &HODLRMatrix::NZE, "number of stored values")
+    ;
                                            
 }
 
@@ -0,0 +1,377 @@
+/*********************************************************************/
+/* File:   singleprecision.cpp                                       */
+/* Date:   2024                                                      */
+/*********************************************************************/
+
+#include <la.hpp>
+#include "singleprecision.hpp"
+
+namespace ngla
+{
+
+  SparseMatrixFloat :: SparseMatrixFloat (const SparseMatrixTM<double> & mat)
+    : firsti(mat.Height()+1), colnr(mat.NZE()), data(mat.NZE()),
+      width(mat.Width()), symmetric(mat.SymmetricStorage())
+  {
+    firsti.Range(0, firsti.Size()) = mat.GetFirstArray();
+    ParallelForRange (mat.Height(), [&] (IntRange r)
+                      {
+                        for (size_t i : r)
+                          {
+                            auto cols = mat.GetRowIndices(i);
+                            auto vals = mat.GetRowValues(i);
+                            for (size_t j = 0; j < cols.Size(); j++)
+                              {
+                                colnr[firsti[i]+j] = cols[j];
+                                data[firsti[i]+j] = vals(j);
+                              }
+                          }
+                      });
+    tracked.Set (MemoryTracker::MATRIX, data.Size()*sizeof(float));
+  }
+
+  SparseMatrixFloat :: SparseMatrixFloat (Array<size_t> && afirsti, Array<int> && acolnr,
+                                          Array<float> && adata, size_t awidth, bool asymmetric)
+    : firsti(std::move(afirsti)), colnr(std::move(acolnr)), data(std::move(adata)),
+      width(awidth), symmetric(asymmetric)
+  {
+    tracked.Set (MemoryTracker::MATRIX, data.Size()*sizeof(float));
+  }
+
+  AutoVector SparseMatrixFloat :: CreateRowVector () const
+  {
+    return CreateBaseVector (width, false, 1);
+  }
+
+  AutoVector SparseMatrixFloat :: CreateColVector () const
+  {
+    return CreateBaseVector (VHeight(), false, 1);
+  }
+
+  void SparseMatrixFloat :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SparseMatrixFloat::MultAdd");
+    RegionTimer reg(t);
+    PerfRegion perf(t, true);
+    t.AddFlops (2.0*data.Size());
+    PerfCounters::AddBytes (t, data.Size()*(sizeof(float)+sizeof(int)) + firsti.Size()*sizeof(size_t)
+                            + (width+2*VHeight())*sizeof(double));
+
+    FlatVector<> fx = x.FV<double>();
+    FlatVector<> fy = y.FV<double>();
+    size_t h = VHeight();
+
+    if (!symmetric)
+      {
+        ParallelForRange (h, [&] (IntRange r)
+                          {
+                            for (size_t i : r)
+                              {
+                                double sum = 0;
+                                for (size_t j = firsti[i]; j < firsti[i+1]; j++)
+                                  sum += double(data[j]) * fx(colnr[j]);
+                                fy(i) += s * sum;
+                              }
+                          });
+        return;
+      }
+
+    // lower triangle and its transpose, without the diagonal twice.
+    // Rows are split into chunks, the transposed entries with columns
+    // inside the own chunk are added directly. The column indices are
+    // sorted, so the entries reaching into earlier chunks are a prefix
+    // of the row, they are added atomically in a second sweep.
+    size_t nchunks = min2 (h, size_t(4*TaskManager::GetNumThreads()));
+    auto chunk = [&] (size_t k) { return IntRange (k*h/nchunks, (k+1)*h/nchunks); };
+    Array<size_t> firstlocal(h);
+
+    ParallelFor (nchunks, [&] (size_t k)
+                 {
+                   IntRange r = chunk(k);
+                   for (size_t i : r)
+                     {
+                       double sum = 0;
+                       double sxi = s * fx(i);
+                       size_t j = firsti[i];
+                       for ( ; j < firsti[i+1] && colnr[j] < int(r.First()); j++)
+                         sum += double(data[j]) * fx(colnr[j]);
+                       firstlocal[i] = j;
+                       for ( ; j < firsti[i+1]; j++)
+                         {
+                           int col = colnr[j];
+                           sum += double(data[j]) * fx(col);
+                           if (col != int(i))
+                             fy(col) += double(data[j]) * sxi;
+                         }
+                       fy(i) += s * sum;
+                     }
+                 });
+
+    ParallelFor (nchunks, [&] (size_t k)
+                 {
+                   for (size_t i : chunk(k))
+                     {
+                       double sxi = s * fx(i);
+                       for (size_t j = firsti[i]; j < firstlocal[i]; j++)
+                         AtomicAdd (fy(colnr[j]), double(data[j]) * sxi);
+                     }
+                 });
+  }
+
+  void SparseMatrixFloat :: MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("SparseMatrixFloat::MultTransAdd");
+    RegionTimer reg(t);
+
+    if (symmetric)
+      {
+        MultAdd (s, x, y);
+        return;
+      }
+
+    FlatVector<> fx = x.FV<double>();
+    FlatVector<> fy = y.FV<double>();
+    for (size_t i = 0; i < VHeight(); i++)
+      {
+        double sxi = s * fx(i);
+        for (size_t j = firsti[i]; j < firsti[i+1]; j++)
+          fy(colnr[j]) += double(data[j]) * sxi;
+      }
+  }
+
+  Array<MemoryUsage> SparseMatrixFloat :: GetMemoryUsage () const
+  {
+    return { MemoryUsage ("SparseMatrixFloat",
+                          data.Size()*(sizeof(float)+sizeof(int)) + firsti.Size()*sizeof(size_t), 1) };
+  }
+
+
+
+
+  BlockJacobiPrecondFloat :: BlockJacobiPrecondFloat (const BlockJacobiPrecond<double,double,double> & pre)
+    : blocktable(pre.GetBlockTable()), height(pre.Height())
+  {
+    SetParallelDofs (pre.GetParallelDofs());
+    auto inverses = pre.GetInverseBlocks();
+    Setup (pre.GetBlockColoring(), [&] (size_t i, FlatMatrix<float> inv)
+           {
+             inv.AsVector() = inverses[i].AsVector();
+           });
+  }
+
+  BlockJacobiPrecondFloat :: BlockJacobiPrecondFloat (const BlockJacobiPrecondSymmetric<double,double> & pre)
+    : blocktable(pre.GetBlockTable()), height(pre.Height())
+  {
+    SetParallelDofs (pre.GetParallelDofs());
+
+    // the symmetric smoother keeps no coloring: blocks of one color
+    // have disjoint dofs, greedy with 32 colors per sweep
+    size_t nblocks = blocktable->Size();
+    Array<int> coloring(nblocks);
+    coloring = -1;
+    Array<unsigned int> mask(height);
+    int maxcolor = 0;
+    size_t found = 0;
+    for (int basecol = 0; found < nblocks; basecol += 8*sizeof(unsigned int))
+      {
+        mask = 0;
+        for (size_t i = 0; i < nblocks; i++)
+          {
+            if (coloring[i] >= 0) continue;
+            unsigned int check = 0;
+            for (int d : (*blocktable)[i])
+              check |= mask[d];
+            if (check == UINT_MAX) continue;
+
+            unsigned int checkbit = 1;
+            int color = basecol;
+            while (check & checkbit)
+              {
+                color++;
+                checkbit *= 2;
+              }
+            coloring[i] = color;
+            maxcolor = max2 (maxcolor, color);
+            found++;
+            for (int d : (*blocktable)[i])
+              mask[d] |= checkbit;
+          }
+      }
+    TableCreator<int> creator(maxcolor+1);
+    for ( ; !creator.Done(); creator++)
+      for (size_t i = 0; i < nblocks; i++)
+        creator.Add (coloring[i], i);
+    Table<int> block_coloring = creator.MoveTable();
+
+    // the blocks are stored as band Cholesky factors, invert column by column
+    Setup (block_coloring, [&] (size_t i, FlatMatrix<float> inv)
+           {
+             size_t bs = inv.Height();
+             Vector<> e(bs), col(bs);
+             for (size_t j = 0; j < bs; j++)
+               {
+                 e = 0.0;
+                 e(j) = 1;
+                 pre.InvDiag(i).Mult (e, col);
+                 for (size_t k = 0; k < bs; k++)
+                   inv(k,j) = col(k);
+               }
+           });
+  }
+
+  void BlockJacobiPrecondFloat :: Setup (const Table<int> & coloring,
+                                         const function<void(size_t,FlatMatrix<float>)> & inverse)
+  {
+    maxbs = 0;
+    firstblock.SetSize (coloring.Size()+1);
+    firstblock[0] = 0;
+    for (size_t c = 0; c < coloring.Size(); c++)
+      {
+        for (int i : coloring[c])
+          blocks.Append (i);
+        firstblock[c+1] = blocks.Size();
+      }
+
+    firstval.SetSize (blocktable->Size()+1);
+    firstval[0] = 0;
+    for (size_t i = 0; i < blocktable->Size(); i++)
+      {
+        size_t bs = (*blocktable)[i].Size();
+        maxbs = max2(maxbs, bs);
+        firstval[i+1] = firstval[i] + bs*bs;
+      }
+    data.SetSize (firstval.Last());
+
+    ParallelFor (blocktable->Size(), [&] (size_t i)
+                 {
+                   size_t bs = (*blocktable)[i].Size();
+                   if (!bs) return;
+                   inverse (i, FlatMatrix<float> (bs, bs, &data[firstval[i]]));
+                 });
+    tracked.Set (MemoryTracker::PRECONDITIONER, data.Size()*sizeof(float));
+  }
+
+  AutoVector BlockJacobiPrecondFloat :: CreateRowVector () const
+  {
+    return CreateBaseVector (height, false, 1);
+  }
+
+  AutoVector BlockJacobiPrecondFloat :: CreateColVector () const
+  {
+    return CreateBaseVector (height, false, 1);
+  }
+
+  void BlockJacobiPrecondFloat :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("BlockJacobiFloat::MultAdd");
+    RegionTimer reg(t);
+
+    x.Cumulate();
+    y.Cumulate();
+
+    FlatVector<> fx = x.FV<double>();
+    FlatVector<> fy = y.FV<double>();
+
+    for (size_t c = 0; c+1 < firstblock.Size(); c++)
+      {
+        FlatArray<int> colblocks = blocks.Range(firstblock[c], firstblock[c+1]);
+        ParallelForRange (colblocks.Size(), [&] (IntRange r)
+                          {
+                            Vector<> hxmax(maxbs), hymax(maxbs);
+                            for (size_t ii : r)
+                              {
+                                int i = colblocks[ii];
+                                FlatArray<int> block = (*blocktable)[i];
+                                size_t bs = block.Size();
+                                if (!bs) continue;
+
+                                FlatVector<> hx = hxmax.Range(0, bs);
+                                FlatVector<> hy = hymax.Range(0, bs);
+                                for (size_t j = 0; j < bs; j++)
+                                  hx(j) = fx(block[j]);
+                                MultMatVec (FlatMatrix<float> (bs, bs, data.Data()+firstval[i]), hx, hy);
+                                for (size_t j = 0; j < bs; j++)
+                                  fy(block[j]) += s * hy(j);
+                              }
+                          });
+      }
+  }
+
+  void BlockJacobiPrecondFloat :: MultTransAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("BlockJacobiFloat::MultTransAdd");
+    RegionTimer reg(t);
+
+    x.Cumulate();
+    y.Cumulate();
+
+    FlatVector<> fx = x.FV<double>();
+    FlatVector<> fy = y.FV<double>();
+
+    for (size_t c = 0; c+1 < firstblock.Size(); c++)
+      {
+        FlatArray<int> colblocks = blocks.Range(firstblock[c], firstblock[c+1]);
+        ParallelForRange (colblocks.Size(), [&] (IntRange r)
+                          {
+                            for (size_t ii : r)
+                              {
+                                int i = colblocks[ii];
+                                FlatArray<int> block = (*blocktable)[i];
+                                size_t bs = block.Size();
+                                FlatMatrix<float> inv(bs, bs, data.Data()+firstval[i]);
+                                for (size_t k = 0; k < bs; k++)
+                                  {
+                                    double sum = 0;
+                                    for (size_t j = 0; j < bs; j++)
+                                      sum += double(inv(j,k)) * fx(block[j]);
+                                    fy(block[k]) += s * sum;
+                                  }
+                              }
+                          });
+      }
+  }
+
+  Array<MemoryUsage> BlockJacobiPrecondFloat :: GetMemoryUsage () const
+  {
+    return { MemoryUsage ("BlockJacFloat", data.Size()*sizeof(float), blocktable->Size()) };
+  }
+
+
+
+
+  shared_ptr<BaseMatrix> SinglePrecision (shared_ptr<BaseMatrix> mat)
+  {
+    static Timer t("SinglePrecision");
+    RegionTimer reg(t);
+
+    // SparseMatrix<double,Complex,Complex> is applied to complex vectors
+    if (auto spmat = dynamic_pointer_cast<SparseMatrix<double,double,double>> (mat))
+      return make_shared<SparseMatrixFloat> (*spmat);
+
+    if (auto jac = dynamic_pointer_cast<JacobiPrecond<double,double,double>> (mat))
+      {
+        // the inverse diagonal as a sparse matrix
+        auto invdiag = jac->GetInverseDiagonal();
+        size_t n = invdiag.Size();
+        Array<size_t> firsti(n+1);
+        Array<int> colnr(n);
+        Array<float> vals(n);
+        for (size_t i = 0; i < n; i++)
+          {
+            firsti[i] = i;
+            colnr[i] = i;
+            vals[i] = invdiag[i];
+          }
+        firsti[n] = n;
+        return make_shared<SparseMatrixFloat> (std::move(firsti), std::move(colnr), std::move(vals), n);
+      }
+
+    if (auto bjac = dynamic_pointer_cast<BlockJacobiPrecond<double,double,double>> (mat))
+      return make_shared<BlockJacobiPrecondFloat> (*bjac);
+
+    if (auto bjac = dynamic_pointer_cast<BlockJacobiPrecondSymmetric<double,double>> (mat))
+      return make_shared<BlockJacobiPrecondFloat> (*bjac);
+
+    throw Exception ("SinglePrecision: not available for " + string(typeid(*mat).name()));
+  }
+}
@@ -0,0 +1,96 @@
+#ifndef FILE_NGS_SINGLEPRECISION
+#define FILE_NGS_SINGLEPRECISION
+
+/**************************************************************************/
+/* File:   singleprecision.hpp                                            */
+/* Date:   2024                                                           */
+/**************************************************************************/
+
+namespace ngla
+{
+
+  /*
+    Single precision copies of matrices and preconditioners.
+    The values are stored as float, vectors and arithmetic stay double.
+    Applying a bandwidth-bound operator reads half the bytes, which
+    is what counts for a preconditioner inside a double precision
+    Krylov solver.
+  */
+
+
+  /// CSR matrix with float values, for real scalar sparse matrices
+  class NGS_DLL_HEADER SparseMatrixFloat : public BaseMatrix
+  {
+    Array<size_t> firsti;
+    Array<int> colnr;
+    Array<float> data;
+    size_t width;
+    /// only the lower triangle is stored, as in SparseMatrixSymmetric
+    bool symmetric;
+    TrackedMemory tracked;
+  public:
+    /// rounded copy of a SparseMatrix or SparseMatrixSymmetric
+    SparseMatrixFloat (const SparseMatrixTM<double> & mat);
+    SparseMatrixFloat (Array<size_t> && afirsti, Array<int> && acolnr,
+                       Array<float> && adata, size_t awidth, bool asymmetric = false);
+
+    bool IsComplex() const override { return false; }
+    int VHeight() const override { return firsti.Size()-1; }
+    int VWidth() const override { return width; }
+
+    AutoVector CreateRowVector () const override;
+    AutoVector CreateColVector () const override;
+
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    Array<MemoryUsage> GetMemoryUsage () const override;
+  };
+
+
+  /// block-Jacobi preconditioner with float inverse blocks
+  class NGS_DLL_HEADER BlockJacobiPrecondFloat : public BaseMatrix
+  {
+    shared_ptr<Table<int>> blocktable;
+    /// blocks ordered by color, color c is blocks[firstblock[c]] ... blocks[firstblock[c+1]-1]
+    Array<int> blocks;
+    Array<size_t> firstblock;
+    /// inverse of block i starts at data[firstval[i]]
+    Array<size_t> firstval;
+    Array<float> data;
+    size_t height;
+    size_t maxbs;
+    TrackedMemory tracked;
+  public:
+    BlockJacobiPrecondFloat (const BlockJacobiPrecond<double,double,double> & pre);
+    /// the band Cholesky factors of the blocks are inverted
+    BlockJacobiPrecondFloat (const BlockJacobiPrecondSymmetric<double,double> & pre);
+
+    bool IsComplex() const override { return false; }
+    int VHeight() const override { return height; }
+    int VWidth() const override { return height; }
+
+    AutoVector CreateRowVector () const override;
+    AutoVector CreateColVector () const override;
+
+    void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+    void MultTransAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    Array<MemoryUsage> GetMemoryUsage () const override;
+
+  protected:
+    /// block orders and storage, inverse(i, inv) fills the inverse of block i
+    void Setup (const Table<int> & coloring,
+                const function<void(size_t,FlatMatrix<float>)> & inverse);
+  };
+
+
+  /**
+     Single precision version of a SparseMatrix, a JacobiPrecond or a
+     (symmetric) BlockJacobiPrecond with real scalar entries. Throws for
+     other matrices.
+  */
+  NGS_DLL_HEADER shared_ptr<BaseMatrix> SinglePrecision (shared_ptr<BaseMatrix> mat);
+}
+
+#endif
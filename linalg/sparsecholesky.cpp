@@ -22,6 +22,8 @@ namespace ngla
   
   static TQueue queue;
 
+  SparseCholeskyOutOfCore cholesky_outofcore;
+
 
   template <typename TFUNC>
   void RunParallelDependency (const Table<int> & dag,
@@ -232,14 +234,7 @@ namespace ngla
     mdo = 0;
 
     diag.SetSize(nused);
-    // lfact.SetSize (nze);
-    lfact = NumaInterleavedArray<TM> (nze);
-
-    // lfact = TM(0.0);     // first touch
-    ParallelForRange (nze, [&] (IntRange r)
-                      {
-                        lfact.Range(r) = TM(0.0);
-                      });
+    AllocateFactor();
     
     endtime = clock();
     if (printstat)
@@ -514,6 +509,68 @@ namespace ngla
 
 
 
+  template <class TM>
+  void SparseCholeskyTM<TM> :: AllocateFactor ()
+  {
+    size_t bytes = nze*sizeof(TM);
+    if (cholesky_outofcore.memory_budget && bytes > cholesky_outofcore.memory_budget)
+      {
+        // the file starts with zeros
+        lfact_file = make_unique<ScratchFile> (bytes, cholesky_outofcore.directory,
+                                               cholesky_outofcore.memory_budget);
+        lfact.Assign (FlatArray<TM,size_t> (nze, reinterpret_cast<TM*> (lfact_file->Data())));
+        TrackMemory();
+        return;
+      }
+
+    // lfact.SetSize (nze);
+    lfact_mem = NumaInterleavedArray<TM> (nze);
+    lfact.Assign (lfact_mem);
+
+    // lfact = TM(0.0);     // first touch
+    ParallelForRange (nze, [&] (IntRange r)
+                      {
+                        lfact.Range(r) = TM(0.0);
+                      });
+    TrackMemory();
+  }
+
+  template <class TM>
+  void SparseCholeskyTM<TM> :: TrackMemory ()
+  {
+    size_t entries = diag.Size() + selinv.Size() + selinv_diag.Size();
+    if (!lfact_file)
+      entries += nze;
+    tracked.Set (MemoryTracker::FACTORIZATION, entries*sizeof(TM) + IndexBytes());
+  }
+
+  template <class TM>
+  void SparseCholeskyTM<TM> :: ClearFactor ()
+  {
+    if (lfact_file)
+      lfact_file->Clear();
+    else
+      lfact = TM(0.0);
+  }
+
+  template <class TM>
+  void SparseCholeskyTM<TM> :: PrefetchPanels (int bnr, bool forward) const
+  {
+    if (!lfact_file) return;
+    // half of the budget for read-ahead
+    size_t window = cholesky_outofcore.memory_budget / 2;
+    size_t first = firstinrow[blocks[bnr]] * sizeof(TM);
+    size_t next = firstinrow[blocks[bnr+1]] * sizeof(TM);
+    if (forward)
+      lfact_file->Prefetch (first, window);
+    else
+      {
+        size_t lo = next > window ? next-window : 0;
+        lfact_file->Prefetch (lo, next-lo);
+      }
+  }
+
+
   template <class TM>
   void SparseCholeskyTM<TM> :: 
   FactorNew (const SparseMatrix<TM> & a)
@@ -525,7 +582,8 @@ namespace ngla
 	cout << IM(4) << "SparseCholesky::FactorNew called with matrix of different size." << endl;
 	return;
       }
-    lfact = TM(0.0);
+    ClearFactor();
+    selinv_valid = false;
 
     if (!inner && !cluster)
       ParallelFor 
@@ -581,6 +639,7 @@ namespace ngla
     static Timer timerc("SparseCholesky::Factor - C", 3);
 
     RegionTimer reg (factor_timer);
+    PerfRegion perf(factor_timer, true);
 
     
     int n = nused; // Height();
@@ -940,6 +999,7 @@ namespace ngla
     // static Timer timerc2("SparseCholesky::Factor - merge2", 2);
 
     RegionTimer reg (factor_timer);
+    PerfRegion perf(factor_timer, true);
     
     size_t n = nused; // Height();
     if (n > 2000){
@@ -1461,8 +1521,23 @@ namespace ngla
             }, num_other > 50 ? TasksPerThread(1) : 1);  
           
         }
-        
+
+        if (lfact_file)
+          {
+            // the panel is final: scale it now, and hand it over to the write-back
+            for (auto i : block)
+              {
+                TM ai = diag[i];
+                for (auto j : Range(hfirstinrow[i], hfirstinrow[i+1]))
+                  lfact[j] = lfact[j] * ai;
+              }
+            size_t first = hfirstinrow[block.First()];
+            lfact_file->Release (first*sizeof(TM), (hfirstinrow[block.Next()]-first)*sizeof(TM));
+          }
        });
+    bool panels_scaled = lfact_file != nullptr;
+#else
+    bool panels_scaled = false;
 #endif
 
 
@@ -1480,12 +1555,15 @@ namespace ngla
           lfact[j] = lfact[j] * ai;
       }
     */
-    ParallelFor (n, [&] (size_t i)
-      {
-        TM ai = diag[i];
-        for (auto j : Range(hfirstinrow[i], hfirstinrow[i+1]))
-          lfact[j] = lfact[j] * ai;
-      }, TasksPerThread(5));
+    if (!panels_scaled)
+      ParallelFor (n, [&] (size_t i)
+        {
+          TM ai = diag[i];
+          for (auto j : Range(hfirstinrow[i], hfirstinrow[i+1]))
+            lfact[j] = lfact[j] * ai;
+        }, TasksPerThread(5));
+    if (lfact_file)
+      lfact_file->Flush();
 
     if (n > 2000){
       cout << IM(4) << endl;
@@ -1715,6 +1793,8 @@ namespace ngla
     */
     timer1.Start();
 
+    if (lfact_file)
+      lfact_file->ResetPrefetch();
     RunParallelDependency (micro_dependency, micro_dependency_trans,
                            [&,hy] (int nr) 
                            {
@@ -1722,6 +1802,8 @@ namespace ngla
                              size_t blocknr = task.blocknr;
                              auto range = BlockDofs (blocknr);
                              if (range.Size()==0) return;
+                             if (task.type != MicroTask::B_BLOCK)
+                               PrefetchPanels (blocknr, true);
                              
                              // if (task.solveL)
                              if (task.type == MicroTask::LB_BLOCK)
@@ -1827,6 +1909,8 @@ namespace ngla
     */
 
     // advanced parallel version 
+    if (lfact_file)
+      lfact_file->ResetPrefetch();
     RunParallelDependency (micro_dependency_trans, micro_dependency,
                            [&,hy] (int nr) 
                            {
@@ -1834,6 +1918,8 @@ namespace ngla
                              int blocknr = task.blocknr;
                              auto range = BlockDofs (blocknr);
                              if (range.Size()==0) return;
+                             if (task.type != MicroTask::B_BLOCK)
+                               PrefetchPanels (blocknr, false);
                              
                              if (task.type == MicroTask::LB_BLOCK)
                                { // first B then L
@@ -1926,7 +2012,10 @@ namespace ngla
   {
     static Timer timer("SparseCholesky<d,d,d>::MultAdd");
     RegionTimer reg (timer);
+    PerfRegion perf(timer, true);
     timer.AddFlops (2.0*lfact.Size());
+    // the factor is read twice (forward and backward)
+    PerfCounters::AddBytes (timer, 2.0*lfact.Size()*(sizeof(TM)+sizeof(int)));
 
     // int n = Height();
     
@@ -2018,6 +2107,89 @@ namespace ngla
 
 
 
+  template <class TM, class TV_ROW, class TV_COL>
+  void SparseCholesky<TM, TV_ROW, TV_COL> :: 
+  SolveSparse (FlatArray<int> rhsdofs, const BaseVector & f,
+               FlatArray<int> soldofs, BaseVector & u) const
+  {
+    static Timer t("SparseCholesky::SolveSparse");
+    RegionTimer reg(t);
+
+    const FlatVector<TVX> ff = f.FV<TVX> ();
+    FlatVector<TVX> fu = u.FV<TVX> ();
+
+    Array<int> fwblocks = ReachableBlocks (rhsdofs);
+    Array<int> bwblocks;
+    if (soldofs.Size())
+      bwblocks = ReachableBlocks (soldofs);
+    else
+      for (size_t b = 0; b+1 < blocks.Size(); b++)
+        bwblocks.Append (b);
+
+    Vector<TVX> hy(this->nused);
+    for (auto bl : { &fwblocks, &bwblocks })
+      for (int b : *bl)
+        hy.Range(BlockDofs(b)) = TVX(0.0);
+    for (int dof : rhsdofs)
+      if (UsedDof(dof))
+        hy(order[dof]) = ff(dof);
+
+    // forward, only the blocks reached from the right hand side are non-zero
+    for (int b : fwblocks)
+      {
+        auto range = BlockDofs (b);
+        if (range.Size() == 0) continue;
+        auto extdofs = BlockExtDofs (b);
+        for (auto i : range)
+          {
+            size_t inblock = range.end()-i-1;
+            FlatVector<TM> col(inblock+extdofs.Size(), lfact.Data()+firstinrow[i]);
+            TVX hyi = hy(i);
+            for (size_t j = 0; j < inblock; j++)
+              hy(i+1+j) -= Trans(col(j)) * hyi;
+            for (size_t j = 0; j < extdofs.Size(); j++)
+              hy(extdofs[j]) -= Trans(col(inblock+j)) * hyi;
+          }
+        for (auto i : range)
+          {
+            TVX tmp = diag[i] * hy(i);
+            hy(i) = tmp;
+          }
+      }
+
+    // backward, only the blocks needed for the requested dofs
+    for (size_t k = bwblocks.Size(); k-- > 0; )
+      {
+        auto range = BlockDofs (bwblocks[k]);
+        if (range.Size() == 0) continue;
+        auto extdofs = BlockExtDofs (bwblocks[k]);
+        for (size_t i = range.end(); i-- > range.begin(); )
+          {
+            size_t inblock = range.end()-i-1;
+            FlatVector<TM> col(inblock+extdofs.Size(), lfact.Data()+firstinrow[i]);
+            TVX val(0.0);
+            for (size_t j = 0; j < inblock; j++)
+              val += col(j) * hy(i+1+j);
+            for (size_t j = 0; j < extdofs.Size(); j++)
+              val += col(inblock+j) * hy(extdofs[j]);
+            hy(i) -= val;
+          }
+      }
+
+    if (soldofs.Size())
+      {
+        for (int dof : soldofs)
+          if (UsedDof(dof))
+            fu(dof) = hy(order[dof]);
+      }
+    else
+      for (int dof = 0; dof < height; dof++)
+        if (UsedDof(dof))
+          fu(dof) = hy(order[dof]);
+  }
+
+
+
   SparseFactorization ::     
   SparseFactorization (const BaseSparseMatrix & amatrix,
 		       shared_ptr<BitArray> ainner,
@@ -2124,6 +2296,434 @@ namespace ngla
   }
 
 
+  template <class TM>
+  void SparseCholeskyTM<TM> :: CalcSelectedInverse ()
+  {
+    static Timer t("SparseCholesky::SelectedInverse");
+    RegionTimer reg(t);
+
+    if constexpr (!is_same<TM,double>::value && !is_same<TM,Complex>::value)
+      throw Exception ("SparseCholesky::CalcSelectedInverse: only for scalar entries");
+    else
+      {
+        /*
+          A = L D L^T with unit lower L, Z = A^-1 satisfies
+            Z(j,i) = - sum_{k in struct(i)} Z(j,k) L(k,i),      j in struct(i)
+            Z(i,i) = D^-1(i) - sum_{k in struct(i)} L(k,i) Z(k,i)
+          The rows struct(i) form a clique, so only entries in the
+          pattern of L are needed. Blocks are processed from the root
+          down, a block needs the finished blocks of its external dofs.
+        */
+        if (lfact_file)
+          throw Exception ("SparseCholesky::CalcSelectedInverse: not available for an out-of-core factor, "
+                           "the selected inverse needs as much memory as the factor");
+        selinv.SetSize (nze);
+        selinv_diag.SetSize (nused);
+        TrackMemory();
+
+        TableCreator<int> creator_trans(block_dependency.Size());
+        for ( ; !creator_trans.Done(); creator_trans++)
+          for (int i : Range(block_dependency))
+            for (int j : block_dependency[i])
+              creator_trans.Add(j, i);
+        auto block_dep_trans = creator_trans.MoveTable();
+
+        RunParallelDependency
+          (block_dep_trans, block_dependency, [&] (int bnr)
+           {
+             IntRange range = BlockDofs(bnr);
+             if (range.Size() == 0) return;
+             auto ext = BlockExtDofs(bnr);
+             size_t m = range.Size(), nk = m + ext.Size();
+
+             // local numbering: block dofs, then external dofs
+             Matrix<TM> z(nk, nk);
+             for (size_t a = 0; a < ext.Size(); a++)
+               {
+                 z(m+a, m+a) = selinv_diag[ext[a]];
+                 // row indices of a column are sorted, and contain the later external dofs
+                 size_t pos = firstinrow[ext[a]], pos_ri = firstinrow_ri[ext[a]];
+                 for (size_t b = a+1; b < ext.Size(); b++)
+                   {
+                     while (rowindex2[pos_ri] != ext[b])
+                       {
+                         pos++;
+                         pos_ri++;
+                       }
+                     z(m+b, m+a) = z(m+a, m+b) = selinv[pos];
+                   }
+               }
+
+             for (size_t i = m; i-- > 0; )
+               {
+                 size_t row = range.First()+i;
+                 size_t s = nk-i-1;
+                 FlatVector<TM> l(s, lfact.Data()+firstinrow[row]);
+                 FlatVector<TM> zl(s, selinv.Data()+firstinrow[row]);
+                 zl = -z.Rows(i+1, nk).Cols(i+1, nk) * l;
+
+                 TM sum = 0.0;
+                 for (size_t k = 0; k < s; k++)
+                   {
+                     z(i+1+k, i) = z(i, i+1+k) = zl(k);
+                     sum += l(k) * zl(k);
+                   }
+                 z(i,i) = diag[row] - sum;
+                 selinv_diag[row] = z(i,i);
+               }
+           });
+        selinv_valid = true;
+      }
+  }
+
+  template <class TM>
+  Array<TM> SparseCholeskyTM<TM> :: InverseDiagonal ()
+  {
+    if (!selinv_valid)
+      CalcSelectedInverse();
+    Array<TM> d(height);
+    for (int i = 0; i < height; i++)
+      d[i] = order[i] != -1 ? selinv_diag[order[i]] : TM(0.0);
+    return d;
+  }
+
+  template <class TM>
+  TM SparseCholeskyTM<TM> :: InverseEntry (int i, int j)
+  {
+    if (!selinv_valid)
+      CalcSelectedInverse();
+    int oi = order[i], oj = order[j];
+    if (oi == -1 || oj == -1)
+      return TM(0.0);
+    if (oi == oj)
+      return selinv_diag[oi];
+    if (oi > oj) swap (oi, oj);
+
+    for (size_t k = firstinrow[oi], k_ri = firstinrow_ri[oi]; k < firstinrow[oi+1]; k++, k_ri++)
+      if (rowindex2[k_ri] == oj)
+        return selinv[k];
+    throw Exception ("SparseCholesky::InverseEntry: (" + ToString(i) + "," + ToString(j)
+                     + ") is not in the pattern of the factor");
+  }
+
+
+  template <class TM>
+  Array<int> SparseCholeskyTM<TM> :: ReachableBlocks (FlatArray<int> dofs) const
+  {
+    size_t nblocks = blocks.Size()-1;
+    BitArray marked(nblocks);
+    marked.Clear();
+    Array<int> result, stack;
+    for (int dof : dofs)
+      if (UsedDof(dof))
+        {
+          int b = std::upper_bound (blocks.Data(), blocks.Data()+blocks.Size(), order[dof]) - blocks.Data() - 1;
+          if (!marked.Test(b)) { marked.SetBit(b); stack.Append(b); }
+        }
+    while (stack.Size())
+      {
+        int b = stack.Last();
+        stack.DeleteLast();
+        result.Append (b);
+        for (int b2 : block_dependency[b])
+          if (!marked.Test(b2)) { marked.SetBit(b2); stack.Append(b2); }
+      }
+    QuickSort (result);
+    return result;
+  }
+
+
+  template <class TM>
+  void SparseCholeskyTM<TM> :: UpdateLowRank (FlatArray<int> dofs, FlatMatrix<TSCAL_MAT> w, double sigma)
+  {
+    static Timer t("SparseCholesky::UpdateLowRank");
+    RegionTimer reg(t);
+
+    if constexpr (!is_same<TM,double>::value && !is_same<TM,Complex>::value)
+      throw Exception ("SparseCholesky::UpdateLowRank: only for scalar entries");
+    else
+      {
+        if (w.Height() != dofs.Size())
+          throw Exception ("SparseCholesky::UpdateLowRank: w needs one row per dof");
+
+        /*
+          Rank-1 modification A + alpha w w^T of A = L D L^T, one column
+          of W after the other (Gill, Golub, Murray, Saunders, method C1).
+          Column j of L changes only if w(j) is non-zero when j is
+          reached, these are the columns on the elimination tree paths
+          from the dofs to the root.
+        */
+        Array<int> rdofs, rows;
+        for (size_t k = 0; k < dofs.Size(); k++)
+          if (UsedDof(dofs[k]))
+            {
+              rdofs.Append (order[dofs[k]]);
+              rows.Append (k);
+            }
+        Array<int> sorted_rdofs;
+        sorted_rdofs = rdofs;
+        QuickSort (sorted_rdofs);
+        Array<int> path = ReachableBlocks (dofs);
+
+        Vector<TM> hw(nused);
+        BitArray nonzero(nused);
+        nonzero.Clear();
+
+        for (size_t c = 0; c < w.Width(); c++)
+          {
+            for (int b : path)
+              hw.Range(BlockDofs(b)) = TM(0.0);
+            for (size_t k = 0; k < rdofs.Size(); k++)
+              hw(rdofs[k]) += w(rows[k], c);
+
+            // symbolic pass, the factor must not get fill-in. The
+            // non-zeros produced by column j are in the pattern of the
+            // later columns, only the entries of w itself can be outside
+            for (int r : rdofs)
+              if (hw(r) != TM(0.0))
+                nonzero.SetBit(r);
+            for (int b : path)
+              for (int j : BlockDofs(b))
+                {
+                  if (!nonzero.Test(j)) continue;
+                  size_t len = firstinrow[j+1]-firstinrow[j];
+                  FlatArray<int> cols = rowindex2.Range(firstinrow_ri[j], firstinrow_ri[j]+len);
+                  size_t pos = 0;
+                  for (int r : sorted_rdofs)
+                    {
+                      if (r <= j || !nonzero.Test(r)) continue;
+                      while (pos < len && cols[pos] < r) pos++;
+                      if (pos == len || cols[pos] != r)
+                        {
+                          for (int b2 : path)
+                            for (int i : BlockDofs(b2))
+                              nonzero.Clear(i);
+                          throw Exception ("SparseCholesky::UpdateLowRank: the update leaves the pattern of the factor");
+                        }
+                    }
+                  for (int r : cols)
+                    nonzero.SetBit(r);
+                }
+            for (int b : path)
+              for (int i : BlockDofs(b))
+                nonzero.Clear(i);
+
+            TM alpha = sigma;
+            for (int b : path)
+              for (int j : BlockDofs(b))
+                {
+                  TM p = hw(j);
+                  if (p == TM(0.0)) continue;
+
+                  size_t first = firstinrow[j], len = firstinrow[j+1]-first;
+                  FlatArray<int> cols = rowindex2.Range(firstinrow_ri[j], firstinrow_ri[j]+len);
+                  FlatVector<TM> l(len, lfact.Data()+first);
+
+                  // diag holds D^-1
+                  TM dj = TM(1.0) / diag[j];
+                  TM dbar = dj + alpha * p * p;
+                  if (dbar == TM(0.0))
+                    throw Exception ("SparseCholesky::UpdateLowRank: the downdate makes the matrix singular");
+                  TM beta = p * alpha / dbar;
+                  alpha *= dj / dbar;
+                  for (size_t k = 0; k < len; k++)
+                    {
+                      hw(cols[k]) -= p * l(k);
+                      l(k) += beta * hw(cols[k]);
+                    }
+                  diag[j] = TM(1.0) / dbar;
+                }
+          }
+        selinv_valid = false;
+      }
+  }
+
+
+  template <class TM>
+  void SparseCholeskyTM<TM> :: FactorPartial (const SparseMatrix<TM> & a, FlatArray<int> changed)
+  {
+    static Timer t("SparseCholesky::FactorPartial");
+    RegionTimer reg(t);
+
+    if constexpr (!is_same<TM,double>::value && !is_same<TM,Complex>::value)
+      throw Exception ("SparseCholesky::FactorPartial: only for scalar entries");
+    else
+      {
+        if (height != a.Height())
+          throw Exception ("SparseCholesky::FactorPartial: matrix of different size");
+        selinv_valid = false;
+
+        /*
+          A changed entry A(r,c) goes to column min(r,c) of L. The columns
+          outside of the paths from these columns to the root (set S) do
+          not see the change. The S columns are reset to A, the unchanged
+          columns add their Schur complement updates, and the S blocks
+          are factored again in ascending order.
+        */
+        BitArray ischanged(height);
+        ischanged.Clear();
+        Array<int> seeds;
+        for (int r : changed)
+          {
+            ischanged.SetBit(r);
+            seeds.Append (r);
+            for (int c : a.GetRowIndices(r))
+              seeds.Append (c);
+          }
+        if (a.SymmetricStorage())
+          for (int r = 0; r < height; r++)
+            if (!ischanged.Test(r))
+              for (int c : a.GetRowIndices(r))
+                if (ischanged.Test(c))
+                  {
+                    seeds.Append (r);
+                    break;
+                  }
+
+        Array<int> sblocks = ReachableBlocks (seeds);
+        if (sblocks.Size() == 0) return;
+
+        BitArray sdof(nused), sblock(blocks.Size()-1);
+        sdof.Clear();
+        sblock.Clear();
+        for (int b : sblocks)
+          {
+            sblock.SetBit(b);
+            for (int i : BlockDofs(b))
+              {
+                sdof.SetBit(i);
+                diag[i] = TM(0.0);
+                for (size_t k = firstinrow[i]; k < firstinrow[i+1]; k++)
+                  lfact[k] = TM(0.0);
+              }
+          }
+
+        // entries of a in the S columns, same filters as FactorNew
+        auto couple = [&] (int i, int col)
+          {
+            if (inner) return inner->Test(i) && inner->Test(col);
+            if (cluster) return (*cluster)[i] == (*cluster)[col] && (*cluster)[i] != 0;
+            return true;
+          };
+        for (int b : sblocks)
+          for (int i : BlockDofs(b))
+            {
+              int d = inv_order[i];
+              auto rowind = a.GetRowIndices(d);
+              auto rowvals = a.GetRowValues(d);
+              for (size_t k = 0; k < rowind.Size(); k++)
+                {
+                  int col = rowind[k];
+                  if (col <= d && UsedDof(col) && couple(d, col) && sdof.Test(order[col]))
+                    SetOrig (d, col, rowvals[k]);
+                }
+            }
+
+        // diag(rows) and L(rows,rows) -= upd, rows are sorted and in the pattern
+        auto subtract = [&] (FlatArray<int> rows, FlatMatrix<TM> upd)
+          {
+            for (size_t k = 0; k < rows.Size(); k++)
+              {
+                diag[rows[k]] -= upd(k,k);
+                size_t pos = firstinrow[rows[k]], pos_ri = firstinrow_ri[rows[k]];
+                for (size_t l = k+1; l < rows.Size(); l++)
+                  {
+                    while (rowindex2[pos_ri] != rows[l])
+                      {
+                        pos++;
+                        pos_ri++;
+                      }
+                    lfact[pos] -= upd(l,k);
+                  }
+              }
+          };
+
+        // Schur complement updates of the unchanged blocks
+        for (size_t b = 0; b+1 < blocks.Size(); b++)
+          {
+            if (sblock.Test(b)) continue;
+            auto range = BlockDofs(b);
+            if (range.Size() == 0) continue;
+            auto ext = BlockExtDofs(b);
+            Array<int> sel, srows;
+            for (size_t k = 0; k < ext.Size(); k++)
+              if (sdof.Test(ext[k]))
+                {
+                  sel.Append (k);
+                  srows.Append (ext[k]);
+                }
+            if (sel.Size() == 0) continue;
+
+            size_t m = range.Size();
+            Matrix<TM> lb(sel.Size(), m), dlb(sel.Size(), m);
+            for (size_t i = 0; i < m; i++)
+              {
+                size_t row = range.First()+i;
+                size_t inblock = m-i-1;
+                TM di = TM(1.0) / diag[row];
+                for (size_t k = 0; k < sel.Size(); k++)
+                  {
+                    lb(k,i) = lfact[firstinrow[row]+inblock+sel[k]];
+                    dlb(k,i) = di * lb(k,i);
+                  }
+              }
+            Matrix<TM> upd = lb * Trans(dlb);
+            subtract (srows, upd);
+          }
+
+        // dense L D L^T of the S blocks, the Schur complement goes to the external dofs
+        for (int b : sblocks)
+          {
+            auto range = BlockDofs(b);
+            if (range.Size() == 0) continue;
+            auto ext = BlockExtDofs(b);
+            size_t m = range.Size(), nk = m + ext.Size();
+            size_t i0 = range.First();
+
+            // local numbering: block dofs, then external dofs
+            Matrix<TM> f(nk, m);
+            Vector<TM> d(m);
+            for (size_t i = 0; i < m; i++)
+              {
+                f(i,i) = diag[i0+i];
+                for (size_t k = i+1; k < nk; k++)
+                  f(k,i) = lfact[firstinrow[i0+i]+k-i-1];
+              }
+
+            for (size_t i = 0; i < m; i++)
+              {
+                d(i) = f(i,i);
+                if (d(i) == TM(0.0))
+                  throw Exception ("SparseCholesky::FactorPartial: zero pivot");
+                TM invdi = TM(1.0) / d(i);
+                for (size_t k = i+1; k < nk; k++)
+                  f(k,i) *= invdi;
+                for (size_t j = i+1; j < m; j++)
+                  {
+                    TM lji = d(i) * f(j,i);
+                    for (size_t k = j; k < nk; k++)
+                      f(k,j) -= f(k,i) * lji;
+                  }
+                diag[i0+i] = invdi;
+                for (size_t k = i+1; k < nk; k++)
+                  lfact[firstinrow[i0+i]+k-i-1] = f(k,i);
+              }
+
+            if (ext.Size() == 0) continue;
+            Matrix<TM> dlb(ext.Size(), m);
+            for (size_t k = 0; k < ext.Size(); k++)
+              for (size_t i = 0; i < m; i++)
+                dlb(k,i) = d(i) * f(m+k,i);
+            Matrix<TM> upd = f.Rows(m, nk) * Trans(dlb);
+            subtract (ext, upd);
+          }
+
+        if (lfact_file)
+          lfact_file->Flush();
+      }
+  }
+
+
   template <class TM>
   const TM & SparseCholeskyTM<TM> :: Get (int i, int j) const
   {
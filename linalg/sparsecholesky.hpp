@@ -14,6 +14,19 @@
 namespace ngla
 {
 
+  /// storage of sparse Cholesky factors which do not fit into memory
+  struct SparseCholeskyOutOfCore
+  {
+    /// factors larger than this (in bytes) go to a scratch file, 0 = never.
+    /// Finished parts of the factor stay in memory up to the budget
+    size_t memory_budget = 0;
+    /// directory for the scratch files, should be a local disk
+    string directory = "/tmp";
+  };
+
+  extern NGS_DLL_HEADER SparseCholeskyOutOfCore cholesky_outofcore;
+
+
   class NGS_DLL_HEADER SparseFactorization : public BaseMatrix
   { 
   protected:
@@ -75,7 +88,16 @@ namespace ngla
     
     // L-factor in compressed storage
     // Array<TM, size_t> lfact;
-    NumaInterleavedArray<TM> lfact;
+    FlatArray<TM, size_t> lfact;
+    // the memory of lfact, one of them is used
+    NumaInterleavedArray<TM> lfact_mem;
+    unique_ptr<ScratchFile> lfact_file;
+
+    // selected inverse: entries of A^-1 in the pattern of L (same layout
+    // as lfact), and the diagonal, in the reordered numbering
+    Array<TM> selinv;
+    Array<TM> selinv_diag;
+    bool selinv_valid = false;
 
     // index-array to lfact
     Array<size_t> firstinrow;
@@ -125,6 +147,8 @@ namespace ngla
     // the original matrix
     const SparseMatrixTM<TM> & mat;
 
+    TrackedMemory tracked;
+
   public:
     typedef typename mat_traits<TM>::TSCAL TSCAL_MAT;
 
@@ -160,6 +184,25 @@ namespace ngla
     }
     ///
     void FactorNew (const SparseMatrix<TM> & a);
+    /**
+       Refactorization after the entries of a in the rows and columns
+       changed (original numbering) have been modified within the
+       pattern. Only the supernodes on the elimination tree paths from
+       the changed dofs to the root are recomputed. Scalar entries only.
+    */
+    void FactorPartial (const SparseMatrix<TM> & a, FlatArray<int> changed);
+    void UpdatePartial (FlatArray<int> changed)
+    {
+      auto castmatrix = dynamic_pointer_cast<SparseMatrix<TM>>(matrix.lock());
+      FactorPartial (*castmatrix, changed);
+    }
+    /**
+       Rank-k modification of the factor to A + sigma W W^T, sigma = 1
+       (update) or -1 (downdate). Row k of w belongs to dofs[k] (original
+       numbering). The modification must stay within the pattern of the
+       factor. Scalar entries only.
+    */
+    void UpdateLowRank (FlatArray<int> dofs, FlatMatrix<TSCAL_MAT> w, double sigma);
 
     /**
        A = L+D+L^T
@@ -174,10 +217,24 @@ namespace ngla
 
     virtual Array<MemoryUsage> GetMemoryUsage () const
     {
-      return { MemoryUsage ("SparseChol", nze*sizeof(TM), 1) };
+      Array<MemoryUsage> mu =
+        { MemoryUsage (lfact_file ? "SparseChol (file)" : "SparseChol", nze*sizeof(TM), 1),
+          MemoryUsage ("SparseChol diag", diag.Size()*sizeof(TM), 1),
+          MemoryUsage ("SparseChol indices", IndexBytes(), 6) };
+      if (selinv.Size())
+        mu.Append (MemoryUsage ("SparseChol selinv", (selinv.Size()+selinv_diag.Size())*sizeof(TM), 2));
+      return mu;
+    }
+
+    size_t IndexBytes () const
+    {
+      return (firstinrow.Size() + firstinrow_ri.Size()) * sizeof(size_t)
+        + (rowindex2.Size() + order.Size() + inv_order.Size() + blocknrs.Size()) * sizeof(int);
     }
 
     virtual size_t NZE () const { return nze; }
+    /// is the factor stored in a scratch file ?
+    bool IsOutOfCore () const { return lfact_file != nullptr; }
     ///
     void Set (int i, int j, const TM & val);
     ///
@@ -186,6 +243,19 @@ namespace ngla
     void SetOrig (int i, int j, const TM & val)
     { Set (order[i], order[j], val); }
 
+    /**
+       Selected inversion (Takahashi equations): the entries of A^-1 in
+       the pattern of the factor, supernode by supernode from the root
+       down. Costs about as much as the factorization, scalar entries
+       only. The result takes as much memory as the factor, in core, so
+       it is not available for an out-of-core factor.
+    */
+    void CalcSelectedInverse ();
+    /// diagonal of A^-1, original numbering, 0 for unused dofs
+    Array<TM> InverseDiagonal ();
+    /// entry of A^-1, original numbering. Throws if (i,j) is not in the pattern of the factor
+    TM InverseEntry (int i, int j);
+
 
     // the dofs of block bnr
     IntRange BlockDofs (int bnr) const { return Range(blocks[bnr], blocks[bnr+1]); }
@@ -198,6 +268,27 @@ namespace ngla
       auto ext_size =  firstinrow[range.First()+1]-firstinrow[range.First()] - range.Size()+1;
       return rowindex2.Range(base, base+ext_size);
     }
+
+  protected:
+    // dof is eliminated by the factorization
+    bool UsedDof (int dof) const
+    {
+      if (order[dof] == -1) return false;
+      if (inner && !inner->Test(dof)) return false;
+      if (cluster && !(*cluster)[dof]) return false;
+      return true;
+    }
+    // blocks on the elimination tree paths from the blocks of dofs
+    // (original numbering) to the root, ascending
+    Array<int> ReachableBlocks (FlatArray<int> dofs) const;
+
+    void AllocateFactor ();
+    // factor, selected inverse and indices, in core
+    void TrackMemory ();
+    // lfact = 0
+    void ClearFactor ();
+    // out-of-core: read ahead the panels following (or preceding) block bnr
+    void PrefetchPanels (int bnr, bool forward) const;
   };
 
 
@@ -216,6 +307,8 @@ namespace ngla
     using BASE::cluster;
 
     using BASE::lfact;
+    using BASE::lfact_file;
+    using BASE::PrefetchPanels;
     using BASE::diag;
     using BASE::order;
     using BASE::inv_order;
@@ -229,6 +322,10 @@ namespace ngla
     using BASE::block_dependency;
     using BASE::BlockDofs;
     using BASE::BlockExtDofs;
+    using BASE::firstinrow_ri;
+    using BASE::rowindex2;
+    using BASE::UsedDof;
+    using BASE::ReachableBlocks;
   public:
     typedef TV_COL TV;
     typedef TV_ROW TVX;
@@ -259,6 +356,15 @@ namespace ngla
 
     void SolveBlock (int i, FlatVector<TV> hy) const;
     void SolveBlockT (int i, FlatVector<TV> hy) const;
+
+    /**
+       u(soldofs) = A^-1 f for f vanishing outside of rhsdofs (original
+       numbering). Only the blocks on the elimination tree paths from
+       rhsdofs (forward) and soldofs (backward) to the root are visited,
+       other entries of u are not changed. Empty soldofs = all dofs.
+    */
+    void SolveSparse (FlatArray<int> rhsdofs, const BaseVector & f,
+                      FlatArray<int> soldofs, BaseVector & u) const;
   private:
     void SolveReordered(FlatVector<TVX> hy) const;
   };
@@ -72,6 +72,7 @@ namespace ngla
     colnr[nze] = 0;
 
     CalcBalancing ();
+    TrackMemory ();
   }
                                                                                                                                                                                                                   
   MatrixGraph :: MatrixGraph (int as, int max_elsperrow) 
@@ -93,6 +94,7 @@ namespace ngla
       firsti[i] = i*max_elsperrow;
 
     CalcBalancing ();
+    TrackMemory ();
   }
   
 
@@ -109,6 +111,7 @@ namespace ngla
       {
 	firsti.Swap (graph.firsti);
 	colnr.Swap (graph.colnr);
+        tracked.Swap (graph.tracked);
       }
     else
       {
@@ -120,11 +123,26 @@ namespace ngla
 	  firsti[i] = graph.firsti[i];
 	for (size_t i = 0; i < nze; i++)
 	  colnr[i] = graph.colnr[i];
+        TrackMemory ();
       }
     // inversetype = agraph.GetInverseType();
     CalcBalancing ();
   }
 
+  MatrixGraph :: MatrixGraph (int asize, int awidth, FlatArray<size_t> afirsti, FlatArray<int> acolnr)
+  {
+    size = asize;
+    width = awidth;
+    nze = afirsti[asize];
+    owner = false;
+
+    // arrays referencing the memory, nothing is copied or freed
+    firsti = Array<size_t> (afirsti.Size(), afirsti.Data());
+    static_cast<Array<int>&> (colnr) = Array<int> (acolnr.Size(), acolnr.Data());
+
+    CalcBalancing ();
+  }
+
   MatrixGraph :: MatrixGraph (MatrixGraph && graph)
   {
     if (!graph.owner) {
@@ -136,6 +154,7 @@ namespace ngla
     owner = true;
     firsti.Swap (graph.firsti);
     colnr.Swap (graph.colnr);
+    tracked.Swap (graph.tracked);
     CalcBalancing ();
   }
 
@@ -882,6 +901,7 @@ namespace ngla
             colnr = NumaDistributedArray<int> (nze+1);
 
 	    CalcBalancing ();
+            TrackMemory ();
 
             // first touch memory (numa!)
             ParallelFor (balance, [&](int row) 
@@ -1270,10 +1290,11 @@ namespace ngla
     else if (ainversetype == "masterinverse") SetInverseType ( MASTERINVERSE );
     else if (ainversetype == "sparsecholesky") SetInverseType ( SPARSECHOLESKY );
     else if (ainversetype == "umfpack")       SetInverseType ( UMFPACK );
+    else if (ainversetype == "agglomerate")   SetInverseType ( AGGLOMERATE );
     else
       {
         throw Exception (ToString("undefined inverse ")+ainversetype+
-                         "\nallowed is: 'sparsecholesky', 'pardiso', 'pardisospd', 'mumps', 'masterinverse', 'umfpack'");
+                         "\nallowed is: 'sparsecholesky', 'pardiso', 'pardisospd', 'mumps', 'masterinverse', 'umfpack', 'agglomerate'");
       }
     return old_invtype;
   }
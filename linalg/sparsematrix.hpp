@@ -99,6 +99,11 @@ namespace ngla
     /// owner of arrays ?
     bool owner;
 
+    /// registers allocated firsti/colnr with the MemoryTracker
+    TrackedMemory tracked;
+    void TrackMemory ()
+    { tracked.Set (MemoryTracker::MATRIXGRAPH, firsti.Size()*sizeof(size_t) + colnr.Size()*sizeof(int)); }
+
   public:
     /// arbitrary number of els/row
     MatrixGraph (const Array<int> & elsperrow, int awidth);
@@ -111,6 +116,8 @@ namespace ngla
     /// 
     MatrixGraph (int size, int width,
                  const Table<int> & rowelements, const Table<int> & colelements, bool symmetric);
+    /// graph referencing external memory (e.g. a mapped file), arrays are not copied
+    MatrixGraph (int size, int width, FlatArray<size_t> afirsti, FlatArray<int> acolnr);
     /// 
     // MatrixGraph (const Table<int> & dof2dof, bool symmetric);
     virtual ~MatrixGraph ();
@@ -186,6 +193,10 @@ namespace ngla
       : MatrixGraph (agraph, stealgraph)
     { ; }   
 
+    BaseSparseMatrix (int size, int width, FlatArray<size_t> afirsti, FlatArray<int> acolnr)
+      : MatrixGraph (size, width, afirsti, acolnr)
+    { ; }   
+
     BaseSparseMatrix (const BaseSparseMatrix & amat)
       : BaseMatrix(amat), MatrixGraph (amat, 0)
     { ; }   
@@ -260,6 +271,8 @@ namespace ngla
 
     void SetSPD (bool aspd = true) { spd = aspd; }
     bool IsSPD () const { return spd; }
+    /// only the lower triangle is stored
+    virtual bool SymmetricStorage () const { return false; }
     virtual size_t NZE () const override { return nze; }
   };
 
@@ -327,6 +340,7 @@ namespace ngla
     // Array<TM, size_t> data;
     NumaDistributedArray<TM> data;
     TM nul;
+    TrackedMemory tracked;
     
     typedef S_BaseSparseMatrix<typename mat_traits<TM>::TSCAL> BASE;
     using BASE::firsti;
@@ -354,6 +368,7 @@ namespace ngla
     {
       SetEntrySize (mat_traits<TM>::HEIGHT, mat_traits<TM>::WIDTH, sizeof(TM)/sizeof(TSCAL));
       asvec.AssignMemory (nze*sizeof(TM)/sizeof(TSCAL), (void*)data.Addr(0));
+      tracked.Set (MemoryTracker::MATRIX, nze*sizeof(TM));
     }
 
     SparseMatrixTM (const Array<int> & elsperrow, int awidth)
@@ -362,6 +377,7 @@ namespace ngla
     {
       SetEntrySize (mat_traits<TM>::HEIGHT, mat_traits<TM>::WIDTH, sizeof(TM)/sizeof(TSCAL));
       asvec.AssignMemory (nze*sizeof(TM)/sizeof(TSCAL), (void*)data.Addr(0));
+      tracked.Set (MemoryTracker::MATRIX, nze*sizeof(TM));
     }
 
     SparseMatrixTM (int size, int width, const Table<int> & rowelements, 
@@ -371,6 +387,7 @@ namespace ngla
     { 
       SetEntrySize (mat_traits<TM>::HEIGHT, mat_traits<TM>::WIDTH, sizeof(TM)/sizeof(TSCAL));
       asvec.AssignMemory (nze*sizeof(TM)/sizeof(TSCAL), (void*)data.Addr(0));
+      tracked.Set (MemoryTracker::MATRIX, nze*sizeof(TM));
     }
 
     SparseMatrixTM (const MatrixGraph & agraph, bool stealgraph)
@@ -379,6 +396,7 @@ namespace ngla
     { 
       SetEntrySize (mat_traits<TM>::HEIGHT, mat_traits<TM>::WIDTH, sizeof(TM)/sizeof(TSCAL));
       asvec.AssignMemory (nze*sizeof(TM)/sizeof(TSCAL), (void*)data.Addr(0));
+      tracked.Set (MemoryTracker::MATRIX, nze*sizeof(TM));
       FindSameNZE();
     }
 
@@ -387,7 +405,8 @@ namespace ngla
       data(nze), nul(TSCAL(0))
     {
       SetEntrySize (mat_traits<TM>::HEIGHT, mat_traits<TM>::WIDTH, sizeof(TM)/sizeof(TSCAL));
-      asvec.AssignMemory (nze*sizeof(TM)/sizeof(TSCAL), (void*)data.Addr(0));      
+      asvec.AssignMemory (nze*sizeof(TM)/sizeof(TSCAL), (void*)data.Addr(0));
+      tracked.Set (MemoryTracker::MATRIX, nze*sizeof(TM));
       AsVector() = amat.AsVector(); 
     }
 
@@ -396,9 +415,20 @@ namespace ngla
     {
       SetEntrySize (mat_traits<TM>::HEIGHT, mat_traits<TM>::WIDTH, sizeof(TM)/sizeof(TSCAL));
       data.Swap(amat.data);
+      tracked.Swap(amat.tracked);
       asvec.AssignMemory (nze*sizeof(TM)/sizeof(TSCAL), (void*)data.Addr(0));            
     }
 
+    /// matrix referencing external memory, graph and values are not copied
+    SparseMatrixTM (int size, int width, FlatArray<size_t> afirsti, FlatArray<int> acolnr,
+                    FlatArray<TM> adata)
+      : BASE (size, width, afirsti, acolnr), nul(TSCAL(0))
+    {
+      SetEntrySize (mat_traits<TM>::HEIGHT, mat_traits<TM>::WIDTH, sizeof(TM)/sizeof(TSCAL));
+      static_cast<Array<TM>&> (data) = Array<TM> (adata.Size(), adata.Data());
+      asvec.AssignMemory (nze*sizeof(TM)/sizeof(TSCAL), (void*)data.Addr(0));
+    }
+
     static shared_ptr<SparseMatrixTM> CreateFromCOO (FlatArray<int> i, FlatArray<int> j,
                                                      FlatArray<TSCAL> val, size_t h, size_t w);
       
@@ -459,6 +489,64 @@ namespace ngla
 
 
 
+  /*
+    Row kernels for complex vectors, with separate sums for the real and
+    imaginary parts. The std::complex product checks every result for
+    inf/nan, which prevents vectorization of the row loop.
+  */
+  template <typename TM, typename TV>
+  constexpr bool use_split_complex = is_same<TV,Complex>::value &&
+    (is_same<TM,Complex>::value || is_same<TM,double>::value);
+
+  template <typename TM>
+  INLINE Complex SplitComplexRowTimesVector (size_t first, size_t last, const int * colnr,
+                                             const TM * data, FlatVector<Complex> vec)
+  {
+    const double * px = reinterpret_cast<const double*> (vec.Data());
+    double sumr = 0, sumi = 0;
+    for (size_t j = first; j < last; j++)
+      {
+        double xr = px[2*colnr[j]], xi = px[2*colnr[j]+1];
+        if constexpr (is_same<TM,Complex>::value)
+          {
+            double ar = data[j].real(), ai = data[j].imag();
+            sumr += ar*xr - ai*xi;
+            sumi += ar*xi + ai*xr;
+          }
+        else
+          {
+            sumr += data[j] * xr;
+            sumi += data[j] * xi;
+          }
+      }
+    return Complex(sumr, sumi);
+  }
+
+  // vec[colnr[j]] += data[j] * el, or Conj(data[j]) * el
+  template <bool CONJ, typename TM>
+  INLINE void SplitComplexAddRowTrans (size_t first, size_t last, const int * colnr,
+                                       const TM * data, Complex el, FlatVector<Complex> vec)
+  {
+    double * py = reinterpret_cast<double*> (vec.Data());
+    double er = el.real(), ei = el.imag();
+    for (size_t j = first; j < last; j++)
+      {
+        double * pyj = py + 2*colnr[j];
+        if constexpr (is_same<TM,Complex>::value)
+          {
+            double ar = data[j].real(), ai = CONJ ? -data[j].imag() : data[j].imag();
+            pyj[0] += ar*er - ai*ei;
+            pyj[1] += ar*ei + ai*er;
+          }
+        else
+          {
+            pyj[0] += data[j] * er;
+            pyj[1] += data[j] * ei;
+          }
+      }
+  }
+
+
   template<class TM, class TV_ROW, class TV_COL>
   class NGS_DLL_HEADER SparseMatrix :  public SparseMatrixTM<TM>
   {
@@ -499,6 +587,10 @@ namespace ngla
     SparseMatrix (SparseMatrixTM<TM> && amat)
       : SparseMatrixTM<TM> (move(amat)) { ; }
 
+    SparseMatrix (int height, int width, FlatArray<size_t> afirsti, FlatArray<int> acolnr,
+                  FlatArray<TM> adata)
+      : SparseMatrixTM<TM> (height, width, afirsti, acolnr, adata) { ; }
+
     virtual shared_ptr<BaseMatrix> CreateMatrix () const override;
     // virtual BaseMatrix * CreateMatrix (const Array<int> & elsperrow) const;
     ///
@@ -547,6 +639,8 @@ namespace ngla
     ///
     inline TVY RowTimesVector (int row, const FlatVector<TVX> vec) const
     {
+      if constexpr (use_split_complex<TM,TVX>)
+        return SplitComplexRowTimesVector (firsti[row], firsti[row+1], colnr.Addr(0), data.Addr(0), vec);
       typedef typename mat_traits<TVY>::TSCAL TTSCAL;
       TVY sum = TTSCAL(0);
       for (size_t j = firsti[row]; j < firsti[row+1]; j++)
@@ -563,6 +657,11 @@ namespace ngla
       const int * colpi = colnr.Addr(0);
       const TM * datap = data.Addr(0);
 
+      if constexpr (use_split_complex<TM,TVX>)
+        {
+          SplitComplexAddRowTrans<false> (first, last, colpi, datap, el, vec);
+          return;
+        }
       for (size_t j = first; j < last; j++)
         vec[colpi[j]] += Trans(datap[j]) * el; 
     }
@@ -576,6 +675,11 @@ namespace ngla
       const int * colpi = colnr.Addr(0);
       const TM * datap = data.Addr(0);
 
+      if constexpr (use_split_complex<TM,TVX>)
+        {
+          SplitComplexAddRowTrans<true> (first, last, colpi, datap, el, vec);
+          return;
+        }
       for (size_t j = first; j < last; j++)
         vec[colpi[j]] += Conj(Trans(datap[j])) * el; 
     }
@@ -629,6 +733,11 @@ namespace ngla
 
     SparseMatrixSymmetric (const MatrixGraph & agraph, bool stealgraph);
 
+    SparseMatrixSymmetric (int size, FlatArray<size_t> afirsti, FlatArray<int> acolnr,
+                           FlatArray<TM> adata)
+      : SparseMatrix<TM,TV,TV> (size, size, afirsti, acolnr, adata)
+    { ; }
+
     SparseMatrixSymmetric (const SparseMatrixSymmetric & amat)
       : SparseMatrix<TM,TV,TV> (amat)
     { 
@@ -688,6 +797,8 @@ namespace ngla
     virtual shared_ptr<BaseSparseMatrix> Restrict (const SparseMatrixTM<double> & prol,
 					 shared_ptr<BaseSparseMatrix> cmat = nullptr) const override;
 
+    virtual bool SymmetricStorage () const override { return true; }
+
     ///
     virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
 
@@ -727,6 +838,8 @@ namespace ngla
       if (last == first) return TVY(0);
       if (colnr[last-1] == row) last--;
 
+      if constexpr (use_split_complex<TM,TVX>)
+        return SplitComplexRowTimesVector (first, last, colnr.Addr(0), data.Addr(0), vec);
       typedef typename mat_traits<TVY>::TSCAL TTSCAL;
       TVY sum = TTSCAL(0);
 
@@ -743,6 +856,11 @@ namespace ngla
       if (first == last) return;
       if (this->colnr[last-1] == row) last--;
 
+      if constexpr (use_split_complex<TM,TVX>)
+        {
+          SplitComplexAddRowTrans<false> (first, last, colnr.Addr(0), data.Addr(0), el, vec);
+          return;
+        }
       for (size_t j = first; j < last; j++)
         vec[colnr[j]] += Trans(data[j]) * el;
     }
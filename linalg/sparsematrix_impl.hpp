@@ -137,7 +137,10 @@ namespace ngla
   MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
     static Timer t("SparseMatrix::MultAdd"); RegionTimer reg(t);
-    t.AddFlops (this->NZE());
+    PerfRegion perf(t, true);
+    t.AddFlops (2.0*this->NZE()*mat_traits<TM>::HEIGHT*mat_traits<TM>::WIDTH);
+    PerfCounters::AddBytes (t, this->NZE()*(sizeof(TM)+sizeof(int)) + this->Height()*sizeof(size_t)
+                            + this->Width()*sizeof(TVX) + 2*this->Height()*sizeof(TVY));
 
     ParallelForRange
       (balance, [&] (IntRange myrange)
@@ -772,7 +775,10 @@ namespace ngla
   {
     static Timer timer("SparseMatrixSymmetric::MultAdd");
     RegionTimer reg (timer);
+    PerfRegion perf(timer);
     timer.AddFlops (2*this->nze);
+    PerfCounters::AddBytes (timer, this->nze*(sizeof(TM)+sizeof(int)) + this->Height()*sizeof(size_t)
+                            + 3*this->Height()*sizeof(TV_COL));
 
     const FlatVector<TV_ROW> fx = x.FV<TV_ROW>();
     FlatVector<TV_COL> fy = y.FV<TV_COL>();
@@ -15,6 +15,7 @@ namespace ngla
     TSCAL * pdata;
     int es;
     bool ownmem;
+    TrackedMemory tracked;
     
   public:
     S_BaseVectorPtr (size_t as, int aes, void * adata) throw()
@@ -32,6 +33,7 @@ namespace ngla
       es = aes;
       pdata = new TSCAL[as*aes];
       ownmem = true;
+      tracked.Set (MemoryTracker::VECTOR, as*aes*sizeof(TSCAL));
       this->entrysize = es * sizeof(TSCAL) / sizeof(double);
     }
 
@@ -41,6 +43,7 @@ namespace ngla
       this->size = as;
       pdata = new TSCAL[as*es];
       ownmem = true;
+      tracked.Set (MemoryTracker::VECTOR, as*es*sizeof(TSCAL));
     }
 
     void AssignMemory (size_t as, void * adata)
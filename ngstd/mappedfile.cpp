@@ -0,0 +1,288 @@
+#include <ngstd.hpp>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace ngstd
+{
+
+  MappedFile :: MappedFile (const string & afilename, bool acopyonwrite)
+    : filename(afilename), copyonwrite(acopyonwrite)
+  {
+#ifdef WIN32
+    throw Exception ("MappedFile: memory mapped files are not supported on Windows");
+#else
+    int fd = open (filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw Exception ("MappedFile: cannot open file '" + filename + "'");
+
+    struct stat st;
+    if (fstat (fd, &st) < 0)
+      {
+        close (fd);
+        throw Exception ("MappedFile: cannot stat file '" + filename + "'");
+      }
+    size = st.st_size;
+
+    if (size > 0)
+      {
+        void * ptr = copyonwrite
+          ? mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+          : mmap (nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED)
+          {
+            close (fd);
+            throw Exception ("MappedFile: mmap failed for file '" + filename + "'");
+          }
+        data = static_cast<char*> (ptr);
+      }
+    close (fd);  // the mapping stays valid
+#endif
+  }
+
+  MappedFile :: ~MappedFile ()
+  {
+#ifndef WIN32
+    if (data)
+      munmap (data, size);
+#endif
+  }
+
+
+
+
+  struct ScratchFile::Worker
+  {
+    struct Request
+    {
+      bool prefetch;
+      size_t offset, bytes;
+    };
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv, cv_done;
+    std::deque<Request> requests;
+    bool stop = false;
+    bool busy = false;
+
+    // released ranges which may still be in memory, oldest first
+    std::deque<Request> released;
+    size_t released_bytes = 0;
+
+    // range handed to read-ahead since the last ResetPrefetch
+    size_t prefetch_lo = 0, prefetch_hi = 0;
+  };
+
+
+#ifndef WIN32
+  namespace
+  {
+    size_t PageSize ()
+    {
+      static size_t pagesize = sysconf (_SC_PAGESIZE);
+      return pagesize;
+    }
+
+    // pages completely inside [offset, offset+bytes)
+    void InnerPages (size_t & offset, size_t & bytes)
+    {
+      size_t ps = PageSize();
+      size_t first = (offset + ps-1) / ps * ps;
+      size_t next = (offset + bytes) / ps * ps;
+      offset = first;
+      bytes = next > first ? next-first : 0;
+    }
+
+    // pages touching [offset, offset+bytes)
+    void OuterPages (size_t & offset, size_t & bytes)
+    {
+      size_t ps = PageSize();
+      size_t first = offset / ps * ps;
+      bytes += offset-first;
+      offset = first;
+    }
+  }
+#endif
+
+
+  ScratchFile :: ScratchFile (size_t asize, const string & directory, size_t abudget)
+    : size(asize), budget(abudget)
+  {
+#ifdef WIN32
+    throw Exception ("ScratchFile: memory mapped files are not supported on Windows");
+#else
+    filename = directory + "/ngs_scratch_XXXXXX";
+    fd = mkstemp (filename.data());
+    if (fd < 0)
+      throw Exception ("ScratchFile: cannot create file in '" + directory + "'");
+    unlink (filename.c_str());   // removed when closed
+
+    if (ftruncate (fd, size) < 0)
+      {
+        close (fd);
+        throw Exception ("ScratchFile: cannot resize '" + filename + "' to " + ToString(size) + " bytes");
+      }
+    if (size > 0)
+      {
+        void * ptr = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED)
+          {
+            close (fd);
+            throw Exception ("ScratchFile: mmap failed for '" + filename + "'");
+          }
+        data = static_cast<char*> (ptr);
+      }
+
+    worker = make_unique<Worker>();
+    worker->thread = std::thread ([this] ()
+      {
+        Worker & w = *worker;
+        while (true)
+          {
+            std::unique_lock<std::mutex> lock(w.mutex);
+            w.cv.wait (lock, [&] { return w.stop || !w.requests.empty(); });
+            if (w.requests.empty()) break;   // stop, and nothing left to do
+            auto req = w.requests.front();
+            w.requests.pop_front();
+            w.busy = true;
+            lock.unlock();
+
+            if (req.prefetch)
+              {
+                OuterPages (req.offset, req.bytes);
+                madvise (data+req.offset, req.bytes, MADV_WILLNEED);
+              }
+            else
+              {
+                size_t offset = req.offset, bytes = req.bytes;
+                OuterPages (offset, bytes);
+                msync (data+offset, bytes, MS_SYNC);
+
+                lock.lock();
+                w.released.push_back (req);
+                w.released_bytes += req.bytes;
+                while (w.released_bytes > budget)
+                  {
+                    auto old = w.released.front();
+                    w.released.pop_front();
+                    w.released_bytes -= old.bytes;
+                    // pages shared with ranges still in use stay
+                    InnerPages (old.offset, old.bytes);
+                    if (old.bytes == 0) continue;
+                    madvise (data+old.offset, old.bytes, MADV_DONTNEED);
+                    posix_fadvise (fd, old.offset, old.bytes, POSIX_FADV_DONTNEED);
+                  }
+                lock.unlock();
+              }
+
+            lock.lock();
+            w.busy = false;
+            w.cv_done.notify_all();
+          }
+      });
+#endif
+  }
+
+  ScratchFile :: ~ScratchFile ()
+  {
+#ifndef WIN32
+    if (worker)
+      {
+        {
+          std::lock_guard<std::mutex> guard(worker->mutex);
+          worker->requests.clear();
+          worker->stop = true;
+        }
+        worker->cv.notify_all();
+        worker->thread.join();
+      }
+    if (data)
+      munmap (data, size);
+    if (fd >= 0)
+      close (fd);
+#endif
+  }
+
+  void ScratchFile :: Clear ()
+  {
+#ifndef WIN32
+    Flush();
+    {
+      std::lock_guard<std::mutex> guard(worker->mutex);
+      worker->released.clear();
+      worker->released_bytes = 0;
+      worker->prefetch_lo = worker->prefetch_hi = 0;
+    }
+    // truncating drops the pages, extending again gives zeros
+    if (ftruncate (fd, 0) < 0 || ftruncate (fd, size) < 0)
+      throw Exception ("ScratchFile: cannot clear '" + filename + "'");
+#endif
+  }
+
+  void ScratchFile :: Release (size_t offset, size_t bytes)
+  {
+    if (bytes == 0) return;
+    {
+      std::lock_guard<std::mutex> guard(worker->mutex);
+      worker->requests.push_back ( { false, offset, bytes } );
+    }
+    worker->cv.notify_one();
+  }
+
+  void ScratchFile :: Prefetch (size_t offset, size_t bytes)
+  {
+    bytes = min(bytes, size-min(offset, size));
+    if (bytes == 0) return;
+    {
+      std::lock_guard<std::mutex> guard(worker->mutex);
+      Worker & w = *worker;
+      size_t next = offset+bytes;
+      if (offset >= w.prefetch_lo && next <= w.prefetch_hi)
+        return;
+
+      if (w.prefetch_lo == w.prefetch_hi || next < w.prefetch_lo || offset > w.prefetch_hi)
+        {
+          // disjoint, start a new range
+          w.prefetch_lo = offset;
+          w.prefetch_hi = next;
+        }
+      else if (next > w.prefetch_hi)
+        {
+          // sweep upwards
+          offset = w.prefetch_hi;
+          w.prefetch_hi = next;
+        }
+      else
+        {
+          // sweep downwards
+          next = w.prefetch_lo;
+          w.prefetch_lo = offset;
+        }
+      w.requests.push_back ( { true, offset, next-offset } );
+    }
+    worker->cv.notify_one();
+  }
+
+  void ScratchFile :: ResetPrefetch ()
+  {
+    std::lock_guard<std::mutex> guard(worker->mutex);
+    worker->prefetch_lo = worker->prefetch_hi = 0;
+  }
+
+  void ScratchFile :: Flush ()
+  {
+    std::unique_lock<std::mutex> lock(worker->mutex);
+    worker->cv_done.wait (lock, [&] { return worker->requests.empty() && !worker->busy; });
+  }
+
+}
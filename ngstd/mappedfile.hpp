@@ -0,0 +1,86 @@
+#ifndef FILE_MAPPEDFILE
+#define FILE_MAPPEDFILE
+
+namespace ngstd
+{
+
+  /**
+     Memory mapping of a file.
+     Pages are loaded lazily on first access, and are shared between
+     all processes on a node mapping the same file. The default mapping
+     is read-only. A copy-on-write mapping may be written, written
+     pages become private to the process and the file is not changed.
+     It counts with its full size against the commit limit, so use it
+     only where the data is handed out writable.
+  */
+  class NGS_DLL_HEADER MappedFile
+  {
+    string filename;
+    char * data = nullptr;
+    size_t size = 0;
+    bool copyonwrite;
+  public:
+    MappedFile (const string & afilename, bool acopyonwrite = false);
+    ~MappedFile ();
+    MappedFile (const MappedFile &) = delete;
+    MappedFile & operator= (const MappedFile &) = delete;
+
+    const string & GetFileName() const { return filename; }
+    const char * Data() const { return data; }
+    size_t Size() const { return size; }
+    bool IsCopyOnWrite() const { return copyonwrite; }
+
+    /// n objects of type T, starting at byte offset
+    template <typename T>
+    FlatArray<T> View (size_t offset, size_t n) const
+    {
+      if (offset + n*sizeof(T) > size)
+        throw Exception ("MappedFile '" + filename + "': requested range exceeds file size");
+      return FlatArray<T> (n, reinterpret_cast<T*> (data+offset));
+    }
+  };
+
+
+  /**
+     Temporary read-write mapping of a scratch file, for data which does
+     not fit into memory. The file is unlinked right after creation and
+     vanishes with the object. Pages are written back by the kernel under
+     memory pressure, Release and Prefetch give hints ahead of time. Both
+     return immediately, the work is done by a background thread.
+  */
+  class NGS_DLL_HEADER ScratchFile
+  {
+    string filename;
+    int fd = -1;
+    char * data = nullptr;
+    size_t size = 0;
+    /// released ranges stay in memory up to this many bytes
+    size_t budget;
+    struct Worker;
+    unique_ptr<Worker> worker;
+  public:
+    /// creates a file of asize bytes in directory
+    ScratchFile (size_t asize, const string & directory, size_t abudget);
+    ~ScratchFile ();
+    ScratchFile (const ScratchFile &) = delete;
+    ScratchFile & operator= (const ScratchFile &) = delete;
+
+    char * Data() const { return data; }
+    size_t Size() const { return size; }
+
+    /// zero the whole file, drops all pages
+    void Clear ();
+    /// the byte range is final: write it back, and drop the oldest
+    /// released ranges from memory when they exceed the budget
+    void Release (size_t offset, size_t bytes);
+    /// read-ahead of a byte range, parts already requested since the
+    /// last ResetPrefetch are skipped
+    void Prefetch (size_t offset, size_t bytes);
+    void ResetPrefetch ();
+    /// wait until all requests are processed
+    void Flush ();
+  };
+
+}
+
+#endif
@@ -0,0 +1,48 @@
+/*********************************************************************/
+/* File:   memusage.cpp                                              */
+/* Date:   2024                                                      */
+/*********************************************************************/
+
+#include <ngstd.hpp>
+
+#ifdef __linux__
+#include <fstream>
+#endif
+
+namespace ngstd
+{
+  std::atomic<int64_t> MemoryTracker::current[MemoryTracker::NCATEGORIES];
+  std::atomic<int64_t> MemoryTracker::peak[MemoryTracker::NCATEGORIES];
+
+  const char * MemoryTracker :: Name (CATEGORY cat)
+  {
+    const char * names[] = { "vectors", "matrix graphs", "matrices", "factorizations", "preconditioners" };
+    return names[cat];
+  }
+
+  void MemoryTracker :: ResetPeak ()
+  {
+    for (int i = 0; i < NCATEGORIES; i++)
+      peak[i] = int64_t(current[i]);
+#ifdef __linux__
+    // resets VmHWM
+    ofstream ("/proc/self/clear_refs") << "5" << flush;
+#endif
+  }
+
+  // value in kB of a line in /proc/self/status
+  static size_t ReadStatus (const string & key)
+  {
+#ifdef __linux__
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline (status, line))
+      if (line.compare (0, key.size(), key) == 0)
+        return size_t(atoll (line.c_str()+key.size()+1)) * 1024;
+#endif
+    return 0;
+  }
+
+  size_t MemoryTracker :: ProcessResident () { return ReadStatus ("VmRSS"); }
+  size_t MemoryTracker :: ProcessPeak () { return ReadStatus ("VmHWM"); }
+}
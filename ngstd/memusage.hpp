@@ -36,6 +36,61 @@ public:
   size_t NBlocks () const { return nblocks; }
 };
 
+
+/**
+   Bytes currently held by large NGSolve allocations, per category,
+   with peak values. Process totals come from the operating system
+   and include everything else (mesh, LocalHeaps, small arrays).
+ */
+class NGS_DLL_HEADER MemoryTracker
+{
+public:
+  enum CATEGORY { VECTOR, MATRIXGRAPH, MATRIX, FACTORIZATION, PRECONDITIONER, NCATEGORIES };
+  static std::atomic<int64_t> current[NCATEGORIES];
+  static std::atomic<int64_t> peak[NCATEGORIES];
+
+  static void Alloc (CATEGORY cat, size_t bytes)
+  {
+    int64_t now = current[cat] += bytes;
+    int64_t old = peak[cat];
+    while (now > old && !peak[cat].compare_exchange_weak(old, now)) ;
+  }
+  static void Free (CATEGORY cat, size_t bytes) { current[cat] -= bytes; }
+
+  static const char * Name (CATEGORY cat);
+  /// peak values := current values, also resets the process peak
+  static void ResetPeak ();
+
+  /// resident set size and its peak of the process (Linux), 0 if unknown
+  static size_t ProcessResident ();
+  static size_t ProcessPeak ();
+};
+
+/// registers bytes in a category for the lifetime of the owning object
+class TrackedMemory
+{
+  MemoryTracker::CATEGORY cat = MemoryTracker::VECTOR;
+  size_t bytes = 0;
+public:
+  TrackedMemory () = default;
+  TrackedMemory (const TrackedMemory & other) { Set (other.cat, other.bytes); }
+  TrackedMemory & operator= (const TrackedMemory & other) { Set (other.cat, other.bytes); return *this; }
+  ~TrackedMemory () { MemoryTracker::Free (cat, bytes); }
+
+  void Set (MemoryTracker::CATEGORY acat, size_t abytes)
+  {
+    MemoryTracker::Free (cat, bytes);
+    cat = acat;
+    bytes = abytes;
+    MemoryTracker::Alloc (cat, bytes);
+  }
+  void Swap (TrackedMemory & other)
+  {
+    std::swap (cat, other.cat);
+    std::swap (bytes, other.bytes);
+  }
+};
+
 }
 
 #endif
@@ -147,6 +147,8 @@ namespace ngstd
 
 #include "evalfunc.hpp"
 #include "sample_sort.hpp"
+#include "mappedfile.hpp"
+#include "perfcounters.hpp"
 
 #include "autodiff.hpp"
 #include "autodiffdiff.hpp"
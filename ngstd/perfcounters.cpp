@@ -0,0 +1,216 @@
+/*********************************************************************/
+/* File:   perfcounters.cpp                                          */
+/* Date:   2024                                                      */
+/*********************************************************************/
+
+#include <ngstd.hpp>
+
+#if defined(NGS_PERFCOUNTERS) && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <dirent.h>
+#define NGS_HAVE_PERF_EVENT
+#endif
+
+namespace ngstd
+{
+  bool PerfCounters::enabled = false;
+  double PerfCounters::counts[PerfCounters::NCOUNTERS][NgProfiler::SIZE];
+  double PerfCounters::bytes[NgProfiler::SIZE];
+  double PerfCounters::peak_gflops = 0;
+  double PerfCounters::peak_gbytes = 0;
+
+  void PerfCounters :: Reset ()
+  {
+    for (auto & c : counts)
+      for (auto & v : c) v = 0;
+    for (auto & v : bytes) v = 0;
+  }
+
+  
+#ifdef NGS_HAVE_PERF_EVENT
+  namespace
+  {
+    void WarnUnavailable ()
+    {
+      static atomic<bool> warned{false};
+      if (!warned.exchange(true))
+        cerr << "PerfCounters: perf_event_open failed, check /proc/sys/kernel/perf_event_paranoid" << endl;
+    }
+
+    // one counter group for thread tid, 0 is the calling thread
+    class CounterGroup
+    {
+      int fds[PerfCounters::NCOUNTERS];
+      bool ok = false;
+    public:
+      CounterGroup (pid_t tid = 0)
+      {
+        std::fill (fds, fds+PerfCounters::NCOUNTERS, -1);
+        const uint64_t configs[PerfCounters::NCOUNTERS] =
+          { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES };
+        for (int i = 0; i < PerfCounters::NCOUNTERS; i++)
+          {
+            perf_event_attr attr;
+            memset (&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fds[i] = syscall (__NR_perf_event_open, &attr, tid, -1, i == 0 ? -1 : fds[0], 0);
+            if (fds[i] < 0)
+              {
+                WarnUnavailable();
+                return;
+              }
+          }
+        ok = true;
+      }
+      CounterGroup (const CounterGroup &) = delete;
+      ~CounterGroup ()
+      {
+        for (int fd : fds)
+          if (fd >= 0) close (fd);
+      }
+
+      bool Ok () const { return ok; }
+
+      bool Read (uint64_t * values)
+      {
+        if (!ok) return false;
+        uint64_t buf[1+PerfCounters::NCOUNTERS];
+        if (read (fds[0], buf, sizeof(buf)) != sizeof(buf))
+          return false;
+        for (int i = 0; i < PerfCounters::NCOUNTERS; i++)
+          values[i] = buf[1+i];
+        return true;
+      }
+    };
+
+    // the threads of the process when the counters were enabled
+    mutex all_mutex;
+    std::vector<unique_ptr<CounterGroup>> all_groups;
+  }
+
+  void PerfCounters :: Enable (bool enable)
+  {
+    lock_guard<mutex> guard(all_mutex);
+    enabled = enable;
+    all_groups.clear();
+    if (!enable) return;
+
+    // the TaskManager workers are already running, open their counters by thread id
+    if (DIR * dir = opendir ("/proc/self/task"))
+      {
+        while (dirent * entry = readdir (dir))
+          if (entry->d_name[0] != '.')
+            {
+              auto group = make_unique<CounterGroup> (atoi (entry->d_name));
+              if (group->Ok())
+                all_groups.push_back (std::move(group));
+            }
+        closedir (dir);
+      }
+  }
+
+  bool PerfCounters :: Read (uint64_t * values)
+  {
+    thread_local CounterGroup counters;
+    return counters.Read (values);
+  }
+
+  bool PerfCounters :: ReadAll (uint64_t * values)
+  {
+    lock_guard<mutex> guard(all_mutex);
+    if (all_groups.empty()) return false;
+    for (int i = 0; i < NCOUNTERS; i++)
+      values[i] = 0;
+    for (auto & group : all_groups)
+      {
+        uint64_t v[NCOUNTERS];
+        if (!group->Read (v)) return false;
+        for (int i = 0; i < NCOUNTERS; i++)
+          values[i] += v[i];
+      }
+    return true;
+  }
+#else
+  void PerfCounters :: Enable (bool enable)
+  {
+    enabled = enable;
+  }
+
+  bool PerfCounters :: Read (uint64_t * values)
+  {
+    return false;
+  }
+
+  bool PerfCounters :: ReadAll (uint64_t * values)
+  {
+    return false;
+  }
+#endif
+
+  void PerfCounters :: Accumulate (int nr, const uint64_t * start, bool allthreads)
+  {
+    uint64_t stop[NCOUNTERS];
+    if (!(allthreads ? ReadAll (stop) : Read (stop))) return;
+    // the counters were re-opened within the region
+    for (int i = 0; i < NCOUNTERS; i++)
+      if (stop[i] < start[i]) return;
+    for (int i = 0; i < NCOUNTERS; i++)
+      AtomicAdd (counts[i][nr], double(stop[i]-start[i]));
+  }
+
+
+  void PerfCounters :: MeasureRoofline (size_t n)
+  {
+    static Timer t("PerfCounters::MeasureRoofline");
+    RegionTimer reg(t);
+    
+    // flops: independent fma chains per thread, in registers
+    int nthreads = TaskManager::GetNumThreads();
+    constexpr int NACC = 8;
+    size_t its = 10*1000*1000;
+    Array<double> res(nthreads);
+    double tflops = -WallTime();
+    ParallelFor (nthreads, [&] (int tnr)
+                 {
+                   SIMD<double> acc[NACC];
+                   for (int j = 0; j < NACC; j++) acc[j] = SIMD<double>(1e-3*(j+tnr));
+                   SIMD<double> a(0.999999), b(1e-7);
+                   for (size_t i = 0; i < its; i++)
+                     for (int j = 0; j < NACC; j++)
+                       acc[j] = FMA (acc[j], a, b);
+                   double sum = 0;
+                   for (int j = 0; j < NACC; j++) sum += HSum(acc[j]);
+                   res[tnr] = sum;    // keep the result alive
+                 });
+    tflops += WallTime();
+    peak_gflops = 2.0 * nthreads * its * NACC * SIMD<double>::Size() / tflops * 1e-9;
+
+    // bandwidth: triad, best of three
+    Array<double> a(n), b(n), c(n);
+    ParallelForRange (n, [&] (IntRange r)
+                      {
+                        for (auto i : r) { a[i] = 0; b[i] = 1; c[i] = 2; }
+                      });
+    double tbest = 1e99;
+    for (int rep = 0; rep < 3; rep++)
+      {
+        double tbw = -WallTime();
+        ParallelForRange (n, [&] (IntRange r)
+                          {
+                            for (auto i : r)
+                              a[i] = b[i] + 0.5 * c[i];
+                          });
+        tbw += WallTime();
+        tbest = min(tbest, tbw);
+      }
+    peak_gbytes = 3.0 * n * sizeof(double) / tbest * 1e-9;
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef FILE_PERFCOUNTERS
+#define FILE_PERFCOUNTERS
+
+/**************************************************************************/
+/* File:   perfcounters.hpp                                               */
+/* Date:   2024                                                           */
+/**************************************************************************/
+
+namespace ngstd
+{
+
+  /**
+     Hardware counters and memory traffic, attached to Timer regions.
+
+     Kernels report analytic flop counts via Timer::AddFlops and
+     byte counts via PerfCounters::AddBytes. Built with
+     NGS_PERFCOUNTERS (cmake -DUSE_PERFCOUNTERS=ON, Linux only) a
+     PerfRegion additionally reads cycles, instructions and last-level
+     cache misses (perf_event_open), when switched on at runtime.
+
+     Regions around a ParallelFor sum the counters of all threads which
+     were running when the counters were enabled, this includes idle
+     workers waiting for tasks. Kernels called inside tasks count the
+     calling thread only.
+  */
+  class NGS_DLL_HEADER PerfCounters
+  {
+  public:
+    enum { CYCLES, INSTRUCTIONS, LLC_MISSES, NCOUNTERS };
+
+    /// runtime switch for the hardware counters, set by Enable
+    static bool enabled;
+    /// accumulated counts per timer
+    static double counts[NCOUNTERS][NgProfiler::SIZE];
+    static double bytes[NgProfiler::SIZE];
+    /// measured peak performance, 0 if not measured
+    static double peak_gflops, peak_gbytes;
+
+    static void AddBytes (int nr, double b) { AtomicAdd (bytes[nr], b); }
+    static void Reset ();
+
+    /// switch the hardware counters on or off, opens the counters of
+    /// all threads of the process (start the TaskManager before)
+    static void Enable (bool enable);
+    /// counters of the calling thread, false if not available
+    static bool Read (uint64_t * values);
+    /// counters summed over the threads, false if not available
+    static bool ReadAll (uint64_t * values);
+    static void Accumulate (int nr, const uint64_t * start, bool allthreads);
+
+    /// measure peak GFlop/s (fma loop) and GB/s (triad) with all threads
+    static void MeasureRoofline (size_t n = size_t(1) << 24);
+  };
+
+  
+  /// reads the hardware counters for the lifetime of the object,
+  /// allthreads for regions containing parallel loops
+  class PerfRegion
+  {
+#ifdef NGS_PERFCOUNTERS
+    int nr;
+    bool allthreads;
+    bool active;
+    uint64_t start[PerfCounters::NCOUNTERS];
+  public:
+    PerfRegion (int anr, bool aallthreads = false)
+      : nr(anr), allthreads(aallthreads),
+        active(PerfCounters::enabled &&
+               (allthreads ? PerfCounters::ReadAll(start) : PerfCounters::Read(start))) { ; }
+    ~PerfRegion () { if (active) PerfCounters::Accumulate (nr, start, allthreads); }
+#else
+  public:
+    PerfRegion (int, bool = false) { ; }
+#endif
+    PerfRegion (const PerfRegion &) = delete;
+  };
+}
+
+#endif
@@ -129,6 +129,79 @@ void NGS_DLL_HEADER  ExportNgstd(py::module & m) {
 	   }, "Returns list of timers"
 	   );
 
+  m.def("MemoryUsage", [] ()
+        {
+          py::dict res;
+          for (int i = 0; i < MemoryTracker::NCATEGORIES; i++)
+            {
+              py::dict cat;
+              cat["current"] = int64_t(MemoryTracker::current[i]);
+              cat["peak"] = int64_t(MemoryTracker::peak[i]);
+              res[MemoryTracker::Name(MemoryTracker::CATEGORY(i))] = cat;
+            }
+          py::dict process;
+          process["current"] = MemoryTracker::ProcessResident();
+          process["peak"] = MemoryTracker::ProcessPeak();
+          res["process"] = process;
+          return res;
+        }, "Bytes held by vectors, matrices, factorizations and preconditioners, and the process, with peak values");
+
+  m.def("ResetPeakMemory", &MemoryTracker::ResetPeak, "peak memory values := current values");
+
+  m.def("EnablePerfCounters", [] (bool enable) { PerfCounters::Enable (enable); },
+        py::arg("enable")=true,
+        "read hardware counters in kernel timers (needs build with USE_PERFCOUNTERS)");
+
+  m.def("MeasureRoofline", [] ()
+        {
+          PerfCounters::MeasureRoofline();
+          py::dict res;
+          res["Gflop/s"] = PerfCounters::peak_gflops;
+          res["GB/s"] = PerfCounters::peak_gbytes;
+          return res;
+        }, "measure peak Gflop/s and memory bandwidth with the current threads",
+        py::call_guard<py::gil_scoped_release>());
+
+  m.def("PerfCounters",
+        [] ()
+        {
+          py::list timers;
+          for (int i = 0; i < NgProfiler::SIZE; i++)
+            {
+              if (NgProfiler::timers[i].name.empty()) continue;
+              double time = NgProfiler::GetTime(i);
+              double flops = NgProfiler::GetFlops(i);
+              double bytes = PerfCounters::bytes[i];
+              double cycles = PerfCounters::counts[PerfCounters::CYCLES][i];
+              if (flops == 0 && bytes == 0 && cycles == 0) continue;
+              
+              py::dict timer;
+              timer["name"] = py::str(NgProfiler::timers[i].name);
+              timer["time"] = time;
+              timer["flops"] = flops;
+              timer["bytes"] = bytes;
+              timer["Gflop/s"] = flops/time*1e-9;
+              timer["GB/s"] = bytes/time*1e-9;
+              if (cycles > 0)
+                {
+                  double instructions = PerfCounters::counts[PerfCounters::INSTRUCTIONS][i];
+                  timer["cycles"] = cycles;
+                  timer["instructions"] = instructions;
+                  timer["IPC"] = instructions/cycles;
+                  timer["LLC misses"] = PerfCounters::counts[PerfCounters::LLC_MISSES][i];
+                }
+              if (PerfCounters::peak_gflops > 0 && bytes > 0)
+                {
+                  // attainable performance at the kernel's arithmetic intensity
+                  double roof = min(PerfCounters::peak_gflops, flops/bytes*PerfCounters::peak_gbytes);
+                  timer["roofline Gflop/s"] = roof;
+                  timer["roofline fraction"] = flops/time*1e-9 / roof;
+                }
+              timers.append(timer);
+            }
+          return timers;
+        }, "Returns flop and byte counts, hardware counters and roofline fraction of timers");
+
   py::class_<Archive, shared_ptr<Archive>> (m, "Archive")
       /*
     .def("__init__", [](const string & filename, bool write,
@@ -13,7 +13,42 @@
 namespace ngla
 {
 
+  int coarse_agglomeration_ranks = 0;
+  
 #ifdef PARALLEL
+
+  // consistent global enumeration of the subset dofs, -1 outside the subset
+  static int EnumerateGlobalDofs (const ParallelDofs & pardofs, const BitArray * subset,
+                                  Array<int> & global_nums)
+  {
+    auto comm = pardofs.GetCommunicator();
+    int ndof = pardofs.GetNDofLocal();
+
+    global_nums.SetSize(ndof);
+    global_nums = -1;
+    int num_master_dofs = 0;
+    for (int i = 0; i < ndof; i++)
+      if (pardofs.IsMasterDof (i) && (!subset || subset->Test(i)))
+	global_nums[i] = num_master_dofs++;
+
+    Array<int> first_master_dof(comm.Size());
+    comm.AllGather (num_master_dofs, first_master_dof);
+    
+    int num_glob_dofs = 0;
+    for (int i = 0; i < comm.Size(); i++)
+      {
+	int cur = first_master_dof[i];
+	first_master_dof[i] = num_glob_dofs;
+	num_glob_dofs += cur;
+      }
+    
+    for (int i = 0; i < ndof; i++)
+      if (global_nums[i] != -1)
+	global_nums[i] += first_master_dof[comm.Rank()];
+
+    pardofs.ScatterDofData (global_nums);
+    return num_glob_dofs;
+  }
   
   template <typename TM> AutoVector MasterInverse<TM> :: CreateRowVector () const
   { return make_unique<ParallelVVector<double>> (paralleldofs->GetNDofLocal(), paralleldofs); }
@@ -34,33 +69,8 @@ namespace ngla
     int ntasks = comm.Size();
 
     // consistent enumeration
-    
-    int ndof = paralleldofs->GetNDofLocal();
-
-    Array<int> global_nums(ndof);
-    global_nums = -1;
-    int num_master_dofs = 0;
-    for (int i = 0; i < ndof; i++)
-      if (paralleldofs -> IsMasterDof (i) && (!subset || (subset && subset->Test(i))))
-	global_nums[i] = num_master_dofs++;
-    
-
-    Array<int> first_master_dof(ntasks);
-    comm.AllGather (num_master_dofs, first_master_dof);
-    
-    int num_glob_dofs = 0;
-    for (int i = 0; i < ntasks; i++)
-      {
-	int cur = first_master_dof[i];
-	first_master_dof[i] = num_glob_dofs;
-	num_glob_dofs += cur;
-      }
-    
-    for (int i = 0; i < ndof; i++)
-      if (global_nums[i] != -1)
-	global_nums[i] += first_master_dof[id];
-
-    paralleldofs -> ScatterDofData (global_nums);
+    Array<int> global_nums;
+    int num_glob_dofs = EnumerateGlobalDofs (*paralleldofs, subset.get(), global_nums);
 
 
     /*
@@ -396,6 +406,287 @@ namespace ngla
 
 
 
+  
+  // gather the arrays of all ranks of comm, in rank order
+  template <typename T>
+  static Array<T> AllGatherArrays (FlatArray<T> a, MPI_Comm comm)
+  {
+    int np;
+    MPI_Comm_size (comm, &np);
+    Array<int> cnts(np), displs(np);
+    int n = a.Size();
+    MPI_Allgather (&n, 1, MPI_INT, cnts.Data(), 1, MPI_INT, comm);
+    int sum = 0;
+    for (int i = 0; i < np; i++)
+      {
+        displs[i] = sum;
+        sum += cnts[i];
+      }
+    Array<T> all(sum);
+    MPI_Allgatherv (a.Data(), n, GetMPIType<T>(), all.Data(), cnts.Data(), displs.Data(),
+                    GetMPIType<T>(), comm);
+    return all;
+  }
+  
+  template <typename TM> AutoVector AgglomeratedInverse<TM> :: CreateRowVector () const
+  {
+    return make_unique<S_ParallelBaseVectorPtr<TSCAL>>
+      (paralleldofs->GetNDofLocal(), paralleldofs->GetEntrySize(), paralleldofs, CUMULATED);
+  }
+  template <typename TM> AutoVector AgglomeratedInverse<TM> :: CreateColVector () const
+  {
+    return make_unique<S_ParallelBaseVectorPtr<TSCAL>>
+      (paralleldofs->GetNDofLocal(), paralleldofs->GetEntrySize(), paralleldofs, CUMULATED);
+  }
+
+  template <typename TM>
+  AgglomeratedInverse<TM> :: AgglomeratedInverse (const SparseMatrixTM<TM> & mat, 
+                                                  shared_ptr<BitArray> subset, 
+                                                  shared_ptr<ParallelDofs> hpardofs,
+                                                  int nmasters)
+    : BaseMatrix(hpardofs)
+  {
+    static Timer t("AgglomeratedInverse - setup");
+    RegionTimer reg(t);
+    
+    NgMPI_Comm comm = paralleldofs->GetCommunicator();
+    int id = comm.Rank();
+    int ntasks = comm.Size();
+
+    if (nmasters <= 0)
+      nmasters = max(1, int(sqrt(double(ntasks))));
+    nmasters = min(nmasters, ntasks);
+
+    // rank r is in group r*nmasters/ntasks, the first rank of a group is its master
+    auto first_of = [&] (int g) { return int( (size_t(g)*ntasks + nmasters-1) / nmasters ); };
+    int group = int( (size_t(id)*nmasters) / ntasks );
+    master = first_of(group);
+    bool is_master = (id == master);
+    if (is_master)
+      for (int r = id+1; r < first_of(group+1); r++)
+        members.Append (r);
+
+    MPI_Comm_split (comm, is_master ? 0 : MPI_UNDEFINED, id, &masters_comm);
+
+    Array<int> global_nums;
+    num_glob_dofs = EnumerateGlobalDofs (*paralleldofs, subset.get(), global_nums);
+
+    for (int i = 0; i < global_nums.Size(); i++)
+      if (global_nums[i] != -1)
+        {
+          select.Append (i);
+          select_glob.Append (global_nums[i]);
+          select_owned.Append (paralleldofs->IsMasterDof(i));
+        }
+    
+    Array<int> rows, cols;
+    Array<TM> vals;
+    for (int row = 0; row < mat.Height(); row++)
+      if (global_nums[row] != -1)
+        {
+          FlatArray<int> rcols = mat.GetRowIndices(row);
+          FlatVector<TM> rvals = mat.GetRowValues(row);
+          for (int j = 0; j < rcols.Size(); j++)
+            if (global_nums[rcols[j]] != -1)
+              {
+                rows.Append (global_nums[row]);
+                cols.Append (global_nums[rcols[j]]);
+                vals.Append (rvals[j]);
+              }
+        }
+
+    if (!is_master)
+      {
+        comm.Send (rows, master, MPI_TAG_SOLVE);
+        comm.Send (cols, master, MPI_TAG_SOLVE);
+        comm.Send (vals, master, MPI_TAG_SOLVE);
+        comm.Send (select_glob, master, MPI_TAG_SOLVE);
+        return;
+      }
+
+    // collect the group
+    Array<int> sizes(members.Size());
+    Array<Array<int>> hglob(members.Size());
+    for (int i = 0; i < members.Size(); i++)
+      {
+        Array<int> hrows, hcols;
+        Array<TM> hvals;
+        comm.Recv (hrows, members[i], MPI_TAG_SOLVE);
+        comm.Recv (hcols, members[i], MPI_TAG_SOLVE);
+        comm.Recv (hvals, members[i], MPI_TAG_SOLVE);
+        comm.Recv (hglob[i], members[i], MPI_TAG_SOLVE);
+        sizes[i] = hglob[i].Size();
+        for (int j = 0; j < hrows.Size(); j++)
+          {
+            rows.Append (hrows[j]);
+            cols.Append (hcols[j]);
+            vals.Append (hvals[j]);
+          }
+      }
+    member_glob = Table<int> (sizes);
+    for (int i = 0; i < members.Size(); i++)
+      member_glob[i] = hglob[i];
+
+    // every master gets the whole matrix
+    rows = AllGatherArrays<int> (rows, masters_comm);
+    cols = AllGatherArrays<int> (cols, masters_comm);
+    vals = AllGatherArrays<TM> (vals, masters_comm);
+
+    cout << IM(3) << "agglomerated inverse, " << nmasters << " masters, n = " << num_glob_dofs << endl;
+
+    bool symmetric = (dynamic_cast<const SparseMatrixSymmetric<TM>*>(&mat) != NULL);
+    DynamicTable<int> graph(num_glob_dofs);
+    for (int i = 0; i < rows.Size(); i++)
+      {
+        int r = rows[i], c = cols[i];
+        if (symmetric && (r < c)) swap (r, c);
+        graph.AddUnique (r, c);
+      }
+
+    Array<int> els_per_row(num_glob_dofs);
+    for (int i = 0; i < num_glob_dofs; i++)
+      els_per_row[i] = graph[i].Size();
+
+    auto matrix = symmetric ? make_shared<SparseMatrixSymmetric<TM>> (els_per_row)
+      : make_shared<SparseMatrix<TM>> (els_per_row);
+
+    for (int i = 0; i < rows.Size(); i++)
+      {
+        int r = rows[i], c = cols[i];
+        if (symmetric && (r < c)) swap (r, c);
+        matrix->CreatePosition(r, c);
+      }
+    matrix->AsVector() = 0.0;
+
+    for (int i = 0; i < rows.Size(); i++)
+      {
+        int r = rows[i], c = cols[i];
+        if (symmetric && (r < c)) swap (r, c);
+        (*matrix)(r,c) += vals[i];
+      }
+
+    inv = matrix->InverseMatrix ();
+  }
+
+  template <typename TM>
+  AgglomeratedInverse<TM> :: ~AgglomeratedInverse ()
+  {
+    if (masters_comm != MPI_COMM_NULL)
+      MPI_Comm_free (&masters_comm);
+  }
+
+  template <typename TM>
+  void AgglomeratedInverse<TM> :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
+  {
+    static Timer t("AgglomeratedInverse - apply");
+    RegionTimer reg(t);
+
+    NgMPI_Comm comm = paralleldofs->GetCommunicator();
+
+    bool is_x_cum = (dynamic_cast_ParallelBaseVector(x) . Status() == CUMULATED);
+    y.Cumulate();
+
+    FlatVector<TV> fx = x.FV<TV> ();
+    FlatVector<TV> fy = y.FV<TV> ();
+
+    // a cumulated x is contributed by the dof-master only, so we can always sum up
+    Array<TV> lx (select.Size());
+    for (int i = 0; i < select.Size(); i++)
+      lx[i] = (is_x_cum && !select_owned[i]) ? TV(0.0) : fx(select[i]);
+
+    if (comm.Rank() != master)
+      {
+        Array<TV> ly (select.Size());
+        Array<MPI_Request> requ;
+        requ.Append (comm.ISend (lx, master, MPI_TAG_SOLVE));
+        requ.Append (comm.IRecv (ly, master, MPI_TAG_SOLVE));
+        MyMPI_WaitAll (requ);
+        for (int i = 0; i < select.Size(); i++)
+          fy(select[i]) += s * ly[i];
+        return;
+      }
+
+    VVector<TV> hx(num_glob_dofs);
+    VVector<TV> hy(num_glob_dofs);
+    hx = 0.0;
+    FlatVector<TV> fhx = hx.FV();
+    
+    for (int i = 0; i < select.Size(); i++)
+      fhx(select_glob[i]) += lx[i];
+
+    Array<int> sizes(members.Size());
+    for (int i = 0; i < members.Size(); i++)
+      sizes[i] = member_glob[i].Size();
+    Table<TV> exdata(sizes);
+    for (int i = 0; i < members.Size(); i++)
+      {
+        comm.Recv (exdata[i], members[i], MPI_TAG_SOLVE);
+        FlatArray<int> glob = member_glob[i];
+        for (int j = 0; j < glob.Size(); j++)
+          fhx(glob[j]) += exdata[i][j];
+      }
+
+    // sum up the right hand sides of all groups, every master solves redundantly
+    MPI_Allreduce (MPI_IN_PLACE, hx.Memory(), num_glob_dofs*sizeof(TV)/sizeof(double),
+                   MPI_DOUBLE, MPI_SUM, masters_comm);
+    
+    hy = (*inv) * hx;
+    FlatVector<TV> fhy = hy.FV();
+
+    Array<MPI_Request> requ;
+    for (int i = 0; i < members.Size(); i++)
+      {
+        FlatArray<int> glob = member_glob[i];
+        for (int j = 0; j < glob.Size(); j++)
+          exdata[i][j] = fhy(glob[j]);
+        requ.Append (comm.ISend (exdata[i], members[i], MPI_TAG_SOLVE));
+      }
+    
+    for (int i = 0; i < select.Size(); i++)
+      fy(select[i]) += s * fhy(select_glob[i]);
+    
+    MyMPI_WaitAll (requ);
+  }
+
+
+  template class AgglomeratedInverse<double>;
+  template class AgglomeratedInverse<Complex>;
+
+#if MAX_SYS_DIM >= 1
+  template class AgglomeratedInverse<Mat<1,1,double> >;
+  template class AgglomeratedInverse<Mat<1,1,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 2
+  template class AgglomeratedInverse<Mat<2,2,double> >;
+  template class AgglomeratedInverse<Mat<2,2,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 3
+  template class AgglomeratedInverse<Mat<3,3,double> >;
+  template class AgglomeratedInverse<Mat<3,3,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 4
+  template class AgglomeratedInverse<Mat<4,4,double> >;
+  template class AgglomeratedInverse<Mat<4,4,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 5
+  template class AgglomeratedInverse<Mat<5,5,double> >;
+  template class AgglomeratedInverse<Mat<5,5,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 6
+  template class AgglomeratedInverse<Mat<6,6,double> >;
+  template class AgglomeratedInverse<Mat<6,6,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 7
+  template class AgglomeratedInverse<Mat<7,7,double> >;
+  template class AgglomeratedInverse<Mat<7,7,Complex> >;
+#endif
+#if MAX_SYS_DIM >= 8
+  template class AgglomeratedInverse<Mat<8,8,double> >;
+  template class AgglomeratedInverse<Mat<8,8,Complex> >;
+#endif
+
+
+
 
 
   
@@ -474,18 +765,64 @@ namespace ngla
     ; // delete &mat;
   }
 
+  bool ParallelMatrix :: SetupOverlap () const
+  {
+    if (overlap_checked) return inner_rows != nullptr;
+    overlap_checked = true;
+
+    // SparseMatrix::MultAdd1 multiplies the selected rows,
+    // not so for symmetric storage
+    auto spmat = dynamic_pointer_cast<BaseSparseMatrix> (mat);
+    if (!spmat || spmat->SymmetricStorage()) return false;
+    if (!dynamic_pointer_cast<S_BaseSparseMatrix<double>> (mat) &&
+        !dynamic_pointer_cast<S_BaseSparseMatrix<Complex>> (mat)) return false;
+    if (!paralleldofs || row_paralleldofs != col_paralleldofs) return false;
+
+    size_t h = mat->Height();
+    inner_rows = make_shared<BitArray> (h);
+    interface_rows = make_shared<BitArray> (h);
+    inner_rows->Clear();
+    interface_rows->Clear();
+    for (size_t i = 0; i < h; i++)
+      {
+        bool inner = true;
+        for (auto j : spmat->GetRowIndices(i))
+          if (paralleldofs->GetDistantProcs(j).Size())
+            {
+              inner = false;
+              break;
+            }
+        if (inner)
+          inner_rows->SetBit(i);
+        else
+          interface_rows->SetBit(i);
+      }
+    return true;
+  }
+  
   void ParallelMatrix :: MultAdd (double s, const BaseVector & x, BaseVector & y) const
   {
     const auto & xpar = dynamic_cast_ParallelBaseVector(x);
     auto & ypar = dynamic_cast_ParallelBaseVector(y);
-    if (op & char(2))
-      x.Cumulate();
-    else
-      x.Distribute();
     if (op & char(1))
       y.Cumulate();
     else
       y.Distribute();
+
+    if ( (op & char(2)) && xpar.Status() == DISTRIBUTED && SetupOverlap())
+      {
+        // inner rows while the exchange values of x are on the way
+        xpar.StartCumulate();
+        mat->MultAdd1 (s, *xpar.GetLocalVector(), *ypar.GetLocalVector(), inner_rows.get());
+        xpar.FinishCumulate();
+        mat->MultAdd1 (s, *xpar.GetLocalVector(), *ypar.GetLocalVector(), interface_rows.get());
+        return;
+      }
+    
+    if (op & char(2))
+      x.Cumulate();
+    else
+      x.Distribute();
     mat->MultAdd (s, *xpar.GetLocalVector(), *ypar.GetLocalVector());
   }
 
@@ -576,11 +913,13 @@ namespace ngla
     bool symmetric = dynamic_cast<const SparseMatrixSymmetric<TM>*> (mat.get()) != NULL;
     if (mat->GetInverseType() == MUMPS)
       return make_shared<ParallelMumpsInverse<TM>> (*dmat, subset, nullptr, paralleldofs, symmetric);
-    else 
 #endif
 
 #ifdef PARALLEL
-      return make_shared<MasterInverse<TM>> (*dmat, subset, paralleldofs);
+    if (mat->GetInverseType() == AGGLOMERATE)
+      return make_shared<AgglomeratedInverse<TM>> (*dmat, subset, paralleldofs,
+                                                   coarse_agglomeration_ranks);
+    return make_shared<MasterInverse<TM>> (*dmat, subset, paralleldofs);
 #endif
     throw Exception ("ParallelMatrix: don't know how to invert");
   }
@@ -17,6 +17,9 @@ namespace ngla
                                C2D = 2,   // 10
                                C2C = 3 }; // 11
 
+  /// number of ranks for the "agglomerate" coarse inverse, 0 means about sqrt(np)
+  extern NGS_DLL_HEADER int coarse_agglomeration_ranks;
+
   class ParallelMatrix : public BaseMatrix
   {
     shared_ptr<BaseMatrix> mat;
@@ -25,6 +28,12 @@ namespace ngla
     shared_ptr<ParallelDofs> row_paralleldofs, col_paralleldofs;
 
     PARALLEL_OP op;
+
+    /// rows without couplings to exchange dofs, and the remaining rows
+    mutable shared_ptr<BitArray> inner_rows, interface_rows;
+    mutable bool overlap_checked = false;
+    /// can the local product overlap with cumulating x ?
+    bool SetupOverlap () const;
     
   public:
     ParallelMatrix (shared_ptr<BaseMatrix> amat, shared_ptr<ParallelDofs> apardofs,
@@ -100,6 +109,46 @@ namespace ngla
   };
 
 
+  /*
+    Coarse grid inverse agglomerated onto a few ranks.
+
+    The ranks are split into groups of consecutive ranks. Every group
+    sends its part of the matrix to its first rank (the group master),
+    and the masters exchange the parts and factorize the whole matrix
+    redundantly. On apply, each master collects the right hand side of
+    its group, the masters sum it up by an Allreduce among themselves,
+    solve, and send the solution back to their own group only.
+  */
+  template <typename TM>
+  class AgglomeratedInverse : public BaseMatrix
+  {
+    typedef typename mat_traits<TM>::TV_ROW TV;
+    typedef typename mat_traits<TM>::TSCAL TSCAL;
+
+    shared_ptr<BaseMatrix> inv;      // only on masters
+    int master;                      // master rank of my group
+    Array<int> members;              // other ranks of the group, only on masters
+    Table<int> member_glob;          // global numbers of the members' dofs
+    Array<int> select;               // my dofs in the subset
+    Array<int> select_glob;          // and their global numbers
+    Array<bool> select_owned;        // is select[i] a master dof ?
+    size_t num_glob_dofs;
+    MPI_Comm masters_comm = MPI_COMM_NULL;
+  public:
+    AgglomeratedInverse (const SparseMatrixTM<TM> & mat, shared_ptr<BitArray> asubset, 
+                         shared_ptr<ParallelDofs> apardofs, int nmasters = 0);
+    virtual ~AgglomeratedInverse () override;
+    virtual bool IsComplex() const override { return mat_traits<TM>::IS_COMPLEX; } 
+    virtual void MultAdd (double s, const BaseVector & x, BaseVector & y) const override;
+
+    virtual int VHeight() const override { return paralleldofs->GetNDofLocal(); }
+    virtual int VWidth() const override { return paralleldofs->GetNDofLocal(); }
+
+    AutoVector CreateRowVector() const override;
+    AutoVector CreateColVector() const override;
+  };
+
+
   
   class FETI_Jump_Matrix : public BaseMatrix
   {
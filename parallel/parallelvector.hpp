@@ -75,6 +75,13 @@ namespace ngla
     { return local_vec; }
     
     virtual void Cumulate () const; 
+
+    /// starts the exchange of a distributed vector, only exchange dofs must not be modified until FinishCumulate
+    virtual void StartCumulate () const;
+    /// waits for exchange values and adds them, vector is then cumulated
+    virtual void FinishCumulate () const;
+    /// re-creates persistent requests bound to outdated memory
+    virtual void UpdateRequests () const { ; }
     
     virtual void Distribute() const = 0;
     // { cerr << "ERROR -- Distribute called for BaseVector, is not parallel" << endl; }
@@ -175,6 +182,12 @@ namespace ngla
     using ParallelBaseVector :: rreqs;
 
     Table<SCAL> * recvvalues;
+    /// sreqs/rreqs are persistent requests, sending from request_memory
+    bool persistent_requests = false;
+    void * request_memory = nullptr;
+
+    void InitRequests ();
+    void FreeRequests ();
 
     using S_BaseVectorPtr<TSCAL> :: pdata;
     using ParallelBaseVector :: local_vec;
@@ -185,6 +198,8 @@ namespace ngla
 
     virtual ~S_ParallelBaseVectorPtr ();
     virtual void SetParallelDofs (shared_ptr<ParallelDofs> aparalleldofs, const Array<int> * procs=0 );
+    /// after SetSize or AssignMemory the requests point to the old memory
+    virtual void UpdateRequests () const;
 
     virtual void Distribute() const;
     virtual ostream & Print (ostream & ost) const;
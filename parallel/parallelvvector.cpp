@@ -111,26 +111,43 @@ namespace ngla
     static Timer t("ParallelVector - Cumulate");
     RegionTimer reg(t);
     
+    StartCumulate();
+    FinishCumulate();
+  }
+
+
+  void ParallelBaseVector :: StartCumulate () const
+  {
 #ifdef PARALLEL
     if (status != DISTRIBUTED) return;
     
-    // int ntasks = paralleldofs->GetNTasks();
-    auto exprocs = paralleldofs->GetDistantProcs();
+    // persistent requests, set up in SetParallelDofs
+    // (MPI_Startall with 0 requests fails on some MPIs)
+    UpdateRequests();
+    if (rreqs.Size())
+      {
+        auto & constvec = const_cast<ParallelBaseVector&> (*this);
+        MPI_Startall(constvec.rreqs.Size(), &constvec.rreqs[0]);
+        MPI_Startall(constvec.sreqs.Size(), &constvec.sreqs[0]);
+      }
+#endif
+  }
+
+  
+  void ParallelBaseVector :: FinishCumulate () const
+  {
+#ifdef PARALLEL
+    if (status != DISTRIBUTED) return;
+    
+    static Timer t("ParallelVector - FinishCumulate");
+    RegionTimer reg(t);
     
+    auto exprocs = paralleldofs->GetDistantProcs();
     int nexprocs = exprocs.Size();
     
     ParallelBaseVector * constvec = const_cast<ParallelBaseVector * > (this);
-    
-    for (int idest = 0; idest < nexprocs; idest ++ ) 
-      constvec->ISend (exprocs[idest], sreqs[idest] );
-    for (int isender=0; isender < nexprocs; isender++)
-      constvec -> IRecvVec (exprocs[isender], rreqs[isender] );
-    
-    // if (rreqs.Size()) { // apparently Startall with 0 requests fails b/c invalid request ??
-    //   MPI_Startall(rreqs.Size(), &rreqs[0]);
-    //   MPI_Startall(sreqs.Size(), &sreqs[0]);
-    // }
 
+    // local values must not change before sending finished
     MyMPI_WaitAll (sreqs);
     
     // cumulate
@@ -259,9 +276,60 @@ namespace ngla
   template <class SCAL>
   S_ParallelBaseVectorPtr<SCAL> :: ~S_ParallelBaseVectorPtr ()
   {
+    FreeRequests();
     delete recvvalues;
   }
 
+  template <class SCAL>
+  void S_ParallelBaseVectorPtr<SCAL> :: FreeRequests ()
+  {
+#ifdef PARALLEL
+    // global or Python-held vectors may be destroyed after MPI_Finalize
+    int finalized;
+    MPI_Finalized (&finalized);
+    if (persistent_requests && !finalized)
+      {
+        for (auto & req : sreqs) MPI_Request_free (&req);
+        for (auto & req : rreqs) MPI_Request_free (&req);
+      }
+#endif
+    persistent_requests = false;
+    request_memory = nullptr;
+    sreqs.SetSize0();
+    rreqs.SetSize0();
+  }
+
+  template <class SCAL>
+  void S_ParallelBaseVectorPtr<SCAL> :: InitRequests ()
+  {
+    // Initiate persistent send/recv requests for vector cumulate operation
+    auto dps = paralleldofs->GetDistantProcs();
+    this->sreqs.SetSize(dps.Size());
+    this->rreqs.SetSize(dps.Size());
+#ifdef PARALLEL
+    for (size_t k = 0; k < dps.Size(); k++) {
+      auto p = dps[k];
+      MPI_Datatype mpi_t = this->paralleldofs->GetMPI_Type(p);
+      MPI_Send_init( this->Memory(), 1, mpi_t, p, MPI_TAG_SOLVE, this->paralleldofs->GetCommunicator(), &sreqs[k]);
+      MPI_Recv_init( &( (*recvvalues)[p][0]), (*recvvalues)[p].Size(), GetMPIType<TSCAL> (),
+		     p, MPI_TAG_SOLVE, this->paralleldofs->GetCommunicator(), &rreqs[k]);
+    }
+    persistent_requests = true;
+    request_memory = this->Memory();
+#endif
+  }
+
+  template <class SCAL>
+  void S_ParallelBaseVectorPtr<SCAL> :: UpdateRequests () const
+  {
+    if (persistent_requests && request_memory != this->Memory())
+      {
+        auto & vec = const_cast<S_ParallelBaseVectorPtr<SCAL>&> (*this);
+        vec.FreeRequests();
+        vec.InitRequests();
+      }
+  }
+
 
   template <typename SCAL>
   void S_ParallelBaseVectorPtr<SCAL> :: 
@@ -269,6 +337,7 @@ namespace ngla
   {
     if (this->paralleldofs == aparalleldofs) return;
 
+    FreeRequests();
     this -> paralleldofs = aparalleldofs;
     if ( this -> paralleldofs == 0 ) return;
     
@@ -278,18 +347,7 @@ namespace ngla
       exdofs[i] = this->es * this->paralleldofs->GetExchangeDofs(i).Size();
     delete this->recvvalues;
     this -> recvvalues = new Table<TSCAL> (exdofs);
-
-    // Initiate persistent send/recv requests for vector cumulate operation
-    auto dps = paralleldofs->GetDistantProcs();
-    this->sreqs.SetSize(dps.Size());
-    this->rreqs.SetSize(dps.Size());
-    // for (auto k : Range(dps)) {
-    //   auto p = dps[k];
-    //   MPI_Datatype mpi_t = this->paralleldofs->MyGetMPI_Type(p);
-    //   MPI_Send_init( this->Memory(), 1, mpi_t, p, MPI_TAG_SOLVE, this->paralleldofs->GetCommunicator(), &sreqs[k]);
-    //   MPI_Recv_init( &( (*recvvalues)[p][0]), (*recvvalues)[p].Size(), MyGetMPIType<TSCAL> (),
-    // 		     p, MPI_TAG_SOLVE, this->paralleldofs->GetCommunicator(), &rreqs[k]);
-    // }
+    InitRequests();
   }
 
 
@@ -47,7 +47,7 @@ from .utils import x, y, z, dx, ds, grad, Grad, curl, div, PyId, PyTrace, \
 from . import solvers
 
 
-from .timing import Timing
+from .timing import Timing, PajeToChromeTrace
 
 # add flags docu to docstring
 def _add_flags_doc(module):
@@ -1,5 +1,7 @@
 import os
 import pickle
+import json
+import shlex
 from ngsolve import TaskManager
 
 class Timing():
@@ -104,5 +106,102 @@ Compares the timing with the one saved in folder 'folder' with filename
         self.Save("benchmark")
 
 
-__all__ = ["Timing"]        
+def _ReadPaje(filename):
+    """ Yields (eventname, fields) for all events of a Paje trace file """
+    eventdefs = {}
+    current = None
+    with open(filename) as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+            if line.startswith("%"):
+                words = line[1:].split()
+                if words and words[0] == "EventDef":
+                    current = (words[2], words[1], [])
+                    eventdefs[words[2]] = current
+                elif words and words[0] == "EndEventDef":
+                    current = None
+                elif current and words:
+                    current[2].append(words[0])
+                continue
+            words = shlex.split(line)
+            _, name, fieldnames = eventdefs[words[0]]
+            yield name, dict(zip(fieldnames, words[1:]))
+
+
+def PajeToChromeTrace(tracefiles, filename="ngs_trace.json", time_scale=1000):
+    """
+Converts Paje traces to the Chrome trace format (JSON), to be viewed
+in chrome://tracing or ui.perfetto.dev.
+
+The Paje traces are written by the TaskManager with
+ngsglobals.pajetrace set, and record begin/end events of all timers
+per thread, as well as the tasks executed by the workers.
+
+Parameters
+----------
+
+tracefiles (str or list of str): Paje trace file(s). For MPI runs pass
+    one file per rank, in rank order. Each rank becomes a process in
+    the timeline, each container (thread) of the trace a thread.
+filename (str): output file name
+time_scale (float): factor from trace time units to microseconds, the
+    TaskManager writes milliseconds
+
+"""
+    if isinstance(tracefiles, str):
+        tracefiles = [tracefiles]
+
+    events = []
+    for rank, tracefile in enumerate(tracefiles):
+        names = {}        # alias -> name of containers and values
+        tids = {}         # container alias -> thread id
+        current = {}      # (container, type) -> open state of SetState
+
+        def tid(container):
+            if container not in tids:
+                tids[container] = len(tids)
+                events.append({ "name" : "thread_name", "ph" : "M", "pid" : rank, "tid" : tids[container],
+                                "args" : { "name" : names.get(container, container) } })
+            return tids[container]
+
+        def value(fields):
+            v = fields.get("Value", "")
+            return names.get(v, v)
+
+        events.append({ "name" : "process_name", "ph" : "M", "pid" : rank,
+                        "args" : { "name" : "rank %d" % rank } })
+        for name, fields in _ReadPaje(tracefile):
+            if name == "PajeCreateContainer" or name.startswith("PajeDefine"):
+                if "Alias" in fields and "Name" in fields:
+                    names[fields["Alias"]] = fields["Name"]
+                continue
+            if "Time" not in fields or "Container" not in fields:
+                continue
+            ev = { "pid" : rank, "tid" : tid(fields["Container"]),
+                   "ts" : float(fields["Time"]) * time_scale }
+            if name == "PajePushState":
+                events.append(dict(ev, ph="B", name=value(fields)))
+            elif name == "PajePopState":
+                events.append(dict(ev, ph="E"))
+            elif name == "PajeSetState":
+                # tasks: a state is active until the next one is set
+                key = (fields["Container"], fields["Type"])
+                if current.get(key):
+                    events.append(dict(ev, ph="E"))
+                current[key] = value(fields)
+                if current[key]:
+                    events.append(dict(ev, ph="B", name=current[key]))
+            elif name == "PajeNewEvent":
+                events.append(dict(ev, ph="i", s="t", name=value(fields)))
+            elif name in ("PajeSetVariable", "PajeAddVariable", "PajeSubVariable"):
+                events.append(dict(ev, ph="C", name=names.get(fields["Type"], fields["Type"]),
+                                   args={ "value" : float(fields["Value"]) }))
+
+    with open(filename, "w") as f:
+        json.dump({ "traceEvents" : events, "displayTimeUnit" : "ms" }, f)
+
+
+__all__ = ["Timing", "PajeToChromeTrace"]        
         
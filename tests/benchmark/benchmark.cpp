@@ -0,0 +1,314 @@
+/*********************************************************************/
+/* File:   benchmark.cpp                                             */
+/* Date:   2024                                                      */
+/*********************************************************************/
+
+/*
+  Micro-benchmarks for the core kernels. Problems are synthetic or
+  built from the meshes in tests/catch, so runs are reproducible.
+
+  usage:  ngs_benchmark [-o results.json] [-f filter] [-t mintime] [-n threads]
+  the kernels run inside the TaskManager, with all cores by default.
+  compare runs with compare_benchmarks.py
+*/
+
+#include <comp.hpp>
+#include <fstream>
+#include <unistd.h>
+
+using namespace ngcomp;
+
+#ifdef PARALLEL
+const char * progname = "ngs_benchmark";
+const char* ptrs[2] = { progname, nullptr };
+const char** pptr = &ptrs[0];
+static MyMPI mympi(1, (char**)pptr);
+#endif
+
+struct BenchmarkResult
+{
+  string name;
+  double time;      // seconds per call, median of the samples
+  double flops;     // per call, 0 if not counted
+  size_t calls;
+};
+
+static Array<BenchmarkResult> results;
+static string filter;
+static double mintime = 0.2;
+static int nthreads = 1;   // as used by the TaskManager
+
+template <typename FUNC>
+void Benchmark (const string & name, double flops, FUNC && f)
+{
+  if (name.find(filter) == string::npos) return;
+
+  f();   // warm up
+
+  // calls per sample, such that a sample takes about mintime/10
+  size_t ncalls = 1;
+  while (true)
+    {
+      double t = -WallTime();
+      for (size_t i = 0; i < ncalls; i++) f();
+      t += WallTime();
+      if (t > mintime/10 || ncalls > (size_t(1) << 30)) break;
+      ncalls *= 2;
+    }
+
+  Array<double> samples;
+  double total = 0;
+  while (samples.Size() < 5 || total < mintime)
+    {
+      double t = -WallTime();
+      for (size_t i = 0; i < ncalls; i++) f();
+      t += WallTime();
+      samples.Append (t / ncalls);
+      total += t;
+    }
+  QuickSort (samples);
+  double median = samples[samples.Size()/2];
+  results.Append (BenchmarkResult { name, median, flops, ncalls*samples.Size() });
+
+  cout << setw(50) << left << name << setw(12) << right << median*1e6 << " us";
+  if (flops > 0)
+    cout << setw(10) << flops/median*1e-9 << " GFlop/s";
+  cout << endl;
+}
+
+
+static void BenchmarkBLAS ()
+{
+  for (int n : { 4, 16, 64, 256 })
+    {
+      Matrix<> a(n,n), b(n,n), c(n,n);
+      for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+          {
+            a(i,j) = sin(1+i+2*j);
+            b(i,j) = cos(3*i-j);
+          }
+      c = 0;
+      double flops = 2.0*n*n*n;
+      Benchmark ("MultMatMat n="+ToString(n), flops, [&] () { MultMatMat (a, b, c); });
+      Benchmark ("AddABt n="+ToString(n), flops, [&] () { AddABt (a, b, c); });
+    }
+}
+
+
+// 5-point Laplacian on a n x n grid
+static shared_ptr<SparseMatrixTM<double>> Laplace2D (int n)
+{
+  Array<int> ii, jj;
+  Array<double> vals;
+  auto add = [&] (int i, int j, double v) { ii.Append(i); jj.Append(j); vals.Append(v); };
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      {
+        int row = i*n+j;
+        add (row, row, 4.01);
+        if (i > 0) add (row, row-n, -1);
+        if (i < n-1) add (row, row+n, -1);
+        if (j > 0) add (row, row-1, -1);
+        if (j < n-1) add (row, row+1, -1);
+      }
+  return SparseMatrixTM<double>::CreateFromCOO (ii, jj, vals, n*n, n*n);
+}
+
+static void BenchmarkSparse ()
+{
+  for (int n : { 100, 400 })
+    {
+      auto mat = Laplace2D (n);
+      auto x = mat->CreateColVector();
+      auto y = mat->CreateRowVector();
+      (*x).SetScalar (1);
+      string size = " n="+ToString(n*n);
+      
+      Benchmark ("SparseMatrix::MultAdd"+size, 2.0*mat->NZE(),
+                 [&] () { mat->MultAdd (1, *x, *y); });
+
+      // lines of the grid as blocks
+      Array<int> cnt(n);
+      cnt = n;
+      auto blocks = make_shared<Table<int>> (cnt);
+      for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+          (*blocks)[i][j] = i*n+j;
+      auto bjac = mat->CreateBlockJacobiPrecond (blocks);
+      Benchmark ("BlockJacobiPrecond::Mult"+size, 0, [&] () { bjac->Mult (*x, *y); });
+
+      mat->SetInverseType (SPARSECHOLESKY);
+      shared_ptr<BaseMatrix> inv;
+      Benchmark ("SparseCholesky factor"+size, 0, [&] () { inv = mat->InverseMatrix(); });
+      Benchmark ("SparseCholesky solve"+size, 0, [&] () { inv->Mult (*x, *y); });
+    }
+}
+
+
+template <ELEMENT_TYPE ET>
+static void BenchmarkShape (LocalHeap & lh)
+{
+  string name = ElementTopology::GetElementName(ET);
+  for (int order : { 1, 3, 6 })
+    {
+      HeapReset hr(lh);
+      H1HighOrderFE<ET> fel(order);
+      IntegrationRule ir(ET, 2*order);
+      SIMD_IntegrationRule simd_ir(ET, 2*order);
+      FlatMatrix<> shape(fel.GetNDof(), ir.Size(), lh);
+      FlatMatrix<SIMD<double>> simd_shape(fel.GetNDof(), simd_ir.Size(), lh);
+      Benchmark ("CalcShape H1 "+name+" p="+ToString(order), 0,
+                 [&] () { fel.CalcShape (ir, shape); });
+      Benchmark ("CalcShape H1 SIMD "+name+" p="+ToString(order), 0,
+                 [&] () { fel.CalcShape (simd_ir, simd_shape); });
+
+      L2HighOrderFE<ET> l2fel(order);
+      FlatMatrix<> l2shape(l2fel.GetNDof(), ir.Size(), lh);
+      Benchmark ("CalcShape L2 "+name+" p="+ToString(order), 0,
+                 [&] () { l2fel.CalcShape (ir, l2shape); });
+    }
+}
+
+
+static void BenchmarkAssembly (LocalHeap & lh)
+{
+  for (string meshfile : { "square.vol", "cube.vol" })
+    {
+      auto ma = make_shared<MeshAccess> (string(BENCHMARK_MESH_DIR) + "/" + meshfile);
+      for (int order : { 1, 3, 5 })
+        {
+          HeapReset hr(lh);
+          Flags flags;
+          flags.SetFlag ("order", order);
+          auto fes = CreateFESpace ("h1ho", ma, flags);
+          fes->Update();
+          fes->FinalizeUpdate();
+      
+          auto u = make_shared<ProxyFunction> (fes, false, false, fes->GetEvaluator(VOL), fes->GetFluxEvaluator(VOL),
+                                               nullptr, nullptr, nullptr, nullptr);
+          auto v = make_shared<ProxyFunction> (fes, true, false, fes->GetEvaluator(VOL), fes->GetFluxEvaluator(VOL),
+                                               nullptr, nullptr, nullptr, nullptr);
+          shared_ptr<CoefficientFunction> ucf = u, vcf = v;
+          SymbolicBilinearFormIntegrator bfi (InnerProduct (u->Deriv(), v->Deriv()) + ucf*vcf, VOL, VOL);
+          
+          ElementId ei(VOL, 0);
+          auto & fel = fes->GetFE (ei, lh);
+          auto & trafo = ma->GetTrafo (ei, lh);
+          FlatMatrix<> elmat(fel.GetNDof(), fel.GetNDof(), lh);
+          Benchmark (string("symbolic element matrix ")+(ma->GetDimension()==2 ? "trig" : "tet")
+                     +" p="+ToString(order), 0,
+                     [&] () { HeapReset hr(lh); bfi.CalcElementMatrix (fel, trafo, elmat, lh); });
+        }
+    }
+}
+
+
+static void BenchmarkCF (LocalHeap & lh)
+{
+  auto x = MakeCoordinateCoefficientFunction(0);
+  auto y = MakeCoordinateCoefficientFunction(1);
+  auto z = MakeCoordinateCoefficientFunction(2);
+  auto cf = x*x*y + 3*y*z - z*x*y;
+
+  IntegrationRule ir(ET_TET, 8);
+  FE_ElementTransformation<3,3> trafo(ET_TET);
+  SIMD_IntegrationRule simd_ir(ET_TET, 8);
+  SIMD_MappedIntegrationRule<3,3> simd_mir(simd_ir, trafo, lh);
+  MappedIntegrationRule<3,3> mir(ir, trafo, lh);
+  FlatMatrix<> values(ir.Size(), 1, lh);
+  FlatMatrix<SIMD<double>> simd_values(1, simd_ir.Size(), lh);
+
+  Benchmark ("CF evaluate polynomial np="+ToString(ir.Size()), 0,
+             [&] () { cf->Evaluate (mir, values); });
+  Benchmark ("CF evaluate SIMD polynomial np="+ToString(ir.Size()), 0,
+             [&] () { cf->Evaluate (simd_mir, simd_values); });
+  auto ccf = Compile (cf, false);
+  Benchmark ("CF evaluate compiled polynomial np="+ToString(ir.Size()), 0,
+             [&] () { ccf->Evaluate (simd_mir, simd_values); });
+}
+
+
+static string CPUModel ()
+{
+  ifstream cpuinfo("/proc/cpuinfo");
+  string line;
+  while (getline (cpuinfo, line))
+    if (line.find("model name") == 0)
+      return line.substr (line.find(':')+2);
+  return "unknown";
+}
+
+static string JSONString (const string & s)
+{
+  string res = "\"";
+  for (char c : s)
+    {
+      if (c == '"' || c == '\\') res += '\\';
+      res += c;
+    }
+  return res + "\"";
+}
+
+static void WriteJSON (const string & filename)
+{
+  char host[256] = "unknown";
+  gethostname (host, sizeof(host));
+  ofstream out(filename);
+  out << "{\n  \"metadata\" : {\n"
+      << "    \"ngsolve_version\" : " << JSONString(ngsolve_version) << ",\n"
+      << "    \"host\" : " << JSONString(host) << ",\n"
+      << "    \"cpu\" : " << JSONString(CPUModel()) << ",\n"
+      << "    \"threads\" : " << nthreads << ",\n"
+      << "    \"compiler\" : " << JSONString(__VERSION__) << ",\n"
+      << "    \"time\" : " << time(nullptr) << "\n  },\n"
+      << "  \"benchmarks\" : [\n";
+  for (size_t i = 0; i < results.Size(); i++)
+    {
+      auto & r = results[i];
+      out << "    { \"name\" : " << JSONString(r.name) << ", \"time\" : " << setprecision(8) << r.time
+          << ", \"flops\" : " << r.flops << ", \"calls\" : " << r.calls << " }"
+          << (i+1 < results.Size() ? ",\n" : "\n");
+    }
+  out << "  ]\n}\n";
+}
+
+
+int main (int argc, char ** argv)
+{
+  string output = "benchmark.json";
+  for (int i = 1; i+1 < argc; i += 2)
+    {
+      string arg = argv[i];
+      if (arg == "-o") output = argv[i+1];
+      else if (arg == "-f") filter = argv[i+1];
+      else if (arg == "-t") mintime = atof(argv[i+1]);
+      else if (arg == "-n") TaskManager::SetNumThreads (atoi(argv[i+1]));
+      else
+        {
+          cerr << "usage: " << argv[0] << " [-o results.json] [-f filter] [-t mintime] [-n threads]" << endl;
+          return 1;
+        }
+    }
+
+  netgen::printmessage_importance = 0;
+  LocalHeap lh(100*1000*1000, "benchmark");
+  
+  RunWithTaskManager ([&] ()
+    {
+      nthreads = TaskManager::GetNumThreads();
+      BenchmarkBLAS ();
+      BenchmarkSparse ();
+      BenchmarkShape<ET_SEGM> (lh);
+      BenchmarkShape<ET_TRIG> (lh);
+      BenchmarkShape<ET_QUAD> (lh);
+      BenchmarkShape<ET_TET> (lh);
+      BenchmarkShape<ET_PRISM> (lh);
+      BenchmarkShape<ET_HEX> (lh);
+      BenchmarkAssembly (lh);
+      BenchmarkCF (lh);
+    });
+
+  WriteJSON (output);
+  return 0;
+}
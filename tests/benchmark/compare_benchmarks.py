@@ -0,0 +1,55 @@
+"""
+Compares two result files of ngs_benchmark.
+
+usage: compare_benchmarks.py baseline.json current.json [--threshold 0.1]
+
+Lists the relative change of every benchmark and exits with status 1
+if a benchmark got slower by more than the threshold. A new baseline
+is made by copying the current results.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+def main():
+    parser = argparse.ArgumentParser(description="compare ngs_benchmark results")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.1,
+                        help="relative slowdown counted as regression")
+    parser.add_argument("--missing-ok", action="store_true",
+                        help="succeed if there is no baseline")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.baseline) and args.missing_ok:
+        print("no baseline", args.baseline)
+        return 0
+
+    base = json.load(open(args.baseline))
+    cur = json.load(open(args.current))
+    for key in ("cpu", "threads", "compiler"):
+        if base["metadata"].get(key) != cur["metadata"].get(key):
+            print("WARNING: different %s: '%s' vs '%s'" % (key, base["metadata"].get(key), cur["metadata"].get(key)))
+
+    basetimes = { b["name"] : b["time"] for b in base["benchmarks"] }
+    regressions = []
+    for b in cur["benchmarks"]:
+        if b["name"] not in basetimes:
+            print("%-50s %12s" % (b["name"], "new"))
+            continue
+        change = b["time"] / basetimes[b["name"]] - 1
+        mark = ""
+        if change > args.threshold:
+            mark = "  REGRESSION"
+            regressions.append(b["name"])
+        print("%-50s %+11.1f%%%s" % (b["name"], 100*change, mark))
+
+    if regressions:
+        print("%d regression(s) above %g%%" % (len(regressions), 100*args.threshold))
+        return 1
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
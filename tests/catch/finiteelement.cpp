@@ -1,6 +1,7 @@
 
 #include "catch.hpp"
 #include <fem.hpp>
+#include "../../fem/l2hofetp.hpp"
 
 using namespace ngfem;
 
@@ -127,3 +128,45 @@ TEST_CASE ("FiniteElement", "[fem][finiteelement]")
         });
     }
 }
+
+TEST_CASE ("L2HighOrderFETP trace", "[fem][finiteelement][l2][SIMD]")
+{
+  LocalHeap lh(1000000, "l2tp trace");
+  int vnums[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  for (auto order : Range(1,6))
+    SECTION ("order = " + std::to_string(order),"")
+      {
+        L2HighOrderFETP<ET_HEX> fel(order, vnums, lh);
+        Vector<> coefs(fel.GetNDof()), coefs_tp(fel.GetNDof()), coefs_ref(fel.GetNDof());
+        for (auto i : Range(coefs.Size()))
+          coefs[i] = sin(1.0+i);
+
+        SIMD_IntegrationRule irfacet(ET_QUAD, 2*order);
+        Facet2ElementTrafo transform(ET_HEX, FlatArray<int>(8, vnums));
+        for (int fnr : Range(6))
+          {
+            HeapReset hr(lh);
+            auto & ir = transform(fnr, irfacet, lh);
+            REQUIRE(ir.IsTP());
+            SIMD_IntegrationRule irgen = ir.Clone();
+            irgen.SetIRX(nullptr);
+
+            Vector<SIMD<double>> values(ir.Size()), values_ref(ir.Size());
+            fel.Evaluate(ir, coefs, values);
+            fel.Evaluate(irgen, coefs, values_ref);
+            double err = 0;
+            for (auto i : Range(ir.GetNIP()))
+              err += sqr(values(i/SIMD<double>::Size())[i%SIMD<double>::Size()] -
+                         values_ref(i/SIMD<double>::Size())[i%SIMD<double>::Size()]);
+            CHECK(sqrt(err) < 1e-10);
+
+            // padding lanes don't belong to the rule
+            for (auto i : Range(ir.GetNIP(), ir.Size()*SIMD<double>::Size()))
+              ((double*)&values_ref(0))[i] = 0.0;
+            coefs_tp = 0.0; coefs_ref = 0.0;
+            fel.AddTrans(ir, values_ref, coefs_tp);
+            fel.AddTrans(irgen, values_ref, coefs_ref);
+            CHECK(L2Norm(coefs_tp-coefs_ref) < 1e-10);
+          }
+      }
+}
@@ -1,5 +1,9 @@
 #include "catch.hpp"
 #include <bla.hpp>
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 using namespace ngbla;
 
 void SetRandom (SliceMatrix<> mat)
@@ -220,6 +224,154 @@ TEST_CASE ("SubAtDB", "[ngblas]") {
     }
 }
 
+TEST_CASE ("AddABt SIMD<Complex>", "[ngblas]") {
+    constexpr int SW = SIMD<double>::Size();
+    for (size_t n : { 1, 3, 8, 13 }) {
+        SECTION ("n = "+to_string(n)) {
+            size_t ha = n, hb = n+2, w = 2*n+1;
+            Matrix<SIMD<Complex>> a(ha, w), b(hb, w);
+            for (size_t i = 0; i < ha; i++)
+                for (size_t k = 0; k < w; k++)
+                    a(i,k) = SIMD<Complex> (SIMD<double>([&] (int l) -> double { return sin(1.0+i+3*k+5*l); }),
+                                            SIMD<double>([&] (int l) -> double { return cos(2.0*i-k+l); }));
+            for (size_t j = 0; j < hb; j++)
+                for (size_t k = 0; k < w; k++)
+                    b(j,k) = SIMD<Complex> (SIMD<double>([&] (int l) -> double { return cos(3.0+j+2*k-l); }),
+                                            SIMD<double>([&] (int l) -> double { return sin(1.0*j*k+l); }));
+
+            Matrix<Complex> c(ha, hb), ref(ha, hb);
+            c = Complex(1.0, 2.0);
+            ref = Complex(1.0, 2.0);
+            AddABt (a, b, c);
+            for (size_t i = 0; i < ha; i++)
+                for (size_t j = 0; j < hb; j++)
+                    for (size_t k = 0; k < w; k++)
+                        for (int l = 0; l < SW; l++)
+                            ref(i,j) += Complex(a(i,k).real()[l], a(i,k).imag()[l])
+                                * Complex(b(j,k).real()[l], b(j,k).imag()[l]);
+            CHECK(L2Norm(c-ref) < 1e-12 * L2Norm(ref));
+        }
+    }
+}
+
+TEST_CASE ("BlasTuning", "[ngblas]") {
+    BlasTuning defaults = blas_tuning;
+    BlasTuning candidates[] = {
+        { 4, 64, 3, 3, 48, 16, 128, 4 },
+        { 6, 192, 6, 6, 192, 64, 512, 12 },
+        { 4, 128, 6, 3, 96, 32, 256, 7 } };
+    size_t n = 150, m = 200, k = 70;
+    Matrix<> a(n,m), b(m,k), bt(k,m), c(n,k), ref(n,k);
+    SetRandom(a);
+    SetRandom(b);
+    bt = Trans(b);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < k; j++) {
+            double sum = 0;
+            for (size_t l = 0; l < m; l++)
+                sum += a(i,l) * b(l,j);
+            ref(i,j) = sum;
+        }
+
+    for (auto & tuning : candidates) {
+        SECTION ("multab_ha = "+to_string(tuning.multab_ha)+", abt_ha = "+to_string(tuning.abt_ha)) {
+            SetBlasTuning (tuning);
+
+            MultMatMat (a, b, c);
+            CHECK(L2Norm(c-ref) < 1e-10);
+
+            c = 0.0;
+            AddABt (a, bt, c);
+            CHECK(L2Norm(c-ref) < 1e-10);
+
+            Matrix<> at = Trans(a);
+            MultAtB (at, b, c);
+            CHECK(L2Norm(c-ref) < 1e-10);
+
+            Matrix<> sym(n,n), symref(n,n);
+            sym = 0.0;
+            AddABtSym (a, a, sym);
+            for (size_t i = 0; i < n; i++)
+                for (size_t j = 0; j <= i; j++) {
+                    double sum = 0;
+                    for (size_t l = 0; l < m; l++)
+                        sum += a(i,l) * a(j,l);
+                    CHECK(fabs(sym(i,j)-sum) < 1e-10);
+                }
+        }
+    }
+    CHECK_THROWS (SetBlasTuning (BlasTuning{ 5, 128, 3, 3, 96, 32, 256, 8 }));
+    SetBlasTuning (defaults);
+}
+
+TEST_CASE ("Batched", "[ngblas]") {
+    // 11 matrices: a partially filled group of SIMD lanes
+    size_t nb = 11;
+    for (size_t n : { 1, 5, 17, 40 }) {
+        SECTION ("n = "+to_string(n)) {
+            Array<Matrix<>> mats(nb), spd(nb), res(nb), res2(nb);
+            Array<FlatMatrix<>> fmats(nb), fspd(nb), fres(nb), fres2(nb);
+            Array<Vector<>> lam(nb);
+            Array<FlatVector<>> flam(nb);
+            for (size_t i = 0; i < nb; i++) {
+                mats[i].SetSize(n,n);
+                SetRandom(mats[i]);
+                mats[i] *= 1.0+i;
+                spd[i] = Trans(mats[i]) * mats[i];
+                for (size_t j = 0; j < n; j++)
+                    spd[i](j,j) += 1;
+                res[i].SetSize(n,n);
+                res2[i].SetSize(n,n);
+                lam[i].SetSize(n);
+                fmats[i].AssignMemory(n, n, mats[i].Data());
+                fspd[i].AssignMemory(n, n, spd[i].Data());
+                fres[i].AssignMemory(n, n, res[i].Data());
+                fres2[i].AssignMemory(n, n, res2[i].Data());
+                flam[i].AssignMemory(n, lam[i].Data());
+            }
+
+            BatchedMultMatMat (fmats, fspd, fres);
+            for (size_t i = 0; i < nb; i++)
+                CHECK(L2Norm(res[i] - mats[i]*spd[i]) < 1e-10 * L2Norm(res[i]));
+
+            for (size_t i = 0; i < nb; i++)
+                res[i] = spd[i];
+            BatchedCholesky (fres);
+            for (size_t i = 0; i < nb; i++)
+                CHECK(L2Norm(res[i]*Trans(res[i]) - spd[i]) < 1e-10 * L2Norm(spd[i]));
+
+            for (size_t i = 0; i < nb; i++)
+                res[i] = spd[i];
+            BatchedInverse (fres);
+            for (size_t i = 0; i < nb; i++) {
+                Matrix<> id = res[i] * spd[i];
+                for (size_t j = 0; j < n; j++)
+                    id(j,j) -= 1;
+                CHECK(L2Norm(id) < 1e-8);
+            }
+
+            BatchedSymEig (fspd, flam, fres);
+            for (size_t i = 0; i < nb; i++)
+                for (size_t j = 0; j < n; j++) {
+                    Vector<> v = res[i].Row(j);
+                    CHECK(L2Norm(spd[i]*v - lam[i](j)*v) < 1e-8 * L2Norm(spd[i]));
+                    if (j > 0) CHECK(lam[i](j-1) <= lam[i](j));
+                }
+        }
+    }
+
+    Matrix<> indef(2,2), chol(2,2);
+    indef = 0.0;
+    indef(0,1) = indef(1,0) = 1;
+    chol = indef;
+    Array<FlatMatrix<>> a(1);
+    a[0].AssignMemory(2, 2, indef.Data());
+    BatchedInverse (a);
+    CHECK(L2Norm(indef-chol) < 1e-14);
+    a[0].AssignMemory(2, 2, chol.Data());
+    CHECK_THROWS (BatchedCholesky (a));
+}
+
 template <int N=SIMD<double>::Size()>
 void TestSIMD()
 {
@@ -322,3 +474,27 @@ TEST_CASE ("Vec", "[double]") {
     for (int i : Range(N))
       CHECK(v1[i] == vals[i]);
 }
+
+TEST_CASE ("PerfRegion", "[perfcounters]") {
+    // without counters (no build support, or perf_event_paranoid) the
+    // regions are inactive and must not touch other file descriptors
+    static Timer t("test PerfRegion");
+#ifdef __linux__
+    int fd = dup(0);
+#endif
+    PerfCounters::Enable(true);
+    for (bool allthreads : { false, true }) {
+        PerfRegion perf(t, allthreads);
+        Vector<> v(1000);
+        v = 1.0;
+        CHECK(L2Norm(v) > 0);
+    }
+    PerfCounters::Enable(false);
+    {
+        PerfRegion perf(t);
+    }
+#ifdef __linux__
+    CHECK(fcntl(fd, F_GETFD) != -1);
+    close(fd);
+#endif
+}
@@ -0,0 +1,29 @@
+from ngsolve import *
+from ngsolve.la import SetCoarseAgglomerationRanks
+import pytest
+
+def solve_poisson(mesh, inverse):
+    fes = H1(mesh, order=2, dirichlet=".*")
+    u,v = fes.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx+u*v*dx).Assemble()
+    f = LinearForm(x*y*v*dx).Assemble()
+    gfu = GridFunction(fes)
+    gfu.vec.data = a.mat.Inverse(fes.FreeDofs(), inverse=inverse) * f.vec
+    return gfu
+
+# the agglomerated inverse must reproduce the master inverse,
+# with the default group size and with a non-default one
+@pytest.mark.parametrize("ranks", [0, 2])
+def test_agglomerated_inverse(ranks):
+    comm = MPI_Init()
+    mesh = Mesh('square.vol.gz', comm)
+    ref = solve_poisson(mesh, "masterinverse")
+    SetCoarseAgglomerationRanks(ranks)
+    try:
+        gfu = solve_poisson(mesh, "agglomerate")
+    finally:
+        SetCoarseAgglomerationRanks(0)
+    err = sqrt(Integrate((gfu-ref)**2, mesh))
+    nref = sqrt(Integrate(ref**2, mesh))
+    assert err < 1e-10*nref
+    comm.Barrier()
@@ -0,0 +1,20 @@
+from ngsolve import *
+
+# save on all ranks, load again on a single rank
+def test_collective_save_load():
+    comm = MPI_Init()
+    mesh = Mesh('square.vol.gz', comm)
+    fes = H1(mesh, order=3)
+    gfu = GridFunction(fes)
+    gfu.Set(x*x*y+sin(3*y))
+    gfu.Save('checkpoint.ngs', collective=True)
+    ref = Integrate(gfu*gfu, mesh)
+    comm.Barrier()
+
+    mecomm = comm.SubComm([comm.rank])
+    if comm.rank == 0:
+        mesh1 = Mesh('square.vol.gz', mecomm)
+        gfu1 = GridFunction(H1(mesh1, order=3))
+        gfu1.Load('checkpoint.ngs', collective=True)
+        assert abs(Integrate(gfu1*gfu1, mesh1)-ref) < 1e-10*abs(ref)
+    comm.Barrier()
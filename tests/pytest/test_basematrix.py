@@ -68,3 +68,31 @@ def test_derive_basematrix_lifetime():
 
 
 
+
+
+def test_hodlr_matrix():
+    import numpy as np
+    from ngsolve.la import HODLRMatrix
+    n = 500
+    pts = np.linspace(0, 1, n)
+    a = Matrix(n, n)
+    a.NumPy()[:,:] = 1/(1+np.abs(pts[:,None]-pts[None,:])) + n*np.eye(n)
+
+    h = HODLRMatrix(a, tol=1e-10, leafsize=32)
+    assert h.maxrank < 30
+    assert h.nze < n*n/2
+
+    x = CreateVVector(n)
+    y = CreateVVector(n)
+    x.FV().NumPy()[:] = np.random.rand(n)
+    y.data = h * x
+    ydense = a.NumPy() @ x.FV().NumPy()
+    assert np.linalg.norm(y.FV().NumPy()-ydense) < 1e-8 * np.linalg.norm(ydense)
+
+    y.data = h.T * x
+    ydense = a.NumPy().T @ x.FV().NumPy()
+    assert np.linalg.norm(y.FV().NumPy()-ydense) < 1e-8 * np.linalg.norm(ydense)
+
+    z = CreateVVector(n)
+    z.data = h.Inverse() * y
+    assert np.linalg.norm(z.FV().NumPy()-x.FV().NumPy()) < 1e-8 * np.linalg.norm(x.FV().NumPy())
@@ -69,6 +69,30 @@ def test_evaluate(unit_mesh_2d):
     assert vals2 == approx(np.array(list(zip([0.5 + 0J] * 10, pnts*1J))))
     assert x(unit_mesh_2d(0.5,0.5)) == approx(0.5)
 
+def test_voxel_memmap(unit_mesh_2d, tmpdir):
+    import numpy as np
+    data = np.random.rand(20, 30)
+    filename = str(tmpdir.join("voxels.npy"))
+    np.save(filename, data)
+    for linear in [True, False]:
+        cf = VoxelCoefficient((0,0), (1,1), data, linear=linear)
+        cf_mapped = VoxelCoefficient((0,0), (1,1), filename, linear=linear)
+        assert Integrate(cf_mapped, unit_mesh_2d, order=4) == approx(Integrate(cf, unit_mesh_2d, order=4))
+        for p in [(0.1,0.7), (0.55,0.2), (1,1)]:
+            assert cf_mapped(unit_mesh_2d(*p)) == approx(cf(unit_mesh_2d(*p)))
+
+def test_voxel_linear_scalar_simd(unit_mesh_2d):
+    import numpy as np
+    # bilinear interpolation reproduces x+y, scalar cf(mip) and the
+    # SIMD evaluation in Integrate have to agree
+    n = 11
+    data = np.array([[(i+j)/(n-1) for j in range(n)] for i in range(n)])
+    cf = VoxelCoefficient((0,0), (1,1), data, linear=True)
+    for p in [(0.13,0.71), (0.55,0.24), (0.97,0.05), (1,1)]:
+        assert cf(unit_mesh_2d(*p)) == approx(sum(p))
+    assert Integrate(cf, unit_mesh_2d, order=2) == approx(1)
+    assert Integrate(cf*x, unit_mesh_2d, order=3) == approx(7/12)
+
 if __name__ == "__main__":
     test_pow()
     test_ParameterCF()
@@ -25,3 +25,46 @@ def test_integrate_xy():
     intC = Integrate(1j*x*y,mesh)
     assert abs(intR-1./4) < 1e-14
     assert abs(intC- 1j*1./4) < 1e-14
+
+def test_registered_intrule():
+    from ngsolve.fem import RegisterIntegrationRule, GetIntegrationRule
+    ir = GetIntegrationRule("gausslobatto", ET.SEGM, 4)
+    assert len(ir) == 3
+    assert abs(sum(ir.weights)-1) < 1e-14
+    assert abs(ir.points[0][0]) < 1e-14 and abs(ir.points[-1][0]-1) < 1e-14
+
+    RegisterIntegrationRule("midpoint", ET.TRIG, IntegrationRule([(1/3,1/3)], [0.5]))
+    assert len(GetIntegrationRule("midpoint", ET.TRIG, 7)) == 1
+
+    # Gauss-Lobatto points in the vertices lump the P1 mass matrix
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3, quad_dominated=True))
+    fes = H1(mesh, order=1)
+    u,v = fes.TnT()
+    bfi = SymbolicBFI(u*v)
+    bfi.SetIntegrationRule("gausslobatto")
+    a = BilinearForm(fes)
+    a += bfi
+    a.Assemble()
+    rows,cols,vals = a.mat.COO()
+    for r,c,val in zip(rows,cols,vals):
+        if r != c:
+            assert abs(val) < 1e-14
+    assert abs(sum(vals)-1) < 1e-12
+
+def test_gausslobatto_simplices():
+    # no Gauss-Lobatto rules on simplices, the default rules are used
+    from ngsolve.fem import GetIntegrationRule
+    with pytest.raises(Exception):
+        GetIntegrationRule("gausslobatto", ET.TRIG, 4)
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.3))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    a = BilinearForm(u*v*dx).Assemble()
+    bfi = SymbolicBFI(u*v)
+    bfi.SetIntegrationRule("gausslobatto")
+    agl = BilinearForm(fes)
+    agl += bfi
+    agl.Assemble()
+    diff = a.mat.CreateMatrix()
+    diff.AsVector().data = a.mat.AsVector() - agl.mat.AsVector()
+    assert Norm(diff.AsVector()) < 1e-12 * Norm(a.mat.AsVector())
@@ -99,7 +99,123 @@ def test_sparsematrix_access():
     a.Assemble()
     assert abs(a.mat[1,1][0,0] - (reference_values[3])) < 1e-8
 
+def test_precomputed_apply():
+    mesh = Mesh(unit_cube.GenerateMesh(maxh=0.4))
+    fes = HCurl(mesh, order=3)
+    u,v = fes.TnT()
+    a = BilinearForm(fes)
+    a += SymbolicBFI(curl(u)*curl(v) + u*v)
+    a.Assemble()
+
+    x = a.mat.CreateColVector()
+    x.SetRandom()
+    y = x.CreateVector()
+    y.data = a.mat * x
+
+    z = x.CreateVector()
+    for flags in [ { }, { "precompute_single" : True }, { "precompute_memory" : 0.05 } ]:
+        apre = BilinearForm(fes, nonassemble=True, precompute=True, **flags)
+        apre += SymbolicBFI(curl(u)*curl(v) + u*v)
+        apre.Assemble()
+        z.data = apre.mat * x
+        z.data -= y
+        tol = 1e-5 if "precompute_single" in flags else 1e-10
+        assert Norm(z) < tol * Norm(y)
+
+@pytest.mark.parametrize("quads", [False, True])
+def test_dg_skeleton_apply(quads):
+    # the matrix-free DG apply runs over batches of equal facet classes
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2, quad_dominated=quads))
+    fes = L2(mesh, order=3, dgjumps=True)
+    u,v = fes.TnT()
+    n = specialcf.normal(2)
+    h = specialcf.mesh_size
+    alpha = 40
+    jump = lambda w : w-w.Other()
+    mean_dn = lambda w : 0.5*n*(grad(w)+grad(w.Other()))
+    form = grad(u)*grad(v)*dx \
+        + (alpha/h*jump(u)*jump(v) - mean_dn(u)*jump(v) - mean_dn(v)*jump(u)) * dx(skeleton=True) \
+        + (alpha/h*u*v - n*grad(u)*v - n*grad(v)*u) * ds(skeleton=True)
+
+    a = BilinearForm(fes)
+    a += form
+    a.Assemble()
+    anon = BilinearForm(fes, nonassemble=True)
+    anon += form
+    anon.Assemble()
+
+    x = a.mat.CreateColVector()
+    x.SetRandom()
+    y = x.CreateVector()
+    z = x.CreateVector()
+    y.data = a.mat * x
+    z.data = anon.mat * x
+    z.data -= y
+    assert Norm(z) < 1e-10 * Norm(y)
+
+def test_mapped_binary(tmp_path):
+    import ngsolve.la as la
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=2)
+    u,v = fes.TnT()
+    for symmetric in [False, True]:
+        a = BilinearForm(fes, symmetric=symmetric)
+        a += SymbolicBFI(grad(u)*grad(v)+u*v)
+        a.Assemble()
+        x = a.mat.CreateColVector()
+        x.SetRandom()
+        matfile = str(tmp_path / "mapped_mat.bin")
+        vecfile = str(tmp_path / "mapped_vec.bin")
+        la.SaveBinary(a.mat, matfile)
+        la.SaveBinary(x, vecfile)
+
+        mat = la.LoadMapped(matfile)
+        xm = la.LoadMapped(vecfile)
+        assert mat.nze == a.mat.nze
+        diff = x.CreateVector()
+        diff.data = x - xm
+        assert Norm(diff) == 0
+        y = x.CreateVector()
+        y.data = a.mat * x - mat * xm
+        assert Norm(y) < 1e-12 * Norm(x)
+
+        # copy-on-write, the file keeps the saved values
+        xm[:] = 0
+        assert Norm(xm) == 0
+        mat.AsVector()[:] = 0
+        assert Norm(mat.AsVector()) == 0
+        xm2 = la.LoadMapped(vecfile)
+        diff.data = x - xm2
+        assert Norm(diff) == 0
+
+    with pytest.raises(Exception, match="only SparseMatrix"):
+        la.SaveBinary(IdentityMatrix(5), str(tmp_path / "identity.bin"))
+
+def test_memory_usage():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3)
+    u,v = fes.TnT()
+    before = MemoryUsage()["matrices"]["current"]
+    ResetPeakMemory()
+    a = BilinearForm(fes, symmetric=True)
+    a += SymbolicBFI(grad(u)*grad(v)+u*v)
+    a.Assemble()
+    mem = MemoryUsage()
+    assert mem["matrices"]["current"] - before >= 8*a.mat.nze
+    inv = a.mat.Inverse(inverse="sparsecholesky")
+    assert MemoryUsage()["factorizations"]["current"] > 0
+    del a, inv
+    mem = MemoryUsage()
+    assert mem["matrices"]["current"] == before
+    assert mem["matrices"]["peak"] > before
+
 if __name__ == "__main__":
+    import pathlib, tempfile
     test_matrix()
     test_matrix_numpy()
     test_sparsematrix_access()
+    test_precomputed_apply()
+    test_dg_skeleton_apply(False)
+    test_dg_skeleton_apply(True)
+    test_mapped_binary(pathlib.Path(tempfile.mkdtemp()))
+    test_memory_usage()
@@ -42,6 +42,186 @@ def test_arnoldi():
 
     Draw(laplace(evec),mesh,"laplace")
 
+def test_arnoldi_inverse_reuse():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=4, dirichlet="top|bottom|left|right", complex=True)
+    u,v = fes.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx).Assemble()
+    m = BilinearForm(u*v*dx).Assemble()
+
+    # one factorization near the lowest eigenvalue, used for two targets
+    sigma = 10
+    mat = a.mat.CreateMatrix()
+    mat.AsVector().data = a.mat.AsVector() - sigma * m.mat.AsVector()
+    inv = mat.Inverse(fes.FreeDofs())
+
+    gfu = GridFunction(fes, multidim=3)
+    for target, exact in [(20, 2*pi**2), (50, 5*pi**2)]:
+        lam = ArnoldiSolver(a.mat, m.mat, fes.FreeDofs(), list(gfu.vecs), shift=target,
+                            inverse=inv, inverseshift=sigma, tol=1e-10)
+        assert abs(lam[0].real-exact) < 1e-4*exact
+
+# A = 2 M, the Krylov space is invariant after the first step
+def test_arnoldi_breakdown():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = L2(mesh, order=0, complex=True)
+    u,v = fes.TnT()
+    a = BilinearForm(2*u*v*dx).Assemble()
+    m = BilinearForm(u*v*dx).Assemble()
+    gfu = GridFunction(fes, multidim=2)
+    lam = ArnoldiSolver(a.mat, m.mat, fes.FreeDofs(), list(gfu.vecs), shift=1)
+    for l in lam:
+        assert abs(l-2) < 1e-8
+
+def test_lobpcg():
+    from ngsolve.la import LOBPCG
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    fes = H1(mesh, order=4, dirichlet="top|bottom|left|right")
+    u,v = fes.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx).Assemble()
+    m = BilinearForm(u*v*dx).Assemble()
+    pre = a.mat.Inverse(fes.FreeDofs())
+
+    lam, vecs = LOBPCG(a.mat, m.mat, pre, num=4, tol=1e-10)
+    exact = [2*pi**2, 5*pi**2, 5*pi**2, 8*pi**2]
+    for l, le in zip(lam, exact):
+        assert abs(l-le) < 1e-4*le
+    ip = vecs.InnerProduct(m.mat * vecs)
+    for i in range(4):
+        for j in range(4):
+            assert abs(ip[i,j] - (1 if i==j else 0)) < 1e-8
+
+def test_single_precision_preconditioner():
+    from ngsolve.la import SinglePrecision
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=3, dirichlet="top|bottom|left|right")
+    u,v = fes.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx+u*v*dx).Assemble()
+    f = LinearForm(v*dx).Assemble()
+
+    blocks = [list(fes.GetDofNrs(vert)) + [d for e in vert.edges for d in fes.GetDofNrs(e)]
+              for vert in mesh.vertices]
+    blocks = [[d for d in b if fes.FreeDofs()[d]] for b in blocks]
+    blocks = [b for b in blocks if len(b)]
+    asym = BilinearForm(grad(u)*grad(v)*dx+u*v*dx, symmetric=True).Assemble()
+    for mat in [a.mat, a.mat.CreateSmoother(fes.FreeDofs()), a.mat.CreateBlockSmoother(blocks),
+                asym.mat, asym.mat.CreateBlockSmoother(blocks)]:
+        matf = SinglePrecision(mat)
+        x = f.vec.CreateVector()
+        xf = f.vec.CreateVector()
+        x.data = mat * f.vec
+        xf.data = matf * f.vec
+        assert Norm(x-xf) < 1e-6 * Norm(x)
+
+    gfu = GridFunction(fes)
+    pre = SinglePrecision(a.mat.CreateBlockSmoother(blocks))
+    inv = CGSolver(a.mat, pre, precision=1e-12, maxsteps=500)
+    gfu.vec.data = inv * f.vec
+    r = f.vec.CreateVector()
+    r.data = f.vec - a.mat * gfu.vec
+    fd = Projector(fes.FreeDofs(), True)
+    assert Norm(fd*r) < 1e-9 * Norm(f.vec)
+
+def test_sparsecholesky_outofcore(tmp_path):
+    from ngsolve.la import SetCholeskyOutOfCore
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.05))
+    fes = H1(mesh, order=3, dirichlet="top|bottom|left|right")
+    u,v = fes.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx).Assemble()
+    f = LinearForm(v*dx).Assemble()
+
+    inv = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky")
+    assert not inv.outofcore
+    x = f.vec.CreateVector()
+    x.data = inv * f.vec
+
+    # a budget below the factor size forces the scratch file
+    SetCholeskyOutOfCore(memory_budget=10000, directory=str(tmp_path))
+    try:
+        invooc = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky")
+    finally:
+        SetCholeskyOutOfCore(memory_budget=0)
+    assert invooc.outofcore
+    xooc = f.vec.CreateVector()
+    xooc.data = invooc * f.vec
+    assert Norm(x-xooc) < 1e-12 * Norm(x)
+    # the selected inverse would be as large as the factor, in core
+    with pytest.raises(Exception, match="out-of-core"):
+        invooc.InverseDiagonal()
+
+def test_sparsecholesky_selected_inverse():
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=2, dirichlet="top|bottom|left|right")
+    u,v = fes.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx).Assemble()
+    inv = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky")
+    before = MemoryUsage()["factorizations"]["current"]
+    d = inv.InverseDiagonal()
+    # the selected inverse is as large as the factor
+    assert MemoryUsage()["factorizations"]["current"] - before >= 8*inv.nze
+
+    free = [i for i in range(fes.ndof) if fes.FreeDofs()[i]]
+    e = a.mat.CreateColVector()
+    x = a.mat.CreateColVector()
+    for i in free[::10]:
+        e[:] = 0
+        e[i] = 1
+        x.data = inv * e
+        assert abs(d[i]-x[i]) < 1e-10 * abs(x[i])
+        assert abs(inv.InverseEntry(i,i)-x[i]) < 1e-10 * abs(x[i])
+        # a point load, solution only at a few dofs
+        y = a.mat.CreateColVector()
+        y[:] = 0
+        inv.SolveSparse(e, y, rhsdofs=[i], soldofs=free[:5])
+        for j in free[:5]:
+            assert abs(y[j]-x[j]) < 1e-10 * Norm(x)
+        inv.SolveSparse(e, y, rhsdofs=[i])
+        assert Norm(y-x) < 1e-10 * Norm(x)
+    for i in range(fes.ndof):
+        if not fes.FreeDofs()[i]:
+            assert d[i] == 0
+
+def test_sparsecholesky_update():
+    from ngsolve.bla import Matrix
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.1))
+    fes = H1(mesh, order=2, dirichlet="top|bottom|left|right")
+    u,v = fes.TnT()
+    a = BilinearForm(grad(u)*grad(v)*dx).Assemble()
+    f = LinearForm(v*dx).Assemble()
+    free = [i for i in range(fes.ndof) if fes.FreeDofs()[i]]
+    dofs = free[::40]
+
+    inv = a.mat.Inverse(fes.FreeDofs(), inverse="sparsecholesky")
+    x0 = f.vec.CreateVector()
+    x0.data = inv * f.vec
+
+    # penalty at a few dofs, as for an active set
+    w = Matrix(len(dofs), len(dofs))
+    for k in range(len(dofs)):
+        for l in range(len(dofs)):
+            w[k,l] = 10 if k==l else 0
+    pen = a.mat.CreateMatrix()
+    pen.AsVector().data = a.mat.AsVector()
+    for d in dofs:
+        pen[d,d] += 100
+    x = f.vec.CreateVector()
+    x.data = pen.Inverse(fes.FreeDofs(), inverse="sparsecholesky") * f.vec
+
+    inv.UpdateLowRank(dofs, w)
+    y = f.vec.CreateVector()
+    y.data = inv * f.vec
+    assert Norm(y-x) < 1e-10 * Norm(x)
+    inv.UpdateLowRank(dofs, w, sigma=-1)
+    y.data = inv * f.vec
+    assert Norm(y-x0) < 1e-10 * Norm(x0)
+
+    # change the matrix in place, refactor only the affected supernodes
+    for d in dofs:
+        a.mat[d,d] += 100
+    inv.UpdatePartial(dofs)
+    y.data = inv * f.vec
+    assert Norm(y-x) < 1e-10 * Norm(x)
+
 def test_newton_with_dirichlet():
     mesh = Mesh (unit_square.GenerateMesh(maxh=0.3))
     V = H1(mesh, order=3, dirichlet=[1,2,3,4])
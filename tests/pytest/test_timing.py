@@ -0,0 +1,55 @@
+from ngsolve import PajeToChromeTrace
+import json
+
+paje = """%EventDef PajeDefineEntityValue 4
+%       Alias string
+%       Type string
+%       Name string
+%EndEventDef
+%EventDef PajeCreateContainer 5
+%       Time date
+%       Alias string
+%       Type string
+%       Container string
+%       Name string
+%EndEventDef
+%EventDef PajeSetState 10
+%       Time date
+%       Type string
+%       Container string
+%       Value string
+%EndEventDef
+%EventDef PajePushState 11
+%       Time date
+%       Type string
+%       Container string
+%       Value string
+%EndEventDef
+%EventDef PajePopState 12
+%       Time date
+%       Type string
+%       Container string
+%EndEventDef
+4 a1 T "SparseCholesky - factor"
+5 0 c1 C 0 "thread 0"
+11 0.5 T c1 a1
+10 0.6 S c1 "task 3"
+10 0.8 S c1 ""
+12 1.5 T c1
+"""
+
+def test_paje_to_chrome(tmp_path):
+    tracefile = str(tmp_path / "test.trace")
+    jsonfile = str(tmp_path / "test_trace.json")
+    open(tracefile, "w").write(paje)
+    PajeToChromeTrace(tracefile, jsonfile)
+    events = json.load(open(jsonfile))["traceEvents"]
+    begin = [e for e in events if e["ph"] == "B"]
+    end = [e for e in events if e["ph"] == "E"]
+    assert [e["name"] for e in begin] == ["SparseCholesky - factor", "task 3"]
+    assert len(end) == 2
+    assert begin[0]["ts"] == 500 and end[-1]["ts"] == 1500
+
+if __name__ == "__main__":
+    import pathlib, tempfile
+    test_paje_to_chrome(pathlib.Path(tempfile.mkdtemp()))
@@ -0,0 +1,48 @@
+from ngsolve import *
+from netgen.geom2d import unit_square
+import struct
+
+def test_vtu_appended(tmp_path):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    vtk = VTKOutput(mesh, coefs=[x*y, CF((x,y))], names=["xy", "vec"],
+                    filename=str(tmp_path / "vtuout"), subdivision=1, legacy=False)
+    vtk.Do()
+    data = open(tmp_path / "vtuout.vtu", "rb").read()
+    header, appended = data.split(b'<AppendedData encoding="raw">\n_')
+    assert b'NumberOfCells="%d"' % (4*mesh.ne) in header
+    # first array is the scalar field, with a UInt64 byte count
+    nbytes = struct.unpack("<Q", appended[:8])[0]
+    npoints = int(header.split(b'NumberOfPoints="')[1].split(b'"')[0])
+    assert nbytes == 4*npoints
+
+def test_async_output(tmp_path):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    gfu = GridFunction(H1(mesh, order=2))
+    out = AsyncOutput()
+    vtk = VTKOutput(mesh, coefs=[gfu], names=["u"], filename=str(tmp_path / "asyncout"), legacy=False)
+    for i in range(3):
+        gfu.Set(x+i)
+        out.Do(vtk)
+        out.Save(gfu, str(tmp_path / ("asyncout_%d.ngs" % i)))
+    out.Wait()
+    gfu.Load(str(tmp_path / "asyncout_2.ngs"), parallel=True)
+    assert abs(Integrate(gfu, mesh) - 2.5) < 1e-10
+
+# tiny memory limit, every output waits for the previous one
+def test_async_output_legacy(tmp_path):
+    mesh = Mesh(unit_square.GenerateMesh(maxh=0.2))
+    gfu = GridFunction(H1(mesh, order=1))
+    out = AsyncOutput(max_memory=1)
+    vtk = VTKOutput(mesh, coefs=[gfu], names=["u"], filename=str(tmp_path / "asynclegacy"))
+    for i in range(3):
+        gfu.Set(CF(i))
+        out.Do(vtk)
+    out.Wait()
+    values = open(tmp_path / "asynclegacy_2.vtk").read().split("LOOKUP_TABLE default")[1].split()
+    assert all(abs(float(v)-2) < 1e-5 for v in values)
+
+if __name__ == "__main__":
+    import pathlib, tempfile
+    test_vtu_appended(pathlib.Path(tempfile.mkdtemp()))
+    test_async_output(pathlib.Path(tempfile.mkdtemp()))
+    test_async_output_legacy(pathlib.Path(tempfile.mkdtemp()))